@@ -0,0 +1,579 @@
+#include <benchmark/benchmark.h>
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+#include "geri-smx-decoder/histogram.hpp"
+#include "geri-smx-decoder/run_reader.hpp"
+#include "geri-smx-decoder/time_merge.hpp"
+#include "geri-smx-decoder/uring_reader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+constexpr std::size_t n_uplinks{8};         ///< uplinks sending data in the synthetic stream
+constexpr std::size_t n_frames{1024};       ///< frames in the synthetic stream
+constexpr std::size_t n_random_words{4096}; ///< words used by the microbenchmarks
+
+/**
+ * Encode TS_MSB uplink frame with given 6-bit timestamp MSB.
+ */
+constexpr auto make_ts_msb(uint32_t msb) -> uint32_t { return 0xc00000 | (msb << 16) | (msb << 10) | (msb << 4); }
+
+/**
+ * Encode HIT uplink frame which matches the TS_MSB frame `msb`.
+ */
+constexpr auto make_hit(uint32_t msb, uint32_t channel, uint32_t adc, uint32_t ts) -> uint32_t
+{ return (channel << 16) | (adc << 11) | ((msb & 0x3) << 9) | (ts << 1); }
+
+/**
+ * Build a GERI data stream where each frame carries TS_MSB of every uplink followed by `hits_per_frame` hits spread
+ * over the uplinks, in the same layout as the GERI payload.
+ */
+auto make_stream(std::size_t hits_per_frame) -> std::vector<uint64_t>
+{
+    std::mt19937 gen(hits_per_frame);
+    std::uniform_int_distribution<uint32_t> channel(0, 127);
+    std::uniform_int_distribution<uint32_t> adc(1, 31);
+    std::uniform_int_distribution<uint32_t> ts(0, 255);
+
+    std::vector<uint64_t> stream;
+    std::vector<uint32_t> uplink_words;
+    for (std::size_t frame = 0; frame < n_frames; ++frame)
+    {
+        const auto event_no = static_cast<uint32_t>(frame + 1);
+        const auto msb = static_cast<uint32_t>(frame & 0x3f);
+
+        uplink_words.clear();
+        for (std::size_t uplink = 0; uplink < n_uplinks; ++uplink)
+        {
+            uplink_words.push_back(static_cast<uint32_t>(0x08 + uplink) << 24 | make_ts_msb(msb));
+        }
+        for (std::size_t idx = 0; idx < hits_per_frame; ++idx)
+        {
+            uplink_words.push_back(static_cast<uint32_t>(0x08 + idx % n_uplinks) << 24 |
+                                   make_hit(msb, channel(gen), adc(gen), ts(gen)));
+        }
+        if (uplink_words.size() % 2 != 0) { uplink_words.push_back(0x08000000); }
+
+        stream.insert(stream.end(), {uint64_t{event_no} << 32 | geri::markers::start, frame * 0x100, 0x0, 0x0});
+        for (std::size_t idx = 0; idx < uplink_words.size(); idx += 2)
+        {
+            stream.push_back(uint64_t{uplink_words[idx + 1]} << 32 | uplink_words[idx]);
+        }
+        stream.insert(stream.end(), {uint64_t{event_no} << 32 | geri::markers::stop, (frame + 1) * 0x100, 0x0, 0x0});
+    }
+
+    return stream;
+}
+
+/**
+ * Random 32-bit uplink words with the mixture of hits and TS_MSB frames.
+ */
+auto make_random_words() -> std::vector<uint32_t>
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<uint32_t> dist;
+
+    std::vector<uint32_t> words(n_random_words);
+    for (std::size_t idx = 0; idx < words.size(); ++idx)
+    {
+        const auto word = dist(gen);
+        words[idx] = idx % 8 == 0 ? (word & 0xff000000) | make_ts_msb(word & 0x3f) : word & 0xff7fffff;
+    }
+
+    return words;
+}
+
+auto write_temp_file(const std::vector<uint64_t>& words, const std::string& suffix = {}) -> std::string
+{
+    std::string filename = "geri-smx-decoder_benchmark" + suffix + ".bin";
+    auto* fp = std::fopen(filename.c_str(), "wb");
+    std::fwrite(words.data(), sizeof(uint64_t), words.size(), fp);
+    std::fclose(fp);
+    return filename;
+}
+
+auto set_word_rates(benchmark::State& state, std::size_t n_words) -> void
+{
+    state.counters["words/s"] = benchmark::Counter(static_cast<double>(n_words),
+                                                   benchmark::Counter::kIsIterationInvariantRate);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(n_words * sizeof(uint64_t)));
+}
+
+auto set_rates(benchmark::State& state, std::size_t n_words, std::size_t n_hits) -> void
+{
+    set_word_rates(state, n_words);
+    state.counters["hits/s"] = benchmark::Counter(static_cast<double>(n_hits),
+                                                  benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// ---- Microbenchmarks ----
+
+auto BM_GetUplinkFrameType(benchmark::State& state) -> void
+{
+    const auto words = make_random_words();
+    for (auto _ : state)
+    {
+        for (auto word : words)
+        {
+            benchmark::DoNotOptimize(geri::smx::get_uplink_frame_type(word & 0xffffff));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(words.size()));
+}
+BENCHMARK(BM_GetUplinkFrameType);
+
+auto BM_DecodeSmxHit(benchmark::State& state) -> void
+{
+    const auto words = make_random_words();
+    for (auto _ : state)
+    {
+        for (auto word : words)
+        {
+            geri::smx::hit decoded_hit;
+            benchmark::DoNotOptimize(geri::smx::try_decode_smx_hit(word & 0xffffff, 0x100, decoded_hit));
+            benchmark::DoNotOptimize(decoded_hit);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(words.size()));
+}
+BENCHMARK(BM_DecodeSmxHit);
+
+auto BM_DecodeSmxTsMsb(benchmark::State& state) -> void
+{
+    const auto words = make_random_words();
+    for (auto _ : state)
+    {
+        for (auto word : words)
+        {
+            uint16_t ts_msb{0};
+            benchmark::DoNotOptimize(geri::smx::try_decode_smx_ts_msb(word & 0xffffff, ts_msb));
+            benchmark::DoNotOptimize(ts_msb);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(words.size()));
+}
+BENCHMARK(BM_DecodeSmxTsMsb);
+
+auto BM_GetGbtUplinkAddr(benchmark::State& state) -> void
+{
+    const auto words = make_random_words();
+    for (auto _ : state)
+    {
+        for (auto word : words)
+        {
+            benchmark::DoNotOptimize(geri::gbt::get_gbt_uplink_addr(word));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(words.size()));
+}
+BENCHMARK(BM_GetGbtUplinkAddr);
+
+// ---- Decoder ----
+
+template <typename Allocator> auto frame_hits(const geri::basic_payload_frame<Allocator>& frame) -> std::size_t
+{
+    return frame.hits.size();
+}
+
+auto frame_hits(const geri::columnar_frame& frame) -> std::size_t { return frame.size(); }
+
+/**
+ * Decode the whole in-memory stream, the argument is the number of hits per frame.
+ */
+template <typename Frame> auto BM_DecodeFrame(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(static_cast<std::size_t>(state.range(0)));
+
+    std::size_t n_hits{0};
+    Frame frame;
+    for (auto _ : state)
+    {
+        geri::memory_reader rdr(stream.data(), stream.size());
+        auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+
+        n_hits = 0;
+        while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+        {
+            n_hits += frame_hits(frame);
+        }
+    }
+    set_rates(state, stream.size(), n_hits);
+}
+BENCHMARK(BM_DecodeFrame<geri::columnar_frame>)->Arg(0)->Arg(16)->Arg(128)->Arg(1024);
+BENCHMARK(BM_DecodeFrame<geri::payload_frame>)->Arg(0)->Arg(16)->Arg(128)->Arg(1024);
+BENCHMARK(BM_DecodeFrame<geri::arena_payload_frame>)->Arg(0)->Arg(16)->Arg(128)->Arg(1024);
+
+/**
+ * Decode with the hit filter keeping 2 of 8 uplinks, half of the channels and the upper half of adc values.
+ */
+auto BM_DecodeFrameFiltered(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(static_cast<std::size_t>(state.range(0)));
+
+    geri::hit_filter filter;
+    filter.select_addr(0x08).select_addr(0x09).select_channels(0, 63).set_min_adc(16);
+
+    std::size_t n_hits{0};
+    geri::payload_frame frame;
+    for (auto _ : state)
+    {
+        geri::memory_reader rdr(stream.data(), stream.size());
+        auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+        decoder.set_filter(filter);
+
+        n_hits = 0;
+        while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+        {
+            n_hits += frame.hits.size();
+        }
+    }
+    set_word_rates(state, stream.size());
+    state.counters["kept_hits"] = static_cast<double>(n_hits);
+}
+BENCHMARK(BM_DecodeFrameFiltered)->Arg(128)->Arg(1024);
+
+/**
+ * Count hits with the visitor, no frame is materialized.
+ */
+struct hit_counter : geri::frame_visitor
+{
+    std::size_t n_hits{0};
+
+    auto on_hit(const geri::gbt_hit& /*hit*/) -> void { ++n_hits; }
+};
+
+auto BM_DecodeFrameVisitor(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(static_cast<std::size_t>(state.range(0)));
+
+    hit_counter counter;
+    for (auto _ : state)
+    {
+        geri::memory_reader rdr(stream.data(), stream.size());
+        auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+
+        counter.n_hits = 0;
+        while (decoder.try_decode_frame(counter) != geri::DECODE_STATUS::end_of_data) {}
+    }
+    set_rates(state, stream.size(), counter.n_hits);
+}
+BENCHMARK(BM_DecodeFrameVisitor)->Arg(0)->Arg(16)->Arg(128)->Arg(1024);
+
+/**
+ * Decode with given SIMD level of the kernels, 128 hits per frame.
+ */
+auto BM_DecodeFrameSimd(benchmark::State& state) -> void
+{
+    const auto level = static_cast<geri::smx::SIMD_LEVEL>(state.range(0));
+    if (level > geri::smx::detect_simd_level())
+    {
+        state.SkipWithError("SIMD level not supported by the CPU");
+        return;
+    }
+
+    const auto stream = make_stream(128);
+
+    std::size_t n_hits{0};
+    geri::columnar_frame frame;
+    for (auto _ : state)
+    {
+        geri::memory_reader rdr(stream.data(), stream.size());
+        auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+        decoder.set_simd_level(level);
+
+        n_hits = 0;
+        while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+        {
+            n_hits += frame.size();
+        }
+    }
+    set_rates(state, stream.size(), n_hits);
+}
+BENCHMARK(BM_DecodeFrameSimd)->DenseRange(0, 3);
+
+/**
+ * Decode the stream from the file, which is hot in the page cache after the first iteration.
+ */
+template <typename Reader> auto BM_DecodeFile(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(static_cast<std::size_t>(state.range(0)));
+    const auto filename = write_temp_file(stream);
+
+    std::size_t n_hits{0};
+    geri::columnar_frame frame;
+    for (auto _ : state)
+    {
+        Reader rdr(filename.c_str());
+        auto decoder = geri::payload_decoder<Reader>(&rdr);
+
+        n_hits = 0;
+        while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+        {
+            n_hits += frame.size();
+        }
+    }
+    set_rates(state, stream.size(), n_hits);
+
+    std::remove(filename.c_str());
+}
+BENCHMARK(BM_DecodeFile<geri::file_reader>)->Arg(128);
+BENCHMARK(BM_DecodeFile<geri::mmap_reader>)->Arg(128);
+BENCHMARK(BM_DecodeFile<geri::uring_reader>)->Arg(128);
+
+/**
+ * Decode the stream split into files, the argument is the number of files. Each file with new reader and decoder, or
+ * all files as one run.
+ */
+template <bool Run> auto BM_DecodeRun(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(128);
+    const auto n_files = static_cast<std::size_t>(state.range(0));
+
+    std::vector<std::string> filenames;
+    for (std::size_t idx = 0; idx < n_files; ++idx)
+    {
+        const auto begin = stream.begin() + static_cast<std::ptrdiff_t>(stream.size() * idx / n_files);
+        const auto end = stream.begin() + static_cast<std::ptrdiff_t>(stream.size() * (idx + 1) / n_files);
+        filenames.push_back(write_temp_file(std::vector<uint64_t>(begin, end), "_" + std::to_string(idx)));
+    }
+
+    std::size_t n_hits{0};
+    geri::columnar_frame frame;
+    for (auto _ : state)
+    {
+        n_hits = 0;
+        if (Run)
+        {
+            geri::run_reader rdr(filenames);
+            auto decoder = geri::payload_decoder<geri::run_reader>(&rdr);
+            while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+            {
+                n_hits += frame.size();
+            }
+            continue;
+        }
+
+        for (const auto& filename : filenames)
+        {
+            geri::file_reader rdr(filename.c_str());
+            auto decoder = geri::payload_decoder<geri::file_reader>(&rdr);
+            while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+            {
+                n_hits += frame.size();
+            }
+        }
+    }
+    set_rates(state, stream.size(), n_hits);
+
+    for (const auto& filename : filenames)
+    {
+        std::remove(filename.c_str());
+    }
+}
+BENCHMARK(BM_DecodeRun<false>)->Arg(4)->Arg(16);
+BENCHMARK(BM_DecodeRun<true>)->Arg(4)->Arg(16);
+
+// ---- Readers ----
+
+auto BM_MemoryReaderWord(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(128);
+    for (auto _ : state)
+    {
+        geri::memory_reader rdr(stream.data(), stream.size());
+        uint64_t word{0};
+        while (rdr.try_read_word(word) == geri::DECODE_STATUS::ok)
+        {
+            benchmark::DoNotOptimize(word);
+        }
+    }
+    set_word_rates(state, stream.size());
+}
+BENCHMARK(BM_MemoryReaderWord);
+
+template <typename Reader> auto BM_ReaderWord(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(128);
+    const auto filename = write_temp_file(stream);
+    for (auto _ : state)
+    {
+        Reader rdr(filename.c_str());
+        uint64_t word{0};
+        while (rdr.try_read_word(word) == geri::DECODE_STATUS::ok)
+        {
+            benchmark::DoNotOptimize(word);
+        }
+    }
+    set_word_rates(state, stream.size());
+
+    std::remove(filename.c_str());
+}
+BENCHMARK(BM_ReaderWord<geri::file_reader>);
+BENCHMARK(BM_ReaderWord<geri::mmap_reader>);
+
+template <typename Reader> auto BM_ReaderBlock(benchmark::State& state) -> void
+{
+    const auto stream = make_stream(128);
+    const auto filename = write_temp_file(stream);
+    for (auto _ : state)
+    {
+        Reader rdr(filename.c_str());
+        uint64_t sum{0};
+        for (auto block = rdr.read_block(); !block.empty(); block = rdr.read_block())
+        {
+            for (auto word : block)
+            {
+                sum += word;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_word_rates(state, stream.size());
+
+    std::remove(filename.c_str());
+}
+BENCHMARK(BM_ReaderBlock<geri::file_reader>);
+BENCHMARK(BM_ReaderBlock<geri::mmap_reader>);
+BENCHMARK(BM_ReaderBlock<geri::uring_reader>);
+
+// ---- Time ordering ----
+
+/**
+ * Build a frame with the hits grouped by uplink, each uplink in time order.
+ */
+auto make_ordered_frame(std::size_t hits_per_frame) -> geri::payload_frame
+{
+    std::mt19937 gen(hits_per_frame);
+    std::uniform_int_distribution<uint16_t> ts(0, 4095);
+
+    geri::payload_frame frame;
+    for (std::size_t uplink = 0; uplink < n_uplinks; ++uplink)
+    {
+        std::vector<uint16_t> times(hits_per_frame / n_uplinks);
+        std::generate(times.begin(), times.end(), [&]() { return ts(gen); });
+        std::sort(times.begin(), times.end());
+
+        for (auto full_ts : times)
+        {
+            geri::gbt_hit hit{geri::gbt::get_gbt_uplink_addr(static_cast<uint32_t>(0x08 + uplink) << 24)};
+            hit.full_ts = full_ts;
+            frame.hits.push_back(hit);
+        }
+    }
+
+    return frame;
+}
+
+/**
+ * Merge the per-uplink sequences, the argument is the number of hits per frame.
+ */
+auto BM_TimeMerge(benchmark::State& state) -> void
+{
+    const auto frame = make_ordered_frame(static_cast<std::size_t>(state.range(0)));
+
+    geri::time_merger merger;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(merger.merge(frame).data());
+    }
+    state.counters["hits/s"] = benchmark::Counter(static_cast<double>(frame.hits.size()),
+                                                  benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_TimeMerge)->Arg(16)->Arg(128)->Arg(1024);
+
+/**
+ * Baseline for `BM_TimeMerge`, sort all hits of the frame by time.
+ */
+auto BM_TimeSort(benchmark::State& state) -> void
+{
+    const auto frame = make_ordered_frame(static_cast<std::size_t>(state.range(0)));
+
+    std::vector<geri::timed_hit> hits;
+    for (auto _ : state)
+    {
+        hits.clear();
+        for (std::size_t idx = 0; idx < frame.hits.size(); ++idx)
+        {
+            hits.push_back({frame.hits[idx].full_ts, static_cast<uint32_t>(idx)});
+        }
+        std::stable_sort(hits.begin(), hits.end(),
+                         [](const geri::timed_hit& lhs, const geri::timed_hit& rhs) { return lhs.time < rhs.time; });
+        benchmark::DoNotOptimize(hits.data());
+    }
+    state.counters["hits/s"] = benchmark::Counter(static_cast<double>(frame.hits.size()),
+                                                  benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_TimeSort)->Arg(16)->Arg(128)->Arg(1024);
+
+// ---- Histograms ----
+
+/**
+ * Build a frame with the hits of random channels and adc values.
+ */
+auto make_random_frame(std::size_t hits_per_frame) -> geri::payload_frame
+{
+    std::mt19937 gen(hits_per_frame);
+    std::uniform_int_distribution<uint16_t> value(0, 0xfff);
+
+    geri::payload_frame frame;
+    for (std::size_t idx = 0; idx < hits_per_frame; ++idx)
+    {
+        geri::gbt_hit hit{geri::gbt::get_gbt_uplink_addr(static_cast<uint32_t>(0x08 + idx % n_uplinks) << 24)};
+        const auto random = value(gen);
+        hit.channel = static_cast<uint8_t>(random & 0x7f);
+        hit.adc = static_cast<uint8_t>(random >> 7);
+        frame.hits.push_back(hit);
+    }
+
+    return frame;
+}
+
+/**
+ * Fill the per-thread histograms, the argument is the number of hits per frame.
+ */
+auto BM_Histogram(benchmark::State& state) -> void
+{
+    const auto frame = make_random_frame(static_cast<std::size_t>(state.range(0)));
+
+    geri::hit_histograms histograms;
+    auto& acc = histograms.make_accumulator();
+    for (auto _ : state)
+    {
+        acc.fill(frame);
+    }
+    benchmark::DoNotOptimize(histograms.snapshot().total_hits());
+    state.counters["hits/s"] = benchmark::Counter(static_cast<double>(frame.hits.size()),
+                                                  benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Histogram)->Arg(128)->Arg(1024);
+
+/**
+ * Baseline for `BM_Histogram`, count the hits in the map.
+ */
+auto BM_HistogramMap(benchmark::State& state) -> void
+{
+    const auto frame = make_random_frame(static_cast<std::size_t>(state.range(0)));
+
+    std::map<std::tuple<uint8_t, uint8_t, uint8_t>, uint64_t> histogram;
+    for (auto _ : state)
+    {
+        for (const auto& hit : frame.hits)
+        {
+            ++histogram[std::make_tuple(hit.unique_addr, hit.channel, hit.adc)];
+        }
+    }
+    benchmark::DoNotOptimize(histogram.size());
+    state.counters["hits/s"] = benchmark::Counter(static_cast<double>(frame.hits.size()),
+                                                  benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_HistogramMap)->Arg(128)->Arg(1024);
+
+} // namespace
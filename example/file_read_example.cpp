@@ -3,21 +3,66 @@
    Authors: Rafał Lalik [committer] */
 
 #include "geri-smx-decoder/geri-smx-decoder.hpp"
+#include "geri-smx-decoder/parallel_decoder.hpp"
+#include "geri-smx-decoder/run_reader.hpp"
 
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
 #ifdef __cpp_lib_print
 #include <print>
 #else
 #include <cstdio>
 #endif
-#include <stdexcept>
 
 #include <getopt.h>
 
 namespace
 {
 
+auto print_frame(const geri::payload_frame& res, int verbose) -> void
+{
+    if (verbose > 0)
+    {
+#ifdef __cpp_lib_print
+        std::print("  Event: {:d}  payload size: {:d} hits\n", res.event_no, res.hits.size());
+    }
+#else
+        std::printf("  Event: %d  payload size: %ld hits\n", res.event_no, res.hits.size());
+    }
+#endif
+    if (verbose > 1)
+    {
+        for (const auto& hit : res.hits)
+        {
+#ifdef __cpp_lib_print
+            std::print("  Hit  {}\n", hit);
+#else
+            std::printf("  Hit  GBT: %u  Uplink: %2d  channel: %3d  adc: %3u  full ts: %016x  em: %d\n", hit.gbt,
+                        hit.uplink, hit.channel, hit.adc, hit.full_ts, hit.event_missing);
+#endif
+        }
+    }
+}
+
+auto print_rate(std::size_t n_evts, std::chrono::steady_clock::time_point begin) -> void
+{
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin);
+
+    const auto s_to_ms_conv{1000.0};
+    const auto seconds = static_cast<double>(duration.count()) / s_to_ms_conv;
+#ifdef __cpp_lib_print
+    std::print("Read {} events in {} s -- {:.4f} evts/s\n", n_evts, seconds, static_cast<double>(n_evts) / seconds);
+#else
+    std::printf("Read %zu events in %f s -- %.4f evts/s\n", n_evts, seconds, static_cast<double>(n_evts) / seconds);
+#endif
+}
+
 auto parse_file(const char* filename, int verbose) -> void
 {
 #ifdef __cpp_lib_print
@@ -30,54 +75,69 @@ auto parse_file(const char* filename, int verbose) -> void
 
     auto decoder = geri::payload_decoder(&frdr);
 
-    int n_evts = 0;
+    std::size_t n_evts = 0;
+
+    geri::payload_frame res;
 
     const std::chrono::steady_clock::time_point begin{std::chrono::steady_clock::now()};
-    while (true)
+    for (auto status = decoder.try_decode_frame(res); status != geri::DECODE_STATUS::end_of_data;
+         status = decoder.try_decode_frame(res))
     {
-        try
-        {
-            auto res = decoder.decode_frame();
-            if (verbose > 0)
-            {
-#ifdef __cpp_lib_print
-                std::print("  Event: {:d}  payload size: {:d} hits\n", res.event_no, res.hits.size());
-            }
-#else
-                std::printf("  Event: %d  payload size: %ld hits\n", res.event_no, res.hits.size());
-            }
-#endif
-            if (verbose > 1)
-            {
-                for (const auto& hit : res.hits)
-                {
+        if (status != geri::DECODE_STATUS::ok) { continue; }
+
+        print_frame(res, verbose);
+        n_evts++;
+    }
+
+    print_rate(n_evts, begin);
+}
+
+auto parse_run(std::vector<std::string> filenames, int verbose) -> void
+{
 #ifdef __cpp_lib_print
-                    std::print("  Hit  {}\n", hit);
+    std::print("Reading run of {:d} files\n", filenames.size());
 #else
-                    std::printf("  Hit  GBT: %u  Uplink: %2d  channel: %3d  adc: %3u  full ts: %016x  em: %d\n",
-                                hit.gbt, hit.uplink, hit.channel, hit.adc, hit.full_ts, hit.event_missing);
+    std::printf("Reading run of %zu files\n", filenames.size());
 #endif
-                }
-            }
-            n_evts++;
-        }
-        catch (const std::out_of_range&)
-        {
-            break;
-        }
+
+    geri::run_reader rdr(std::move(filenames));
+
+    auto decoder = geri::payload_decoder(&rdr);
+
+    std::size_t n_evts = 0;
+
+    geri::payload_frame res;
+
+    const std::chrono::steady_clock::time_point begin{std::chrono::steady_clock::now()};
+    for (auto status = decoder.try_decode_frame(res); status != geri::DECODE_STATUS::end_of_data;
+         status = decoder.try_decode_frame(res))
+    {
+        if (status != geri::DECODE_STATUS::ok) { continue; }
+
+        print_frame(res, verbose);
+        n_evts++;
     }
-    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
 
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin);
+    print_rate(n_evts, begin);
+}
 
-    const auto s_to_ms_conv{1000.0};
+auto parse_file_parallel(const char* filename, int verbose, unsigned n_threads) -> void
+{
 #ifdef __cpp_lib_print
-    std::print("Read {} events in {} s -- {:.4f} evts/s\n", n_evts, duration.count() / s_to_ms_conv,
-               n_evts * s_to_ms_conv / duration.count());
+    std::print("Reading file: {:s} with {:d} threads\n", filename, n_threads);
 #else
-    std::printf("Read %d events in %f s -- %.4f evts/s\n", n_evts, duration.count() / s_to_ms_conv,
-                n_evts * s_to_ms_conv / duration.count());
+    std::printf("Reading file: %s with %u threads\n", filename, n_threads);
 #endif
+
+    const std::chrono::steady_clock::time_point begin{std::chrono::steady_clock::now()};
+
+    geri::parallel_options options;
+    options.n_threads = n_threads;
+
+    geri::parallel_decoder decoder(filename, options);
+    auto n_evts = decoder.run([verbose](const geri::payload_frame& res) { print_frame(res, verbose); });
+
+    print_rate(n_evts, begin);
 }
 
 } // namespace
@@ -85,9 +145,11 @@ auto parse_file(const char* filename, int verbose) -> void
 auto main(int argc, char** argv) -> int
 {
     int verbose{0};
+    unsigned n_threads{0};
+    bool run{false};
 
     int code{0};
-    while ((code = getopt(argc, argv, "vV")) != -1)
+    while ((code = getopt(argc, argv, "vVj:r")) != -1)
     {
         switch (code)
         {
@@ -97,14 +159,34 @@ auto main(int argc, char** argv) -> int
             case 'V':
                 verbose = 2;
                 break;
+            case 'j':
+                n_threads = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'r':
+                run = true;
+                break;
             default:
                 abort();
         }
     }
 
+    // files of single run, decoded as one stream
+    if (run)
+    {
+        parse_run(std::vector<std::string>(argv + optind, argv + argc), verbose);
+        return 0;
+    }
+
     for (int index = optind; index < argc; index++)
     {
-        parse_file(argv[index], verbose);
+        if (n_threads > 0)
+        {
+            parse_file_parallel(argv[index], verbose, n_threads);
+        }
+        else
+        {
+            parse_file(argv[index], verbose);
+        }
     }
 
     return 0;
@@ -23,12 +23,14 @@ auto parse_file(const char* filename, int verbose) -> void
 
     int n_evts = 0;
 
+    geri::payload_frame res;
+
     const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
     while (true)
     {
         try
         {
-            auto res = decoder.decode_frame();
+            decoder.decode_frame(res);
             if (verbose > 0) { std::printf("  Event: %u  payload size: %lu hits\n", res.event_no, res.hits.size()); }
             if (verbose > 1)
             {
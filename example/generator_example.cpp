@@ -0,0 +1,164 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+#include "geri-smx-decoder/generator.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <getopt.h>
+
+namespace
+{
+
+auto usage(const char* name) -> void
+{
+    std::printf("Usage: %s [options] output_file\n"
+                "  -n frames     number of frames, default 1000\n"
+                "  -S MiB        generate at least given size instead of number of frames\n"
+                "  -g gbts       number of GBT links, default 1\n"
+                "  -u uplinks    number of uplinks per GBT link, default 8\n"
+                "  -m hits       mean number of hits per frame, default 64\n"
+                "  -d dist       hits distribution: fixed, uniform or poisson (default)\n"
+                "  -D ratio      dummy hits ratio\n"
+                "  -p ratio      data dropped frames ratio\n"
+                "  -t ratio      hits with mismatched timestamp ratio\n"
+                "  -T ratio      corrupted ts_msb words ratio\n"
+                "  -e ratio      missing events ratio\n"
+                "  -x ratio      frames followed by garbage ratio\n"
+                "  -s seed       random seed, default 0\n",
+                name);
+}
+
+auto parse_distribution(const char* name) -> geri::HIT_DISTRIBUTION
+{
+    if (std::strcmp(name, "fixed") == 0) { return geri::HIT_DISTRIBUTION::fixed; }
+    if (std::strcmp(name, "uniform") == 0) { return geri::HIT_DISTRIBUTION::uniform; }
+    if (std::strcmp(name, "poisson") == 0) { return geri::HIT_DISTRIBUTION::poisson; }
+
+    std::fprintf(stderr, "Unknown distribution: %s\n", name);
+    std::exit(EXIT_FAILURE);
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int
+{
+    geri::generator_options options;
+    std::size_t n_frames{1000};
+    std::size_t size_mib{0};
+
+    int code{0};
+    while ((code = getopt(argc, argv, "n:S:g:u:m:d:D:p:t:T:e:x:s:h")) != -1)
+    {
+        switch (code)
+        {
+            case 'n':
+                n_frames = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'S':
+                size_mib = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'g':
+                options.n_gbts = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'u':
+                options.n_uplinks = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'm':
+                options.mean_hits = std::strtod(optarg, nullptr);
+                break;
+            case 'd':
+                options.distribution = parse_distribution(optarg);
+                break;
+            case 'D':
+                options.dummy_hit_ratio = std::strtod(optarg, nullptr);
+                break;
+            case 'p':
+                options.data_dropped_ratio = std::strtod(optarg, nullptr);
+                break;
+            case 't':
+                options.ts_mismatch_ratio = std::strtod(optarg, nullptr);
+                break;
+            case 'T':
+                options.invalid_ts_msb_ratio = std::strtod(optarg, nullptr);
+                break;
+            case 'e':
+                options.event_gap_ratio = std::strtod(optarg, nullptr);
+                break;
+            case 'x':
+                options.garbage_ratio = std::strtod(optarg, nullptr);
+                break;
+            case 's':
+                options.seed = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind == argc)
+    {
+        usage(argv[0]);
+        return 0;
+    }
+
+    try
+    {
+        geri::stream_generator gen(options);
+
+        auto* fp = std::fopen(argv[optind], "wb");
+        if (fp == nullptr)
+        {
+            std::perror(argv[optind]);
+            return EXIT_FAILURE;
+        }
+
+        const std::size_t frames_per_write{1024};
+        const auto target_bytes = size_mib * 1024UL * 1024UL;
+
+        std::size_t written{0};
+        std::size_t frames{0};
+        while (size_mib != 0 ? written < target_bytes : frames < n_frames)
+        {
+            auto count = size_mib != 0 ? frames_per_write : std::min(frames_per_write, n_frames - frames);
+
+            frames += count;
+            written += gen.write(fp, count);
+            if (written != gen.stats().words * sizeof(uint64_t)) { break; }
+        }
+
+        std::fclose(fp);
+
+        const auto& stats = gen.stats();
+        std::printf("Written %zu frames, %zu bytes: %llu hits, %llu dummy hits, %llu ts mismatches, "
+                    "%llu invalid ts_msb, %llu missing events, %llu garbage words\n",
+                    frames, written, static_cast<unsigned long long>(stats.hits),
+                    static_cast<unsigned long long>(stats.dummy_hits),
+                    static_cast<unsigned long long>(stats.ts_mismatches),
+                    static_cast<unsigned long long>(stats.invalid_ts_msb),
+                    static_cast<unsigned long long>(stats.event_gaps),
+                    static_cast<unsigned long long>(stats.garbage_words));
+
+        if (written != stats.words * sizeof(uint64_t))
+        {
+            std::fprintf(stderr, "Write error\n");
+            return EXIT_FAILURE;
+        }
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::fprintf(stderr, "Invalid options: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
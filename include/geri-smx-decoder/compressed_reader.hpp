@@ -0,0 +1,790 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file compressed_reader.hpp
+ * @brief Reader of zstd and lz4 compressed files with parallel decompression
+ *
+ * The decompression is enabled by defining `GERI_SMX_DECODER_WITH_ZSTD` and/or `GERI_SMX_DECODER_WITH_LZ4` before
+ * including the header, the program must be then linked with `libzstd` and/or `liblz4`.
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef GERI_SMX_DECODER_WITH_LZ4
+#include <lz4.h>
+#include <lz4frame.h>
+#endif
+
+namespace geri
+{
+
+/**
+ * Compression format of the file.
+ */
+enum class COMPRESSION : std::uint8_t
+{
+    none, ///< raw data words
+    zstd, ///< zstd frames
+    lz4,  ///< lz4 frames
+};
+
+/**
+ * Options of the compressed_reader.
+ */
+struct compressed_options
+{
+    unsigned n_threads{0};                              ///< number of worker threads, 0 - hardware concurrency
+    std::size_t max_pending{0};                         ///< units decompressed ahead of the consumer, 0 - 2 per thread
+    std::size_t unit_size{4UL * 1024UL * 1024UL};       ///< decompressed size of the unit of lz4 blocks
+    std::size_t max_frame_size{64UL * 1024UL * 1024UL}; ///< larger zstd frames are decompressed as stream
+    std::size_t stream_block{4UL * 1024UL * 1024UL};    ///< decompressed block size of the streamed frames
+};
+
+namespace detail
+{
+inline auto read_le32(const unsigned char* src) -> uint32_t
+{
+    return static_cast<uint32_t>(src[0]) | static_cast<uint32_t>(src[1]) << 8 | static_cast<uint32_t>(src[2]) << 16 |
+           static_cast<uint32_t>(src[3]) << 24;
+}
+
+constexpr uint32_t zstd_magic{0xFD2FB528};      ///< zstd frame magic number
+constexpr uint32_t lz4_magic{0x184D2204};       ///< lz4 frame magic number
+constexpr uint32_t skippable_magic{0x184D2A50}; ///< skippable frame magic number, shared by zstd and lz4
+constexpr uint32_t skippable_mask{0xFFFFFFF0};  ///< mask of the skippable frame magic numbers
+
+/**
+ * Detect the compression by the magic number of the first frame.
+ */
+inline auto detect_compression(const unsigned char* src, std::size_t size) -> COMPRESSION
+{
+    if (size < 4) { return COMPRESSION::none; }
+
+    auto magic = read_le32(src);
+    if (magic == zstd_magic) { return COMPRESSION::zstd; }
+    if (magic == lz4_magic) { return COMPRESSION::lz4; }
+
+    // skippable frames may precede frames of either format
+    std::size_t pos{0};
+    while (size - pos >= 8 and (read_le32(src + pos) & skippable_mask) == skippable_magic)
+    {
+        auto frame_size = read_le32(src + pos + 4);
+        if (frame_size > size - pos - 8) { return COMPRESSION::none; }
+        pos += 8 + frame_size;
+    }
+
+    if (pos == 0 or size - pos < 4) { return COMPRESSION::none; }
+
+    magic = read_le32(src + pos);
+    if (magic == zstd_magic) { return COMPRESSION::zstd; }
+    if (magic == lz4_magic) { return COMPRESSION::lz4; }
+
+    return COMPRESSION::none;
+}
+} // namespace detail
+
+/**
+ * Reads the zstd or lz4 compressed file, decompressed on a pool of worker threads.
+ *
+ * The format is detected by the magic number, the files which are not compressed are read directly like with
+ * `mmap_reader`. The compressed file is split into the units which can be decompressed independently: the zstd frames
+ * of known content size (e.g. created by `pzstd` or `zstd -T0 --format=zstd` with multiple frames), and the groups of
+ * the independent lz4 blocks (`lz4 -BI` or `LZ4F_blockIndependent`). The units are decompressed ahead of the consumer
+ * by the workers and delivered in the file order. A single zstd frame of unknown or too large content size, and the lz4
+ * frames of linked blocks, are decompressed as a stream in the consumer thread. Provides the same interface as
+ * `file_reader`, `read_block()` returns the view of the decompressed unit without copying.
+ *
+ * The decoding stops at corrupted or truncated compressed data, the data decompressed before are delivered and
+ * `corrupted()` is set.
+ * ```c++
+ * geri::compressed_reader rdr(filename);
+ * geri::payload_decoder<geri::compressed_reader> decoder(&rdr);
+ * ```
+ */
+class compressed_reader
+{
+public:
+    /**
+     * Open the file, terminates the program if the file cannot be opened.
+     *
+     * @param filename file to read from
+     * @param options reader options
+     * @throw std::runtime_error if the file compression is not supported by the build
+     */
+    explicit compressed_reader(const char* filename, compressed_options options = {})
+        : file_map{filename}, src{file_map.data()}, src_size{file_map.length},
+          compression{detail::detect_compression(src, src_size)}, opts{options}
+    {
+        if (compression == COMPRESSION::none)
+        {
+            if (src != nullptr) { current = reinterpret_cast<const uint64_t*>(src); }
+            tail = src_size / sizeof(uint64_t);
+            return;
+        }
+
+#ifndef GERI_SMX_DECODER_WITH_ZSTD
+        if (compression == COMPRESSION::zstd) { throw std::runtime_error("zstd support is not enabled"); }
+#endif
+#ifndef GERI_SMX_DECODER_WITH_LZ4
+        if (compression == COMPRESSION::lz4) { throw std::runtime_error("lz4 support is not enabled"); }
+#endif
+
+        opts.unit_size = std::max<std::size_t>(opts.unit_size, 1);
+        opts.stream_block = std::max<std::size_t>(opts.stream_block, sizeof(uint64_t));
+
+        auto n_threads = opts.n_threads ? opts.n_threads : std::max(1U, std::thread::hardware_concurrency());
+        max_pending = opts.max_pending ? opts.max_pending : 2 * std::size_t{n_threads};
+
+        for (unsigned id = 0; id < n_threads; ++id)
+        {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    compressed_reader(const compressed_reader&) = delete;
+    auto operator=(const compressed_reader&) -> compressed_reader& = delete;
+
+    ~compressed_reader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workers_cv.notify_all();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+        ZSTD_freeDCtx(zstd_stream);
+#endif
+#ifdef GERI_SMX_DECODER_WITH_LZ4
+        LZ4F_freeDecompressionContext(lz4_stream);
+#endif
+    }
+
+    /**
+     * @return detected compression of the file
+     */
+    auto format() const -> COMPRESSION { return compression; }
+
+    /**
+     * @return whether the decompression stopped at the corrupted or truncated data
+     */
+    auto corrupted() const -> bool { return failed; }
+
+    /**
+     * Read the next data word from the file, without throwing.
+     *
+     * @param word 64-bit word
+     * @return `ok` or `end_of_data`
+     */
+    auto try_read_word(uint64_t& word) -> DECODE_STATUS
+    {
+        if (head == tail and !next_block()) { return DECODE_STATUS::end_of_data; }
+
+        word = current[head++];
+        return DECODE_STATUS::ok;
+    }
+
+    /**
+     * Read the next data word from the file.
+     *
+     * EOF is marked by `std::out_of_range` exception.
+     *
+     * @return 64-bit word
+     */
+    auto read_word() -> uint64_t
+    {
+        uint64_t word{0};
+        if (try_read_word(word) != DECODE_STATUS::ok) { throw std::out_of_range("END OF DATA"); }
+
+        return word;
+    }
+
+    /**
+     * Read up to `n` next data words.
+     *
+     * @param dst destination buffer, must hold at least `n` words
+     * @param n number of words to read
+     * @return number of words read, smaller than `n` only at the end of file
+     */
+    auto read_words(uint64_t* dst, std::size_t n) -> std::size_t
+    {
+        std::size_t copied{0};
+
+        while (copied != n)
+        {
+            if (head == tail and !next_block()) { break; }
+
+            auto count = std::min(n - copied, tail - head);
+            std::copy(current + head, current + head + count, dst + copied);
+            head += count;
+            copied += count;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Return the decompressed data words which were not consumed yet, the next unit is taken if necessary. The view
+     * is valid until the next read call.
+     *
+     * @return view of the data words, empty at the end of file
+     */
+    auto read_block() -> span<const uint64_t>
+    {
+        if (head == tail and !next_block()) { return {}; }
+
+        auto block = span<const uint64_t>(current + head, tail - head);
+        head = tail;
+        return block;
+    }
+
+private:
+    /**
+     * Compressed block or frame.
+     */
+    struct part
+    {
+        const unsigned char* data{nullptr}; ///< compressed data
+        std::size_t size{0};                ///< size of the compressed data
+        bool stored{false};                 ///< lz4 block stored without compression
+    };
+
+    /**
+     * Compressed data decompressed at once by a worker, or as a stream by the consumer.
+     */
+    struct unit
+    {
+        std::vector<part> parts;      ///< compressed data, consecutive lz4 blocks or single frame
+        std::size_t capacity{0};      ///< upper bound of the decompressed size
+        std::vector<uint64_t> buffer; ///< decompressed data
+        std::size_t length{0};        ///< decompressed size in bytes
+        std::size_t stream_pos{0};    ///< consumed compressed bytes of the streamed frame
+        bool stream{false};           ///< decompressed in the consumer thread
+        bool taken{false};            ///< taken by a worker
+        bool done{false};             ///< decompressed
+        bool failed{false};           ///< corrupted data
+    };
+
+    /**
+     * State of the currently split lz4 frame.
+     */
+    struct lz4_frame_state
+    {
+        std::size_t start{0};         ///< offset of the frame header
+        std::size_t block_max{0};     ///< maximal decompressed block size
+        bool independent{false};      ///< blocks are compressed independently
+        bool block_checksum{false};   ///< blocks are followed by checksum
+        bool content_checksum{false}; ///< frame ends with content checksum
+        bool open{false};             ///< blocks of the frame are being split
+    };
+
+    static auto words_for(std::size_t bytes) -> std::size_t
+    { return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t); }
+
+    static auto bytes_of(std::vector<uint64_t>& buffer) -> unsigned char*
+    { return reinterpret_cast<unsigned char*>(buffer.data()); }
+
+    /**
+     * Stop splitting the file at the corrupted data.
+     */
+    auto split_failed() -> bool
+    {
+        failed = true;
+        scan_pos = src_size;
+        return false;
+    }
+
+    /**
+     * Split the next unit of the file.
+     *
+     * @return false at the end of file or the corrupted data
+     */
+    auto split_next(unit& unt) -> bool
+    {
+        return compression == COMPRESSION::zstd ? split_zstd(unt) : split_lz4(unt);
+    }
+
+    /**
+     * Skip the skippable frame at the current position.
+     *
+     * @return false if not a skippable frame
+     */
+    auto skip_skippable() -> bool
+    {
+        if (src_size - scan_pos < 8 or (detail::read_le32(src + scan_pos) & detail::skippable_mask) !=
+                                           detail::skippable_magic)
+        {
+            return false;
+        }
+
+        auto frame_size = detail::read_le32(src + scan_pos + 4);
+        scan_pos = frame_size > src_size - scan_pos - 8 ? src_size : scan_pos + 8 + frame_size;
+        return true;
+    }
+
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+    auto split_zstd(unit& unt) -> bool
+    {
+        while (scan_pos < src_size and skip_skippable())
+        {
+        }
+        if (scan_pos == src_size) { return false; }
+
+        const auto* frame = src + scan_pos;
+        auto frame_size = ZSTD_findFrameCompressedSize(frame, src_size - scan_pos);
+        if (ZSTD_isError(frame_size) != 0) { return split_failed(); }
+
+        auto content_size = ZSTD_getFrameContentSize(frame, frame_size);
+        if (content_size == ZSTD_CONTENTSIZE_ERROR) { return split_failed(); }
+
+        unt.parts.push_back({frame, frame_size, false});
+        if (content_size == ZSTD_CONTENTSIZE_UNKNOWN or content_size > opts.max_frame_size) { unt.stream = true; }
+        else { unt.capacity = static_cast<std::size_t>(content_size); }
+
+        scan_pos += frame_size;
+        return true;
+    }
+#else
+    auto split_zstd(unit& /*unt*/) -> bool { return false; }
+#endif
+
+    /**
+     * Parse the lz4 frame header at the current position.
+     *
+     * @return false if the header is not valid or not supported
+     */
+    auto parse_lz4_header() -> bool
+    {
+        if (src_size - scan_pos < 7 or detail::read_le32(src + scan_pos) != detail::lz4_magic) { return false; }
+
+        const auto flags = src[scan_pos + 4];
+        const auto block_desc = src[scan_pos + 5];
+        const auto block_max_id = (block_desc >> 4) & 0x7;
+
+        // version 01, no dictionary, maximal block size 64 KiB - 4 MiB
+        if ((flags >> 6) != 1 or (flags & 0x1) != 0 or block_max_id < 4) { return false; }
+
+        lz4_frame.independent = (flags & 0x20) != 0;
+        lz4_frame.block_checksum = (flags & 0x10) != 0;
+        lz4_frame.content_checksum = (flags & 0x04) != 0;
+        lz4_frame.block_max = std::size_t{1} << (8 + 2 * block_max_id);
+
+        const std::size_t header_size = 7 + ((flags & 0x08) != 0 ? 8 : 0);
+        if (src_size - scan_pos < header_size) { return false; }
+
+        lz4_frame.start = scan_pos;
+        scan_pos += header_size;
+        return true;
+    }
+
+    /**
+     * Take the next lz4 block at the current position.
+     *
+     * @param block taken block, empty at the end mark
+     * @return false if the block exceeds the file or the maximal block size
+     */
+    auto next_lz4_block(part& block) -> bool
+    {
+        if (src_size - scan_pos < 4) { return false; }
+
+        const auto block_size = detail::read_le32(src + scan_pos);
+        scan_pos += 4;
+
+        if (block_size == 0)
+        {
+            block = {};
+            const std::size_t checksum = lz4_frame.content_checksum ? 4 : 0;
+            if (src_size - scan_pos < checksum) { return false; }
+
+            scan_pos += checksum;
+            return true;
+        }
+
+        const std::size_t size = block_size & 0x7FFFFFFF;
+        const std::size_t checksum = lz4_frame.block_checksum ? 4 : 0;
+        if (size > lz4_frame.block_max or src_size - scan_pos < size + checksum) { return false; }
+
+        block = {src + scan_pos, size, (block_size & 0x80000000) != 0};
+        scan_pos += size + checksum;
+        return true;
+    }
+
+    auto split_lz4(unit& unt) -> bool
+    {
+        while (scan_pos < src_size)
+        {
+            if (!lz4_frame.open)
+            {
+                if (skip_skippable()) { continue; }
+                if (!parse_lz4_header()) { return split_failed(); }
+
+                lz4_frame.open = true;
+            }
+
+            part block;
+            if (!lz4_frame.independent)
+            {
+                // linked blocks depend on the previous ones, the whole frame is streamed
+                do
+                {
+                    if (!next_lz4_block(block)) { return split_failed(); }
+                } while (block.data != nullptr);
+
+                lz4_frame.open = false;
+                unt.parts.push_back({src + lz4_frame.start, scan_pos - lz4_frame.start, false});
+                unt.stream = true;
+                return true;
+            }
+
+            while (unt.capacity < opts.unit_size)
+            {
+                if (!next_lz4_block(block)) { return split_failed(); }
+                if (block.data == nullptr)
+                {
+                    lz4_frame.open = false;
+                    break;
+                }
+
+                unt.parts.push_back(block);
+                unt.capacity += block.stored ? block.size : lz4_frame.block_max;
+            }
+
+            if (!unt.parts.empty()) { return true; }
+        }
+
+        return false;
+    }
+
+    /**
+     * Decompress the unit in the worker thread.
+     */
+    auto decompress(unit& unt) const -> void
+    {
+        // spare word for the bytes carried from the previous unit
+        unt.buffer.resize(words_for(unt.capacity) + 1);
+        unt.length = 0;
+
+#if defined(GERI_SMX_DECODER_WITH_ZSTD) || defined(GERI_SMX_DECODER_WITH_LZ4)
+        auto* dst = bytes_of(unt.buffer);
+        for (const auto& prt : unt.parts)
+        {
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+            if (compression == COMPRESSION::zstd)
+            {
+                auto res = ZSTD_decompress(dst, unt.capacity, prt.data, prt.size);
+                unt.failed = ZSTD_isError(res) != 0;
+                unt.length = unt.failed ? 0 : res;
+            }
+#endif
+#ifdef GERI_SMX_DECODER_WITH_LZ4
+            if (compression == COMPRESSION::lz4)
+            {
+                if (prt.stored)
+                {
+                    std::memcpy(dst + unt.length, prt.data, prt.size);
+                    unt.length += prt.size;
+                    continue;
+                }
+
+                // the block size of the frame being split is changed by the consumer, the unit capacity bounds it
+                auto res = LZ4_decompress_safe(reinterpret_cast<const char*>(prt.data),
+                                               reinterpret_cast<char*>(dst + unt.length), static_cast<int>(prt.size),
+                                               static_cast<int>(unt.capacity - unt.length));
+                if (res < 0)
+                {
+                    unt.failed = true;
+                    return;
+                }
+                unt.length += static_cast<std::size_t>(res);
+            }
+#endif
+        }
+#endif
+    }
+
+    /**
+     * Decompress the next block of the streamed frame in the consumer thread into the stream buffer, after the
+     * carried bytes.
+     *
+     * @return false on the corrupted data
+     */
+    auto decompress_stream(unit& unt) -> bool
+    {
+        unt.length = 0;
+
+#if defined(GERI_SMX_DECODER_WITH_ZSTD) || defined(GERI_SMX_DECODER_WITH_LZ4)
+        const auto& prt = unt.parts.front();
+        auto* dst = bytes_of(stream_buffer) + carry_bytes;
+#endif
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+        if (compression == COMPRESSION::zstd)
+        {
+            if (zstd_stream == nullptr) { zstd_stream = ZSTD_createDCtx(); }
+            if (zstd_stream == nullptr) { return false; }
+
+            ZSTD_inBuffer input{prt.data, prt.size, unt.stream_pos};
+            ZSTD_outBuffer output{dst, opts.stream_block, 0};
+            while (output.pos < output.size)
+            {
+                auto res = ZSTD_decompressStream(zstd_stream, &output, &input);
+                if (ZSTD_isError(res) != 0) { return false; }
+                if (res == 0)
+                {
+                    unt.done = true;
+                    break;
+                }
+                // more input needed, but the frame is complete
+                if (input.pos == input.size and output.pos < output.size) { return false; }
+            }
+
+            unt.stream_pos = input.pos;
+            unt.length = output.pos;
+        }
+#endif
+#ifdef GERI_SMX_DECODER_WITH_LZ4
+        if (compression == COMPRESSION::lz4)
+        {
+            if (lz4_stream == nullptr and LZ4F_isError(LZ4F_createDecompressionContext(&lz4_stream, LZ4F_VERSION)) != 0)
+            {
+                return false;
+            }
+
+            while (unt.length < opts.stream_block)
+            {
+                auto dst_size = opts.stream_block - unt.length;
+                auto in_size = prt.size - unt.stream_pos;
+                auto res = LZ4F_decompress(lz4_stream, dst + unt.length, &dst_size, prt.data + unt.stream_pos,
+                                           &in_size, nullptr);
+                if (LZ4F_isError(res) != 0) { return false; }
+
+                unt.stream_pos += in_size;
+                unt.length += dst_size;
+                if (res == 0)
+                {
+                    unt.done = true;
+                    break;
+                }
+                if (unt.stream_pos == prt.size and dst_size == 0) { return false; }
+            }
+        }
+#endif
+        return true;
+    }
+
+    auto work() -> void
+    {
+        while (true)
+        {
+            unit* unt{nullptr};
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workers_cv.wait(lock,
+                                [&]()
+                                {
+                                    if (stopping) { return true; }
+                                    auto iter = std::find_if(pending.begin(), pending.end(), [](const unit& pnd)
+                                                             { return !pnd.taken and !pnd.stream; });
+                                    if (iter == pending.end()) { return false; }
+
+                                    iter->taken = true;
+                                    unt = &*iter;
+                                    return true;
+                                });
+                if (unt == nullptr) { return; }
+            }
+
+            // references to the deque elements stay valid, units are added and removed only at the ends
+            decompress(*unt);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                unt->done = true;
+            }
+            consumer_cv.notify_one();
+        }
+    }
+
+    /**
+     * Split the file into units, up to the pending limit.
+     */
+    auto fill_pending() -> void
+    {
+        bool added{false};
+        while (pending.size() < max_pending and scan_pos < src_size)
+        {
+            unit unt;
+            if (!spare_buffers.empty())
+            {
+                unt.buffer = std::move(spare_buffers.back());
+                spare_buffers.pop_back();
+            }
+            if (!split_next(unt)) { break; }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(std::move(unt));
+            added = true;
+        }
+
+        if (added) { workers_cv.notify_all(); }
+    }
+
+    /**
+     * Take the decompressed bytes as the current block, joined with the bytes carried from the previous block. The
+     * buffer must hold the spare word after the data.
+     *
+     * @param buffer buffer with the decompressed data, starting after the carried bytes if `in_place`
+     * @param length number of the decompressed bytes
+     * @param in_place whether the data start after the carried bytes
+     */
+    auto take(std::vector<uint64_t>& buffer, std::size_t length, bool in_place) -> void
+    {
+        auto* bytes = bytes_of(buffer);
+        if (carry_bytes != 0)
+        {
+            if (!in_place) { std::memmove(bytes + carry_bytes, bytes, length); }
+            std::memcpy(bytes, &carry, carry_bytes);
+            length += carry_bytes;
+        }
+
+        tail = length / sizeof(uint64_t);
+        carry_bytes = length % sizeof(uint64_t);
+        std::memcpy(&carry, bytes + tail * sizeof(uint64_t), carry_bytes);
+
+        current = buffer.data();
+        head = 0;
+    }
+
+    /**
+     * Move to the next decompressed block.
+     *
+     * @return false at the end of file
+     */
+    auto next_block() -> bool
+    {
+        if (compression == COMPRESSION::none) { return false; }
+
+        do
+        {
+            fill_pending();
+            if (pending.empty()) { return false; }
+
+            auto& front = pending.front();
+            if (front.stream)
+            {
+                stream_buffer.resize(words_for(opts.stream_block) + 1);
+                std::memcpy(bytes_of(stream_buffer), &carry, carry_bytes);
+                if (!decompress_stream(front)) { return stop(); }
+
+                take(stream_buffer, front.length, true);
+                if (front.done) { release_front(); }
+                continue;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                consumer_cv.wait(lock, [&]() { return front.done; });
+            }
+            if (front.failed) { return stop(); }
+
+            if (!current_buffer.empty()) { spare_buffers.push_back(std::move(current_buffer)); }
+            current_buffer = std::move(front.buffer);
+            take(current_buffer, front.length, false);
+            release_front();
+        } while (head == tail);
+
+        return true;
+    }
+
+    auto release_front() -> void
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.pop_front();
+    }
+
+    /**
+     * End the data at the corrupted unit.
+     */
+    auto stop() -> bool
+    {
+        failed = true;
+        scan_pos = src_size;
+        head = tail = 0;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        // the units taken by the workers must be finished before removing
+        consumer_cv.wait(lock,
+                         [&]()
+                         {
+                             return std::all_of(pending.begin(), pending.end(),
+                                                [](const unit& pnd) { return !pnd.taken or pnd.done; });
+                         });
+        pending.clear();
+        return false;
+    }
+
+    detail::byte_mapping file_map;                    ///< mapped compressed file
+    const unsigned char* src;                         ///< compressed data
+    std::size_t src_size;                             ///< size of the compressed data
+    COMPRESSION compression;                          ///< detected compression
+    compressed_options opts;                          ///< reader options
+    std::size_t max_pending{1};                       ///< maximal number of units ahead of the consumer
+
+    std::size_t scan_pos{0};                          ///< position of the next unit in the compressed data
+    lz4_frame_state lz4_frame;                        ///< currently split lz4 frame
+    bool failed{false};                               ///< corrupted data found
+
+    const uint64_t* current{nullptr};                 ///< current block
+    std::size_t head{0};                              ///< index of the next word in the block
+    std::size_t tail{0};                              ///< number of the words in the block
+    uint64_t carry{0};                                ///< bytes of the incomplete word from the previous block
+    std::size_t carry_bytes{0};                       ///< number of the carried bytes
+    std::vector<uint64_t> current_buffer;             ///< buffer of the current unit
+    std::vector<uint64_t> stream_buffer;              ///< buffer of the streamed frame
+    std::vector<std::vector<uint64_t>> spare_buffers; ///< buffers of the consumed units, for reuse
+
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+    ZSTD_DCtx* zstd_stream{nullptr};                  ///< zstd streaming context
+#endif
+#ifdef GERI_SMX_DECODER_WITH_LZ4
+    LZ4F_dctx* lz4_stream{nullptr};                   ///< lz4 streaming context
+#endif
+
+    std::deque<unit> pending;                         ///< units in the file order
+    bool stopping{false};                             ///< workers should stop
+    std::vector<std::thread> workers;                 ///< worker threads
+    std::mutex mutex;                                 ///< guards the units state
+    std::condition_variable workers_cv;               ///< wakes up workers
+    std::condition_variable consumer_cv;              ///< wakes up consumer
+};
+
+} // namespace geri
@@ -0,0 +1,414 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file generator.hpp
+ * @brief Generator of synthetic GERI data streams
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+namespace geri
+{
+
+/**
+ * Distribution of the number of hits in the frame.
+ */
+enum class HIT_DISTRIBUTION : std::uint8_t
+{
+    fixed,   ///< always the mean number of hits
+    uniform, ///< uniform between 0 and twice the mean
+    poisson  ///< Poisson with the given mean
+};
+
+/**
+ * Options of the stream_generator.
+ *
+ * The ratios are probabilities from 0 to 1, the corruption is injected only when the ratio is not zero.
+ */
+struct generator_options
+{
+    unsigned n_gbts{1};                                       ///< number of GBT links, up to 8
+    unsigned n_uplinks{8};                                    ///< number of uplinks of each GBT link, up to 32
+    double mean_hits{64.0};                                   ///< mean number of hits in the frame
+    HIT_DISTRIBUTION distribution{HIT_DISTRIBUTION::poisson}; ///< distribution of the number of hits
+    double dummy_hit_ratio{0.0};                              ///< ratio of dummy hits among the hit words
+    double data_dropped_ratio{0.0};                           ///< ratio of frames with the data dropped bit set
+    double ts_mismatch_ratio{0.0};                            ///< ratio of hits not matching the uplink ts_msb
+    double invalid_ts_msb_ratio{0.0};                         ///< ratio of corrupted ts_msb words
+    double crc_error_ratio{0.0};                              ///< ratio of ts_msb words with only the CRC corrupted
+    double event_gap_ratio{0.0};                              ///< ratio of frames followed by a missing event
+    double garbage_ratio{0.0};                                ///< ratio of frames followed by random garbage words
+    uint32_t first_event_no{1};                               ///< event number of the first frame
+    uint64_t first_systime{0};                                ///< system time preceding the first frame
+    uint64_t systime_step{0x100};                             ///< system time between the frames
+    uint64_t seed{0};                                         ///< seed of the random numbers
+};
+
+/**
+ * Count of the generated data, including the injected corruption.
+ */
+struct generator_stats
+{
+    uint64_t frames{0};         ///< generated frames
+    uint64_t words{0};          ///< generated 64-bit words
+    uint64_t hits{0};           ///< valid hit words
+    uint64_t dummy_hits{0};     ///< dummy hit words, including the padding of the data words
+    uint64_t ts_msb{0};         ///< valid ts_msb words
+    uint64_t ts_mismatches{0};  ///< hit words not matching the ts_msb
+    uint64_t invalid_ts_msb{0}; ///< corrupted ts_msb words
+    uint64_t crc_errors{0};     ///< ts_msb words with consistent fields but wrong CRC
+    uint64_t data_dropped{0};   ///< frames with the data dropped bit set
+    uint64_t event_gaps{0};     ///< missing events
+    uint64_t garbage_words{0};  ///< garbage words between the frames
+};
+
+namespace detail
+{
+/**
+ * SplitMix64 generator, the generated streams do not depend on the standard library implementation.
+ */
+class splitmix64
+{
+public:
+    explicit splitmix64(uint64_t seed) : state{seed} {}
+
+    /**
+     * @return next 64-bit random number
+     */
+    auto next() -> uint64_t
+    {
+        uint64_t value = (state += 0x9e3779b97f4a7c15);
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+        return value ^ (value >> 31);
+    }
+
+    /**
+     * @return random number in range [0, 1)
+     */
+    auto uniform() -> double { return static_cast<double>(next() >> 11) / 9007199254740992.0; }
+
+    /**
+     * @param bound upper bound, must be greater than 0
+     * @return random number in range [0, bound)
+     */
+    auto below(uint32_t bound) -> uint32_t { return static_cast<uint32_t>(((next() >> 32) * bound) >> 32); }
+
+    /**
+     * @param ratio probability of success
+     * @return random bool
+     */
+    auto chance(double ratio) -> bool { return ratio > 0.0 and uniform() < ratio; }
+
+    /**
+     * Poisson random number, sum of the Knuth's generator draws with the mean small enough to not underflow.
+     *
+     * @param mean mean value
+     * @return random number
+     */
+    auto poisson(double mean) -> uint64_t
+    {
+        const double max_step{256.0};
+
+        uint64_t value{0};
+        while (mean > 0.0)
+        {
+            const auto step = std::min(mean, max_step);
+            mean -= step;
+
+            const auto limit = std::exp(-step);
+            for (auto prod = uniform(); prod > limit; prod *= uniform())
+            {
+                ++value;
+            }
+        }
+
+        return value;
+    }
+
+private:
+    uint64_t state;
+};
+} // namespace detail
+
+/**
+ * Generates valid GERI data streams of random hits, as expected by `payload_decoder`, with optional corruption.
+ *
+ * Every frame contains ts_msb word of each uplink followed by its hits, the hits are spread uniformly over the
+ * uplinks. The ts_msb changes from frame to frame and the hits timestamps match it. The stream is fully determined
+ * by the options, including the seed.
+ * ```c++
+ * geri::generator_options options;
+ * options.mean_hits = 128;
+ * geri::stream_generator gen(options);
+ * auto words = gen.generate(1000);
+ * ```
+ */
+class stream_generator
+{
+public:
+    /**
+     * @param options generator options
+     * @throws std::invalid_argument if the options are out of range
+     */
+    explicit stream_generator(generator_options options = {})
+        : opts{options},
+          rng{options.seed},
+          hits_per_link(validate(options).n_gbts * options.n_uplinks),
+          next_event_no{options.first_event_no},
+          last_systime{options.first_systime}
+    {
+    }
+
+    /**
+     * Generate the next frame and the garbage following it, if any.
+     *
+     * @param words vector to which the words are appended
+     */
+    auto next_frame(std::vector<uint64_t>& words) -> void
+    {
+        const auto begin = words.size();
+
+        const auto event_no = next_event_no;
+        const auto systime = last_systime + opts.systime_step;
+        const auto data_dropped = rng.chance(opts.data_dropped_ratio);
+        if (data_dropped) { ++counts.data_dropped; }
+
+        words.insert(words.end(), {uint64_t{event_no} << 32 | markers::start, last_systime, data_dropped ? 1U : 0U, 0});
+
+        fill_uplink_words();
+        for (std::size_t idx = 0; idx < uplink_words.size(); idx += 2)
+        {
+            words.push_back(uint64_t{uplink_words[idx + 1]} << 32 | uplink_words[idx]);
+        }
+
+        words.insert(words.end(), {uint64_t{event_no} << 32 | markers::stop, systime, 0, 0});
+
+        ++counts.frames;
+        last_systime = systime;
+        next_event_no = event_no + 1;
+        if (rng.chance(opts.event_gap_ratio))
+        {
+            ++next_event_no;
+            ++counts.event_gaps;
+        }
+
+        if (rng.chance(opts.garbage_ratio)) { add_garbage(words); }
+
+        counts.words += words.size() - begin;
+    }
+
+    /**
+     * @param n_frames number of frames
+     * @return the generated words
+     */
+    auto generate(std::size_t n_frames) -> std::vector<uint64_t>
+    {
+        std::vector<uint64_t> words;
+        for (std::size_t idx = 0; idx < n_frames; ++idx)
+        {
+            next_frame(words);
+        }
+
+        return words;
+    }
+
+    /**
+     * Generate frames and write them to the file, in chunks of bounded size.
+     *
+     * @param file file to write to
+     * @param n_frames number of frames
+     * @return number of bytes written, smaller than generated on write error
+     */
+    auto write(std::FILE* file, std::size_t n_frames) -> std::size_t
+    {
+        const std::size_t chunk_words{1024UL * 1024UL};
+
+        std::vector<uint64_t> words;
+        std::size_t written{0};
+        for (std::size_t idx = 0; idx < n_frames; ++idx)
+        {
+            next_frame(words);
+            if (words.size() < chunk_words and idx + 1 != n_frames) { continue; }
+
+            auto n_words = std::fwrite(words.data(), sizeof(uint64_t), words.size(), file);
+            written += n_words * sizeof(uint64_t);
+            if (n_words != words.size()) { break; }
+
+            words.clear();
+        }
+
+        return written;
+    }
+
+    /**
+     * @return count of the generated data
+     */
+    auto stats() const -> const generator_stats& { return counts; }
+
+private:
+    /**
+     * @throws std::invalid_argument if the options are out of range
+     */
+    static auto validate(const generator_options& options) -> const generator_options&
+    {
+        const unsigned max_gbts{8};
+        const unsigned max_uplinks{32};
+
+        if (options.n_gbts == 0 or options.n_gbts > max_gbts)
+        {
+            throw std::invalid_argument("n_gbts must be from 1 to 8");
+        }
+        if (options.n_uplinks == 0 or options.n_uplinks > max_uplinks)
+        {
+            throw std::invalid_argument("n_uplinks must be from 1 to 32");
+        }
+        if (!(options.mean_hits >= 0.0)) { throw std::invalid_argument("mean_hits must not be negative"); }
+
+        for (auto ratio : {options.dummy_hit_ratio, options.data_dropped_ratio, options.ts_mismatch_ratio,
+                           options.invalid_ts_msb_ratio, options.crc_error_ratio, options.event_gap_ratio,
+                           options.garbage_ratio})
+        {
+            if (!(ratio >= 0.0 and ratio <= 1.0)) { throw std::invalid_argument("ratios must be from 0 to 1"); }
+        }
+
+        return options;
+    }
+
+    /**
+     * @return number of hits in the next frame
+     */
+    auto draw_n_hits() -> uint64_t
+    {
+        const auto mean = static_cast<uint64_t>(std::llround(opts.mean_hits));
+
+        switch (opts.distribution)
+        {
+            case HIT_DISTRIBUTION::fixed:
+                return mean;
+            case HIT_DISTRIBUTION::uniform:
+                return static_cast<uint64_t>(opts.mean_hits * 2.0 * rng.uniform() + 0.5);
+            default:
+                return rng.poisson(opts.mean_hits);
+        }
+    }
+
+    /**
+     * Encode TS_MSB uplink frame with the CRC.
+     */
+    static constexpr auto make_ts_msb(uint32_t msb) -> uint32_t
+    {
+        return 0xc00000 | (msb << 16) | (msb << 10) | (msb << 4) |
+               smx::ts_msb_crc(0xc00000 | (msb << 16) | (msb << 10) | (msb << 4));
+    }
+
+    /**
+     * Encode HIT uplink frame.
+     */
+    static constexpr auto make_hit(uint32_t channel, uint32_t adc, uint32_t ts) -> uint32_t
+    { return (channel << 16) | (adc << 11) | (ts << 1); }
+
+    auto next_hit(uint32_t msb) -> uint32_t
+    {
+        if (rng.chance(opts.dummy_hit_ratio))
+        {
+            ++counts.dummy_hits;
+            return rng.below(0x100) << 1;
+        }
+
+        auto ts_9_8 = msb & 0x3;
+        if (rng.chance(opts.ts_mismatch_ratio))
+        {
+            ts_9_8 = (ts_9_8 + 1 + rng.below(3)) & 0x3;
+            ++counts.ts_mismatches;
+        }
+        else
+        {
+            ++counts.hits;
+        }
+
+        return make_hit(rng.below(0x80), 1 + rng.below(0x1f), ts_9_8 << 8 | rng.below(0x100));
+    }
+
+    auto fill_uplink_words() -> void
+    {
+        std::fill(hits_per_link.begin(), hits_per_link.end(), 0);
+        for (auto n_hits = draw_n_hits(); n_hits != 0; --n_hits)
+        {
+            ++hits_per_link[rng.below(static_cast<uint32_t>(hits_per_link.size()))];
+        }
+
+        // non-zero, so the decoder checks the hits timestamps
+        const auto msb = static_cast<uint32_t>(1 + counts.frames % 0x3f);
+
+        uplink_words.clear();
+        for (std::size_t link = 0; link < hits_per_link.size(); ++link)
+        {
+            const auto addr = static_cast<uint32_t>((link / opts.n_uplinks) << 5 | (link % opts.n_uplinks)) << 24;
+
+            auto ts_msb = make_ts_msb(msb);
+            if (rng.chance(opts.invalid_ts_msb_ratio))
+            {
+                ts_msb ^= (1U + rng.below(0x3f)) << 4;
+                ++counts.invalid_ts_msb;
+            }
+            else if (rng.chance(opts.crc_error_ratio))
+            {
+                ts_msb ^= 1U + rng.below(0xf);
+                ++counts.crc_errors;
+            }
+            else
+            {
+                ++counts.ts_msb;
+            }
+            uplink_words.push_back(addr | ts_msb);
+
+            for (auto n_hits = hits_per_link[link]; n_hits != 0; --n_hits)
+            {
+                uplink_words.push_back(addr | next_hit(msb));
+            }
+        }
+
+        if (uplink_words.size() % 2 != 0)
+        {
+            uplink_words.push_back(uplink_words.back() & 0xff000000);
+            ++counts.dummy_hits;
+        }
+    }
+
+    auto add_garbage(std::vector<uint64_t>& words) -> void
+    {
+        const uint32_t max_garbage{16};
+
+        for (auto n_words = 1 + rng.below(max_garbage); n_words != 0; --n_words)
+        {
+            auto word = rng.next();
+            if (markers::is_start(word) or markers::is_stop(word)) { word ^= 0x1; }
+
+            words.push_back(word);
+            ++counts.garbage_words;
+        }
+    }
+
+    generator_options opts;              ///< generator options
+    detail::splitmix64 rng;              ///< random numbers
+    std::vector<uint64_t> hits_per_link; ///< number of hits of each uplink in the current frame
+    std::vector<uint32_t> uplink_words;  ///< 32-bit uplink words of the current frame
+    uint32_t next_event_no;              ///< event number of the next frame
+    uint64_t last_systime;               ///< system time of the last frame
+    generator_stats counts;              ///< count of the generated data
+};
+
+} // namespace geri
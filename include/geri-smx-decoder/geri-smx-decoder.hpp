@@ -19,14 +19,46 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
-#include <map>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+/// Vectorized x86 kernels are available
+#define GERI_SMX_DECODER_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+/// POSIX file mapping and 64-bit file offsets are available, see `mmap_reader`
+#define GERI_SMX_DECODER_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__has_include) && __cplusplus >= 201703L
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#endif
+
 #ifdef __cpp_lib_format
 #include <format>
 #endif
@@ -77,6 +109,37 @@
 namespace geri
 {
 
+/**
+ * Non-owning view of a contiguous sequence of objects.
+ *
+ * Minimal replacement of `std::span` for pre-c++20 standards. Used by readers to hand out blocks of data words
+ * without copying them.
+ */
+template <typename T> class span
+{
+public:
+    constexpr span() = default;
+
+    /**
+     * @param data pointer to the first element
+     * @param size number of elements
+     */
+    constexpr span(T* data, std::size_t size) : m_data{data}, m_size{size} {}
+
+    constexpr auto data() const -> T* { return m_data; }
+    constexpr auto size() const -> std::size_t { return m_size; }
+    constexpr auto empty() const -> bool { return m_size == 0; }
+
+    constexpr auto begin() const -> T* { return m_data; }
+    constexpr auto end() const -> T* { return m_data + m_size; }
+
+    constexpr auto operator[](std::size_t idx) const -> T& { return m_data[idx]; }
+
+private:
+    T* m_data{nullptr};    ///< first element
+    std::size_t m_size{0}; ///< number of elements
+};
+
 namespace exceptions
 {
 /**
@@ -146,6 +209,19 @@ class invalid_gbt_frame : public std::exception
 
 } // namespace exceptions
 
+/**
+ * Result of the non-throwing decoding functions (`try_*`).
+ */
+enum class DECODE_STATUS : std::uint8_t
+{
+    ok,             ///< success
+    end_of_data,    ///< no more data words
+    ts_mismatch,    ///< hit timestamp bits<9:8> do not match ts_msb<9:8>
+    invalid_ts_msb, ///< TS_MSB frame with inconsistent fields
+    invalid_frame,  ///< unexpected word in the frame trailer, or the trailer lost
+    invalid_offset, ///< position cannot be set
+};
+
 namespace smx
 {
 /**
@@ -163,6 +239,60 @@ enum class UPLINK_FRAME_TYPE : std::uint8_t
     seq_error
 };
 
+constexpr std::size_t n_uplink_frame_types{8}; ///< number of UPLINK_FRAME_TYPE values
+
+namespace detail
+{
+/**
+ * Lookup table of the SMX uplink frame types.
+ *
+ * Indexed by the 5-bit frame header (bits <23:19>) and the dummy hit flag (bit 5 of the index), see
+ * `get_uplink_frame_type()`.
+ */
+template <typename Dummy = void> struct uplink_frame_type_table
+{
+    using ft = UPLINK_FRAME_TYPE;
+
+    static constexpr UPLINK_FRAME_TYPE types[64] = {
+        // clang-format off
+        // 0xxxx - hit
+        ft::hit,       ft::hit,       ft::hit,       ft::hit,
+        ft::hit,       ft::hit,       ft::hit,       ft::hit,
+        ft::hit,       ft::hit,       ft::hit,       ft::hit,
+        ft::hit,       ft::hit,       ft::hit,       ft::hit,
+        // 10000 - seq_error, 10001 - ack, 10010 - nack, 10011 - alert_ack
+        ft::seq_error, ft::ack,       ft::nack,      ft::alert_ack,
+        // 101xx - rdata_ack
+        ft::rdata_ack, ft::rdata_ack, ft::rdata_ack, ft::rdata_ack,
+        // 11xxx - ts_msb
+        ft::ts_msb,    ft::ts_msb,    ft::ts_msb,    ft::ts_msb,
+        ft::ts_msb,    ft::ts_msb,    ft::ts_msb,    ft::ts_msb,
+        // the same with the dummy hit flag set, hits become dummy hits
+        ft::dummy_hit, ft::dummy_hit, ft::dummy_hit, ft::dummy_hit,
+        ft::dummy_hit, ft::dummy_hit, ft::dummy_hit, ft::dummy_hit,
+        ft::dummy_hit, ft::dummy_hit, ft::dummy_hit, ft::dummy_hit,
+        ft::dummy_hit, ft::dummy_hit, ft::dummy_hit, ft::dummy_hit,
+        ft::seq_error, ft::ack,       ft::nack,      ft::alert_ack,
+        ft::rdata_ack, ft::rdata_ack, ft::rdata_ack, ft::rdata_ack,
+        ft::ts_msb,    ft::ts_msb,    ft::ts_msb,    ft::ts_msb,
+        ft::ts_msb,    ft::ts_msb,    ft::ts_msb,    ft::ts_msb,
+        // clang-format on
+    };
+};
+
+template <typename Dummy> constexpr UPLINK_FRAME_TYPE uplink_frame_type_table<Dummy>::types[64];
+} // namespace detail
+
+/**
+ * Check whether the hit frame is a dummy hit (all bits <22:9> are zero).
+ *
+ * The result is meaningful only for frames of hit type.
+ *
+ * @param word the 24-bit data word
+ * @return test result
+ */
+constexpr auto is_dummy_hit(uint32_t word) -> bool { return (word & 0x7ffe00) == 0x0; }
+
 /**
  * Decodes the SMX uplink frame header type.
  *
@@ -171,23 +301,7 @@ enum class UPLINK_FRAME_TYPE : std::uint8_t
  */
 constexpr auto get_uplink_frame_type(uint32_t word) -> UPLINK_FRAME_TYPE
 {
-    auto header = word >> 19;
-
-    if (header & 0x10)
-    {
-        // it's something else than hit
-        if ((header & 0b11000) == 0b11000) { return UPLINK_FRAME_TYPE::ts_msb; }
-        if ((header & 0b11100) == 0b10100) { return UPLINK_FRAME_TYPE::rdata_ack; }
-        if ((header & 0b11111) == 0b10001) { return UPLINK_FRAME_TYPE::ack; }
-        if ((header & 0b11111) == 0b10010) { return UPLINK_FRAME_TYPE::nack; }
-        if ((header & 0b11111) == 0b10011) { return UPLINK_FRAME_TYPE::alert_ack; }
-        if ((header & 0b11111) == 0b10000) { return UPLINK_FRAME_TYPE::seq_error; }
-    }
-
-    // it's hit
-    if ((word & 0x7ffe00) == 0x0) { return UPLINK_FRAME_TYPE::dummy_hit; }
-
-    return UPLINK_FRAME_TYPE::hit;
+    return detail::uplink_frame_type_table<>::types[((word >> 19) & 0x1f) | (is_dummy_hit(word) ? 0x20U : 0x0U)];
 }
 
 /**
@@ -203,7 +317,19 @@ struct hit
 };
 
 /**
- * Decode HIT uplink frame.
+ * Check whether the hit timestamp matches the event timestamp, i.e. bits ts_msb<9:8> and hit.ts<9:8> are equal.
+ *
+ * Unknown (zero) event timestamp matches any hit timestamp.
+ *
+ * @param event_ts event timestamp
+ * @param hit_ts 10-bit hit timestamp
+ * @return test result
+ */
+constexpr auto ts_matches(uint16_t event_ts, uint16_t hit_ts) -> bool
+{ return event_ts == 0x0 or ((event_ts >> 8) & 0x3) == (hit_ts >> 8); }
+
+/**
+ * Decode HIT uplink frame, without throwing.
  *
  * Bits configuration (3 8-bit words, MSB first): `0ccccccc aaaaattt ttttttte`, where:
  * - e - event missing bit
@@ -213,12 +339,11 @@ struct hit
  *
  * @param word 24-bit data word
  * @param event_ts event timestamp, will be add to hit timestamp to create full timestamp
- * @return the hit structure
+ * @param decoded_hit the hit structure, the full timestamp is set only on success
+ * @return `ok` or `ts_mismatch`
  */
-inline auto decode_smx_hit(uint32_t word, uint16_t event_ts) -> hit
+inline auto try_decode_smx_hit(uint32_t word, uint16_t event_ts, hit& decoded_hit) -> DECODE_STATUS
 {
-    hit decoded_hit;
-
     // decode hit data
     decoded_hit.event_missing = word & 0b1; // [0] event missed
     word >>= 1;
@@ -231,27 +356,114 @@ inline auto decode_smx_hit(uint32_t word, uint16_t event_ts) -> hit
 
     decoded_hit.channel = word & 0x3f;      //  [22-16] channel address
 
-    if ((event_ts != 0x0) and ((event_ts >> 8) & 0x3) != (decoded_hit.ts >> 8))
-        throw geri::exceptions::ts_match_error(event_ts, decoded_hit.ts);
+    if (!ts_matches(event_ts, decoded_hit.ts)) { return DECODE_STATUS::ts_mismatch; }
 
     decoded_hit.full_ts = event_ts | decoded_hit.ts;
 
+    return DECODE_STATUS::ok;
+}
+
+/**
+ * Decode HIT uplink frame, see `try_decode_smx_hit()`.
+ *
+ * @param word 24-bit data word
+ * @param event_ts event timestamp, will be add to hit timestamp to create full timestamp
+ * @return the hit structure
+ * @throws geri::exceptions::ts_match_error if the timestamps do not match
+ */
+inline auto decode_smx_hit(uint32_t word, uint16_t event_ts) -> hit
+{
+    hit decoded_hit;
+    if (try_decode_smx_hit(word, event_ts, decoded_hit) != DECODE_STATUS::ok)
+    {
+        throw geri::exceptions::ts_match_error(event_ts, decoded_hit.ts);
+    }
+
     return decoded_hit;
 }
 
+constexpr uint32_t ts_msb_crc_poly{0x3}; ///< CRC-4 polynomial of the TS_MSB frame, x^4 + x + 1 without the x^4 term
+
+namespace detail
+{
+/**
+ * Remainder of the 24-bit polynomial divided by the TS_MSB CRC-4 polynomial.
+ */
+constexpr auto crc4_remainder(uint32_t value) -> uint32_t
+{
+    for (unsigned bit = 23; bit >= 4; --bit)
+    {
+        if (((value >> bit) & 0x1) != 0) { value ^= (0x10 | ts_msb_crc_poly) << (bit - 4); }
+    }
+    return value & 0xf;
+}
+
+/**
+ * Remainders of the bytes of the 24-bit frame, see `ts_msb_crc_syndrome()`.
+ */
+struct crc4_tables
+{
+    uint8_t bytes[3][256]; ///< remainder of each byte value at each byte position
+};
+
+constexpr auto make_crc4_tables() -> crc4_tables
+{
+    crc4_tables tables{};
+    for (unsigned pos = 0; pos < 3; ++pos)
+    {
+        for (uint32_t value = 0; value < 256; ++value)
+        {
+            tables.bytes[pos][value] = static_cast<uint8_t>(crc4_remainder(value << (8 * pos)));
+        }
+    }
+    return tables;
+}
+
+template <typename Dummy = void> struct crc4_table
+{
+    static constexpr crc4_tables tables = make_crc4_tables();
+};
+
+template <typename Dummy> constexpr crc4_tables crc4_table<Dummy>::tables;
+} // namespace detail
+
+/**
+ * CRC-4 syndrome of the TS_MSB frame, the remainder of the whole 24-bit frame divided by the CRC polynomial.
+ *
+ * The CRC bits <3:0> are the remainder of the bits <23:4> shifted by four, so the syndrome of a correct frame is
+ * zero. The remainder is linear, so it is computed as XOR of the three byte remainders from constexpr tables, without
+ * the bit-serial loop.
+ *
+ * @param word 24-bit data word, the address byte is ignored
+ * @return zero if the CRC matches
+ */
+constexpr auto ts_msb_crc_syndrome(uint32_t word) -> uint32_t
+{
+    return uint32_t{detail::crc4_table<>::tables.bytes[0][word & 0xff]} ^
+           detail::crc4_table<>::tables.bytes[1][(word >> 8) & 0xff] ^
+           detail::crc4_table<>::tables.bytes[2][(word >> 16) & 0xff];
+}
+
 /**
- * Decode TS_MSB uplink frame.
+ * @param word 24-bit data word, the CRC bits are ignored
+ * @return CRC-4 of the TS_MSB frame, the value of the bits <3:0>
+ */
+constexpr auto ts_msb_crc(uint32_t word) -> uint32_t { return ts_msb_crc_syndrome(word & 0xfffff0); }
+
+/**
+ * Decode TS_MSB uplink frame, without throwing.
  *
  * Bits configuration (3 8-bit words, MSB first): `11xxxxxx yyyyyyzz zzzzcccc`, where:
  * - x,y,z - same value of ts_msb
  * - c - 4-bits CRC
  *
  * @param word 24-bit data word
- * @return the hit structure
+ * @param ts_msb the timestamp MSB, set only on success
+ * @return `ok` or `invalid_ts_msb`
  */
-constexpr auto decode_smx_ts_msb(uint32_t word) -> uint16_t
+constexpr auto try_decode_smx_ts_msb(uint32_t word, uint16_t& ts_msb) -> DECODE_STATUS
 {
-    // auto crc = word & 0xf; TODO add CRC checking?
+    // the CRC is checked separately, see ts_msb_crc_syndrome()
     word >>= 4;
 
     auto ts_13_8_0 = static_cast<uint16_t>(word & 0x3f); //  [9-4] TS<13:8> #1
@@ -268,186 +480,2892 @@ constexpr auto decode_smx_ts_msb(uint32_t word) -> uint16_t
 
     auto check_ts = (static_bit_22 == 1) and ((ts_13_8_2 == ts_13_8_1) and (ts_13_8_1 == ts_13_8_0));
 
-    if (!check_ts) throw geri::exceptions::ts_msb_error(word);
+    if (!check_ts) { return DECODE_STATUS::invalid_ts_msb; }
 
-    return ts_13_8_0 << 8;
+    ts_msb = static_cast<uint16_t>(ts_13_8_0 << 8);
+    return DECODE_STATUS::ok;
 }
 
-} // namespace smx
+/**
+ * Decode TS_MSB uplink frame, see `try_decode_smx_ts_msb()`.
+ *
+ * @param word 24-bit data word
+ * @return the timestamp MSB
+ * @throws geri::exceptions::ts_msb_error if the frame is incorrect
+ */
+constexpr auto decode_smx_ts_msb(uint32_t word) -> uint16_t
+{
+    uint16_t ts_msb{0};
+    if (try_decode_smx_ts_msb(word, ts_msb) != DECODE_STATUS::ok) throw geri::exceptions::ts_msb_error(word);
 
-namespace gbt
+    return ts_msb;
+}
+
+/**
+ * Fields of a batch of 32-bit GBT/uplink + SMX words, decoded by the batch kernels.
+ *
+ * Data are stored as a structure of arrays, one entry per 32-bit word. Words are ordered as in the stream, first
+ * the LS32B, then the MS32B of each 64-bit word. Hit fields are valid only for words of hit type.
+ */
+struct word_batch
 {
+    static constexpr std::size_t max_words{32};           ///< maximal number of 64-bit words in the batch
+    static constexpr std::size_t max_size{2 * max_words}; ///< maximal number of 32-bit words in the batch
+
+    std::size_t size{0};                                  ///< number of 32-bit words in the batch
+
+    alignas(64) uint32_t raw[max_size];                   ///< raw 32-bit words
+    alignas(64) uint32_t type[max_size];                  ///< frame type, see UPLINK_FRAME_TYPE
+    alignas(64) uint32_t addr[max_size];                  ///< 8-bit GBT/uplink unique address
+    alignas(64) uint32_t channel[max_size];               ///< hit channel
+    alignas(64) uint32_t adc[max_size];                   ///< hit adc
+    alignas(64) uint32_t ts[max_size];                    ///< hit 10-bit timestamp
+    alignas(64) uint32_t event_missing[max_size];         ///< hit event missing flag
+};
 
 /**
- * GBT uplink address data.
+ * Batch kernel, decodes `n_words` 64-bit words into the batch. `n_words` must not exceed `word_batch::max_words`.
  */
-struct gbt_uplink_addr
+using word_batch_kernel = void (*)(const uint64_t* words, std::size_t n_words, word_batch& batch);
+
+/**
+ * Instruction set used by the batch kernel.
+ */
+enum class SIMD_LEVEL : std::uint8_t
 {
-    uint8_t gbt{0x0};         ///< gbt number
-    uint8_t uplink{0x0};      ///< uplink number
-    uint8_t unique_addr{0x0}; ///< unique address
+    scalar,
+    sse4,
+    avx2,
+    avx512
 };
 
+namespace detail
+{
 /**
- * Get Gbt address (uplink + GBT) from the word.
+ * Decode single 32-bit word into the batch.
  *
- * @param word 24-bit data word
+ * @param word the 32-bit data word
+ * @param batch the batch
+ * @param idx position in the batch
  */
-constexpr auto get_gbt_uplink_addr(uint32_t word)
+inline auto decode_batch_word(uint32_t word, word_batch& batch, std::size_t idx) -> void
 {
-    gbt_uplink_addr decoded_addr;
-
-    word >>= 24;
-    decoded_addr.unique_addr = static_cast<uint8_t>(word & 0xff);
-    decoded_addr.uplink = word & 0x1f; //  [28-24] uplink no
-    word >>= 5;
-    decoded_addr.gbt = word & 0x3;     //  [31-29] gbt no
+    batch.raw[idx] = word;
+    batch.type[idx] = static_cast<uint32_t>(get_uplink_frame_type(word));
+    batch.addr[idx] = word >> 24;
+    batch.event_missing[idx] = word & 0b1;    //  [0] event missed
+    batch.ts[idx] = (word >> 1) & 0x3ff;      //  [10-1] timestamp <9:0>
+    batch.adc[idx] = (word >> 11) & 0x1f;     //  [15-11] adc
+    batch.channel[idx] = (word >> 16) & 0x3f; //  [22-16] channel address
+}
 
-    return decoded_addr;
+/**
+ * Decode 32-bit words `first` to `n` of the 64-bit words with the scalar code.
+ */
+inline auto decode_batch_tail(const uint64_t* words, std::size_t first, std::size_t n, word_batch& batch) -> void
+{
+    for (auto idx = first; idx < n; ++idx)
+    {
+        decode_batch_word(static_cast<uint32_t>(words[idx / 2] >> (32 * (idx % 2))), batch, idx);
+    }
 }
 
-} // namespace gbt
+/**
+ * @return pointer to 16 frame types of non-hit headers 0b1xxxx, as bytes
+ */
+inline auto non_hit_frame_types() -> const void* { return uplink_frame_type_table<>::types + 16; }
+} // namespace detail
 
 /**
- * GBT hit data.
+ * Scalar batch kernel, the reference for the vectorized kernels.
  *
- * It is a basic data structure corresponding to hit read out by a single channel of the SMX.
+ * @param words 64-bit data words
+ * @param n_words number of data words
+ * @param batch output batch
  */
-struct gbt_hit : gbt::gbt_uplink_addr, smx::hit
+inline auto decode_word_batch_scalar(const uint64_t* words, std::size_t n_words, word_batch& batch) -> void
 {
-    /**
-     * @param addr uplink address
-     */
-    explicit gbt_hit(const gbt::gbt_uplink_addr& addr) : gbt::gbt_uplink_addr{addr} {}
-
-    /**
-     * Compare hits, they need to match with all components.
-     *
-     * @param rhs the other hit to compare
-     * @return test result
-     */
-    auto operator=(const smx::hit& rhs) -> gbt_hit&
-    {
-        channel = rhs.channel;
-        adc = rhs.adc;
-        ts = rhs.ts;
-        full_ts = rhs.full_ts;
-        event_missing = rhs.event_missing;
+    batch.size = 2 * n_words;
+    detail::decode_batch_tail(words, 0, batch.size, batch);
+}
 
-        return *this;
-    }
-};
+#ifdef GERI_SMX_DECODER_X86_SIMD
+static_assert(static_cast<int>(UPLINK_FRAME_TYPE::hit) - 1 == static_cast<int>(UPLINK_FRAME_TYPE::dummy_hit),
+              "vectorized kernels derive dummy hit type from hit type");
 
 /**
- * Payload data, which is a collection of gbt_hit with system timestamp and event number info.
+ * SSE4.1 batch kernel, 4 words per instruction. See `decode_word_batch_scalar()`.
  */
-struct payload_frame
+__attribute__((target("sse4.1"))) inline auto decode_word_batch_sse4(const uint64_t* words, std::size_t n_words,
+                                                                     word_batch& batch) -> void
 {
-    uint32_t event_no{0};      ///< event number
-    uint64_t system_ts{0};     ///< system timestamp
-    bool data_dropped{false};  ///< flag if data was dropped in the preceding payload
+    const auto* src = reinterpret_cast<const __m128i*>(words);
+    batch.size = 2 * n_words;
 
-    std::vector<gbt_hit> hits; ///< hits in the event
+    const auto types = _mm_loadu_si128(static_cast<const __m128i*>(detail::non_hit_frame_types()));
+    const auto non_hit_bit = _mm_set1_epi32(1 << 23);
 
-    payload_frame() { hits.reserve(1024L * 1024L); }
-};
+    std::size_t idx = 0;
+    for (; idx + 4 <= batch.size; idx += 4, ++src)
+    {
+        auto word = _mm_loadu_si128(src);
+
+        auto non_hit_type =
+            _mm_and_si128(_mm_shuffle_epi8(types, _mm_and_si128(_mm_srli_epi32(word, 19), _mm_set1_epi32(0xf))),
+                          _mm_set1_epi32(0xff));
+        auto is_non_hit = _mm_cmpeq_epi32(_mm_and_si128(word, non_hit_bit), non_hit_bit);
+        auto is_dummy = _mm_cmpeq_epi32(_mm_and_si128(word, _mm_set1_epi32(0x7ffe00)), _mm_setzero_si128());
+        auto hit_type = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(UPLINK_FRAME_TYPE::hit)), is_dummy);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.raw + idx), word);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.type + idx),
+                         _mm_blendv_epi8(hit_type, non_hit_type, is_non_hit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.addr + idx), _mm_srli_epi32(word, 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.event_missing + idx),
+                         _mm_and_si128(word, _mm_set1_epi32(0x1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.ts + idx),
+                         _mm_and_si128(_mm_srli_epi32(word, 1), _mm_set1_epi32(0x3ff)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.adc + idx),
+                         _mm_and_si128(_mm_srli_epi32(word, 11), _mm_set1_epi32(0x1f)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(batch.channel + idx),
+                         _mm_and_si128(_mm_srli_epi32(word, 16), _mm_set1_epi32(0x3f)));
+    }
 
-inline void close_file(std::FILE* fp) { std::fclose(fp); }
+    detail::decode_batch_tail(words, idx, batch.size, batch);
+}
 
 /**
- * Handles file from which the data will be read from.
- *
- * It owns the file pointer. Exposes `read_word()` function which returns the next data word.
+ * AVX2 batch kernel, 8 words per instruction. See `decode_word_batch_scalar()`.
  */
-class file_reader
+__attribute__((target("avx2"))) inline auto decode_word_batch_avx2(const uint64_t* words, std::size_t n_words,
+                                                                   word_batch& batch) -> void
 {
-private:
-    std::unique_ptr<FILE, decltype(&close_file)> fp; ///< file pointer
+    const auto* src = reinterpret_cast<const __m256i*>(words);
+    batch.size = 2 * n_words;
 
-public:
-    /**
-     * @param filename file to read from
-     */
-    explicit file_reader(const char* filename) : fp{fopen(filename, "rxe"), &close_file}
+    const auto types =
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(static_cast<const __m128i*>(detail::non_hit_frame_types())));
+    const auto non_hit_bit = _mm256_set1_epi32(1 << 23);
+
+    std::size_t idx = 0;
+    for (; idx + 8 <= batch.size; idx += 8, ++src)
     {
-        if (fp == nullptr) { abort(); }
+        auto word = _mm256_loadu_si256(src);
+
+        auto non_hit_type = _mm256_and_si256(
+            _mm256_shuffle_epi8(types, _mm256_and_si256(_mm256_srli_epi32(word, 19), _mm256_set1_epi32(0xf))),
+            _mm256_set1_epi32(0xff));
+        auto is_non_hit = _mm256_cmpeq_epi32(_mm256_and_si256(word, non_hit_bit), non_hit_bit);
+        auto is_dummy = _mm256_cmpeq_epi32(_mm256_and_si256(word, _mm256_set1_epi32(0x7ffe00)), _mm256_setzero_si256());
+        auto hit_type = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(UPLINK_FRAME_TYPE::hit)), is_dummy);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.raw + idx), word);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.type + idx),
+                            _mm256_blendv_epi8(hit_type, non_hit_type, is_non_hit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.addr + idx), _mm256_srli_epi32(word, 24));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.event_missing + idx),
+                            _mm256_and_si256(word, _mm256_set1_epi32(0x1)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.ts + idx),
+                            _mm256_and_si256(_mm256_srli_epi32(word, 1), _mm256_set1_epi32(0x3ff)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.adc + idx),
+                            _mm256_and_si256(_mm256_srli_epi32(word, 11), _mm256_set1_epi32(0x1f)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(batch.channel + idx),
+                            _mm256_and_si256(_mm256_srli_epi32(word, 16), _mm256_set1_epi32(0x3f)));
     }
 
-    /**
-     * Red the next data word from the file.
-     *
-     * EOF is marked by `std::out_of_range` exception.
-     *
-     * @return 8-bit word
-     */
-    auto read_word() -> uint64_t
-    {
-        uint64_t data{0x0};
-        auto status = fread(&data, 8, 1, fp.get());
+    detail::decode_batch_tail(words, idx, batch.size, batch);
+}
 
-        if (status == 0) { throw std::out_of_range("END OF DATA"); }
+namespace detail
+{
+/**
+ * Logical right shift of the 32-bit lanes. The zero-masked form, the plain `_mm512_srli_epi32()` of GCC 12 reads its
+ * undefined pass-through operand and trips -Wmaybe-uninitialized.
+ */
+__attribute__((target("avx512f"))) inline auto srli_epi32(__m512i word, unsigned int count) -> __m512i
+{
+    return _mm512_maskz_srli_epi32(static_cast<__mmask16>(0xffff), word, count);
+}
+} // namespace detail
 
-        return data;
+/**
+ * AVX-512 batch kernel, 16 words per instruction. See `decode_word_batch_scalar()`.
+ */
+__attribute__((target("avx512f,avx512bw"))) inline auto decode_word_batch_avx512(const uint64_t* words,
+                                                                                 std::size_t n_words,
+                                                                                 word_batch& batch) -> void
+{
+    const auto* src = reinterpret_cast<const __m512i*>(words);
+    batch.size = 2 * n_words;
+
+    // set from the scalars, `_mm512_broadcast_i32x4()` has the same undefined operand as the shifts
+    int32_t lanes[4];
+    std::memcpy(lanes, detail::non_hit_frame_types(), sizeof(lanes));
+    const auto types = _mm512_set4_epi32(lanes[3], lanes[2], lanes[1], lanes[0]);
+    const auto hit_type = _mm512_set1_epi32(static_cast<int>(UPLINK_FRAME_TYPE::hit));
+    const auto dummy_hit_type = _mm512_set1_epi32(static_cast<int>(UPLINK_FRAME_TYPE::dummy_hit));
+
+    std::size_t idx = 0;
+    for (; idx + 16 <= batch.size; idx += 16, ++src)
+    {
+        auto word = _mm512_loadu_si512(src);
+
+        auto non_hit_type = _mm512_and_si512(
+            _mm512_shuffle_epi8(types, _mm512_and_si512(detail::srli_epi32(word, 19), _mm512_set1_epi32(0xf))),
+            _mm512_set1_epi32(0xff));
+        auto is_non_hit = _mm512_test_epi32_mask(word, _mm512_set1_epi32(1 << 23));
+        auto is_dummy = _mm512_testn_epi32_mask(word, _mm512_set1_epi32(0x7ffe00));
+
+        _mm512_storeu_si512(batch.raw + idx, word);
+        _mm512_storeu_si512(batch.type + idx,
+                            _mm512_mask_blend_epi32(is_non_hit, _mm512_mask_blend_epi32(is_dummy, hit_type,
+                                                                                         dummy_hit_type),
+                                                    non_hit_type));
+        _mm512_storeu_si512(batch.addr + idx, detail::srli_epi32(word, 24));
+        _mm512_storeu_si512(batch.event_missing + idx, _mm512_and_si512(word, _mm512_set1_epi32(0x1)));
+        _mm512_storeu_si512(batch.ts + idx, _mm512_and_si512(detail::srli_epi32(word, 1), _mm512_set1_epi32(0x3ff)));
+        _mm512_storeu_si512(batch.adc + idx, _mm512_and_si512(detail::srli_epi32(word, 11), _mm512_set1_epi32(0x1f)));
+        _mm512_storeu_si512(batch.channel + idx,
+                            _mm512_and_si512(detail::srli_epi32(word, 16), _mm512_set1_epi32(0x3f)));
     }
-};
+
+    detail::decode_batch_tail(words, idx, batch.size, batch);
+}
+#endif
 
 /**
- * Decodes the paylod data.
+ * Detect the best instruction set supported by the CPU.
  *
- * This class does most of the work. To use it, create the file reader, initialize the payload decode and read frames:
- * ```c++
- * geri::file_reader frdr(filename);
- * auto decoder = geri::payload_decoder(&frdr);
- * auto n_evts = 0l;
- * while (true) {
- *   try {
- *     auto res = decoder.decode_frame();
- *     // do something with the data:
- *     // res.event_no, res.hits
- *     n_evts++;
- *   } catch (const std::out_of_range&) { break; }// end of file
- * }
- * ```
+ * @return the SIMD level
  */
-template <typename T> class payload_decoder
+inline auto detect_simd_level() -> SIMD_LEVEL
 {
-private:
-    T* data_reader{nullptr};                        ///< pointer to the reader
-
-    static const uint64_t start_marker{0x579acce7}; ///< pattern which indicates begin of the frame
-    static const uint64_t stop_marker{0xed9acce7};  ///< pattern which indicates end of the frame
-
-    uint64_t last_systime = 0;                      ///< track the system time and its change
+#ifdef GERI_SMX_DECODER_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512bw")) { return SIMD_LEVEL::avx512; }
+    if (__builtin_cpu_supports("avx2")) { return SIMD_LEVEL::avx2; }
+    if (__builtin_cpu_supports("sse4.1")) { return SIMD_LEVEL::sse4; }
+#endif
+    return SIMD_LEVEL::scalar;
+}
 
-    /**
-     * Helper function to check if data matches expected value and print info if not.
-     *
-     * @param word to be tested
-     * @param expected value
-     * @return test result
-     */
-    auto expect_word(uint64_t word, uint64_t expected) -> bool
+/**
+ * Get the batch kernel for the SIMD level. Levels not supported by the build fall back to the scalar kernel.
+ *
+ * @param level the SIMD level
+ * @return the kernel
+ */
+inline auto get_word_batch_kernel(SIMD_LEVEL level) -> word_batch_kernel
+{
+    switch (level)
     {
-        if (word != expected)
-        {
-#ifdef __cpp_lib_print
-            std::print("Expected {:#018x} got {:#018x}\n", expected, word);
-#elifdef __cpp_lib_format
-            std::printf("%s", std::format("Expected {:#018x} got {:#018x}\n", expected, word).c_str());
-#else
-            std::printf("Expected %#018lx got %#018lx\n", expected, word);
+#ifdef GERI_SMX_DECODER_X86_SIMD
+        case SIMD_LEVEL::avx512:
+            return &decode_word_batch_avx512;
+        case SIMD_LEVEL::avx2:
+            return &decode_word_batch_avx2;
+        case SIMD_LEVEL::sse4:
+            return &decode_word_batch_sse4;
 #endif
-            return false;
-        }
-        return true;
-        ;
+        default:
+            return &decode_word_batch_scalar;
     }
+}
 
-public:
-    /**
+/**
+ * Decode the batch with the best kernel supported by the CPU.
+ *
+ * @param words 64-bit data words
+ * @param n_words number of data words, at most `word_batch::max_words`
+ * @param batch output batch
+ */
+inline auto decode_word_batch(const uint64_t* words, std::size_t n_words, word_batch& batch) -> void
+{
+    static const auto kernel = get_word_batch_kernel(detect_simd_level());
+    kernel(words, n_words, batch);
+}
+
+} // namespace smx
+
+/**
+ * Frame boundary markers and the scanning of the data for them.
+ *
+ * The markers are stored in the LS32B of the first word of the frame header and trailer, the MS32B holds the event
+ * number. Only words with exactly the marker in the LS32B are marker candidates.
+ */
+namespace markers
+{
+constexpr uint32_t start{0x579acce7}; ///< pattern which indicates begin of the frame
+constexpr uint32_t stop{0xed9acce7};  ///< pattern which indicates end of the frame
+
+/**
+ * @param word 64-bit word
+ * @return whether the word holds the start marker
+ */
+constexpr auto is_start(uint64_t word) -> bool { return static_cast<uint32_t>(word) == start; }
+
+/**
+ * @param word 64-bit word
+ * @return whether the word holds the stop marker
+ */
+constexpr auto is_stop(uint64_t word) -> bool { return static_cast<uint32_t>(word) == stop; }
+
+/**
+ * Find function, returns the first word in `[first, last)` holding the marker, or `last`.
+ */
+using find_kernel = const uint64_t* (*)(const uint64_t* first, const uint64_t* last, uint32_t marker);
+
+/**
+ * Scalar find kernel.
+ *
+ * @param first first word to check
+ * @param last end of the words
+ * @param marker the marker
+ * @return the first word with the marker, `last` if not found
+ */
+inline auto find_scalar(const uint64_t* first, const uint64_t* last, uint32_t marker) -> const uint64_t*
+{
+    return std::find_if(first, last, [marker](uint64_t word) { return static_cast<uint32_t>(word) == marker; });
+}
+
+#ifdef GERI_SMX_DECODER_X86_SIMD
+/**
+ * SSE4.1 find kernel, 2 words per instruction. See `find_scalar()`.
+ */
+__attribute__((target("sse4.1"))) inline auto find_sse4(const uint64_t* first, const uint64_t* last,
+                                                        uint32_t marker) -> const uint64_t*
+{
+    const auto low_mask = _mm_set1_epi64x(0xffffffff);
+    const auto pattern = _mm_set1_epi64x(marker);
+
+    for (; last - first >= 2; first += 2)
+    {
+        auto word = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), low_mask);
+        auto found = static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(word, pattern))));
+        if (found != 0) { return first + __builtin_ctz(found); }
+    }
+
+    return find_scalar(first, last, marker);
+}
+
+/**
+ * AVX2 find kernel, 4 words per instruction. See `find_scalar()`.
+ */
+__attribute__((target("avx2"))) inline auto find_avx2(const uint64_t* first, const uint64_t* last, uint32_t marker)
+    -> const uint64_t*
+{
+    const auto low_mask = _mm256_set1_epi64x(0xffffffff);
+    const auto pattern = _mm256_set1_epi64x(marker);
+
+    for (; last - first >= 4; first += 4)
+    {
+        auto word = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)), low_mask);
+        auto found =
+            static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(word, pattern))));
+        if (found != 0) { return first + __builtin_ctz(found); }
+    }
+
+    return find_scalar(first, last, marker);
+}
+
+/**
+ * AVX-512 find kernel, 8 words per instruction. See `find_scalar()`.
+ */
+__attribute__((target("avx512f"))) inline auto find_avx512(const uint64_t* first, const uint64_t* last,
+                                                           uint32_t marker) -> const uint64_t*
+{
+    const auto low_mask = _mm512_set1_epi64(0xffffffff);
+    const auto pattern = _mm512_set1_epi64(marker);
+
+    for (; last - first >= 8; first += 8)
+    {
+        auto found = static_cast<unsigned>(
+            _mm512_cmpeq_epi64_mask(_mm512_and_si512(_mm512_loadu_si512(first), low_mask), pattern));
+        if (found != 0) { return first + __builtin_ctz(found); }
+    }
+
+    return find_scalar(first, last, marker);
+}
+#endif
+
+/**
+ * Get the find kernel for the SIMD level. Levels not supported by the build fall back to the scalar kernel.
+ *
+ * @param level the SIMD level
+ * @return the kernel
+ */
+inline auto get_find_kernel(smx::SIMD_LEVEL level) -> find_kernel
+{
+    switch (level)
+    {
+#ifdef GERI_SMX_DECODER_X86_SIMD
+        case smx::SIMD_LEVEL::avx512:
+            return &find_avx512;
+        case smx::SIMD_LEVEL::avx2:
+            return &find_avx2;
+        case smx::SIMD_LEVEL::sse4:
+            return &find_sse4;
+#endif
+        default:
+            return &find_scalar;
+    }
+}
+
+/**
+ * Find the first word holding the marker, with the best kernel supported by the CPU.
+ *
+ * @param first first word to check
+ * @param last end of the words
+ * @param marker the marker
+ * @return the first word with the marker, `last` if not found
+ */
+inline auto find(const uint64_t* first, const uint64_t* last, uint32_t marker) -> const uint64_t*
+{
+    static const auto kernel = get_find_kernel(smx::detect_simd_level());
+    return kernel(first, last, marker);
+}
+
+/**
+ * Check the frame header of the start marker candidate: the fourth word of the header must be zero. Candidates too
+ * close to the end of the words cannot be checked and are accepted.
+ *
+ * @param word the start marker candidate
+ * @param last end of the words
+ * @return false if the candidate is not followed by valid frame header
+ */
+inline auto valid_header(const uint64_t* word, const uint64_t* last) -> bool
+{
+    return last - word < 4 or word[3] == 0x0;
+}
+
+/**
+ * Check the frame of the start marker candidate: valid header, and the first stop marker after it with the same event
+ * number followed by the trailer with two zero words. The frame must not contain another start marker with valid
+ * header, so the words are scanned only up to the next frame.
+ *
+ * @param word the start marker candidate
+ * @param last end of the words
+ * @return false if the candidate does not begin a complete frame within the words
+ */
+inline auto valid_frame(const uint64_t* word, const uint64_t* last) -> bool
+{
+    if (last - word < 8 or word[3] != 0x0) { return false; }
+
+    const auto* trailer = find(word + 4, last, stop);
+    for (auto* next = find(word + 4, trailer, start); next != trailer; next = find(next + 1, trailer, start))
+    {
+        if (valid_header(next, last)) { return false; }
+    }
+
+    return trailer != last and (*trailer >> 32) == (*word >> 32) and last - trailer >= 4 and trailer[2] == 0x0 and
+           trailer[3] == 0x0;
+}
+
+/**
+ * Find the first complete frame in the words, e.g. to join the stream in the middle or to skip a broken section.
+ *
+ * The start marker candidates are checked with `valid_frame()`, so markers-like patterns in the data are skipped.
+ * The number of skipped bytes is the returned index times 8.
+ *
+ * @param words the data words
+ * @return index of the frame start marker, `words.size()` if there is no complete frame
+ */
+inline auto find_frame_start(span<const uint64_t> words) -> std::size_t
+{
+    const auto* last = words.data() + words.size();
+    auto* word = find(words.data(), last, start);
+    while (word != last and !valid_frame(word, last))
+    {
+        word = find(word + 1, last, start);
+    }
+
+    return static_cast<std::size_t>(word - words.data());
+}
+} // namespace markers
+
+namespace gbt
+{
+
+/**
+ * GBT uplink address data.
+ */
+struct gbt_uplink_addr
+{
+    uint8_t gbt{0x0};         ///< gbt number
+    uint8_t uplink{0x0};      ///< uplink number
+    uint8_t unique_addr{0x0}; ///< unique address
+};
+
+/**
+ * Get Gbt address (uplink + GBT) from the word.
+ *
+ * @param word 24-bit data word
+ */
+constexpr auto get_gbt_uplink_addr(uint32_t word)
+{
+    gbt_uplink_addr decoded_addr;
+
+    word >>= 24;
+    decoded_addr.unique_addr = static_cast<uint8_t>(word & 0xff);
+    decoded_addr.uplink = word & 0x1f; //  [28-24] uplink no
+    word >>= 5;
+    decoded_addr.gbt = word & 0x3;     //  [31-29] gbt no
+
+    return decoded_addr;
+}
+
+} // namespace gbt
+
+/**
+ * GBT hit data.
+ *
+ * It is a basic data structure corresponding to hit read out by a single channel of the SMX.
+ */
+struct gbt_hit : gbt::gbt_uplink_addr, smx::hit
+{
+    /**
+     * @param addr uplink address
+     */
+    explicit gbt_hit(const gbt::gbt_uplink_addr& addr) : gbt::gbt_uplink_addr{addr} {}
+
+    /**
+     * Compare hits, they need to match with all components.
+     *
+     * @param rhs the other hit to compare
+     * @return test result
+     */
+    auto operator=(const smx::hit& rhs) -> gbt_hit&
+    {
+        channel = rhs.channel;
+        adc = rhs.adc;
+        ts = rhs.ts;
+        full_ts = rhs.full_ts;
+        event_missing = rhs.event_missing;
+
+        return *this;
+    }
+};
+
+/**
+ * Monotonic memory arena.
+ *
+ * Memory is served from large blocks by bumping a pointer, deallocation does nothing and the blocks are freed only
+ * with the arena. The hits storage of the frames reused with `frame_pool` reaches its steady size after few frames, so
+ * the decoding then runs without any calls to the global heap, also when the frames are released in other threads.
+ * The decoder does not trim the capacity of such frames, as the memory would not be reused.
+ *
+ * The arena is not synchronized, it shall be used by single thread, see `this_thread()`.
+ */
+class monotonic_arena
+{
+public:
+    static constexpr std::size_t default_block_size{1 << 20}; ///< default size of the memory blocks
+
+    /**
+     * @param block_size minimal size of the memory blocks
+     */
+    explicit monotonic_arena(std::size_t block_size = default_block_size) : m_block_size{block_size} {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    auto operator=(const monotonic_arena&) -> monotonic_arena& = delete;
+
+    ~monotonic_arena()
+    {
+        while (m_blocks != nullptr)
+        {
+            auto* next = m_blocks->next;
+            ::operator delete(m_blocks);
+            m_blocks = next;
+        }
+    }
+
+    /**
+     * Allocate memory, valid for the lifetime of the arena.
+     *
+     * @param bytes size of the memory
+     * @param alignment alignment of the memory, power of two
+     * @return the memory
+     */
+    auto allocate(std::size_t bytes, std::size_t alignment) -> void*
+    {
+        auto pos = align(m_cursor, alignment);
+        if (m_blocks == nullptr or pos > m_end or bytes > m_end - pos)
+        {
+            add_block(bytes + alignment);
+            pos = align(m_cursor, alignment);
+        }
+
+        m_cursor = pos + bytes;
+        return reinterpret_cast<void*>(pos); // NOLINT(performance-no-int-to-ptr)
+    }
+
+    /**
+     * Does nothing, the memory is freed with the arena.
+     */
+    auto deallocate(void* /*ptr*/, std::size_t /*bytes*/) -> void {}
+
+    /// @return number of the memory blocks taken from the global heap
+    auto blocks() const -> std::size_t { return m_n_blocks; }
+
+    /// @return total size of the memory blocks
+    auto reserved() const -> std::size_t { return m_reserved; }
+
+    /**
+     * Arena of the calling thread, destroyed at the thread exit, so it must outlive the memory allocated from it.
+     *
+     * @return the arena
+     */
+    static auto this_thread() -> monotonic_arena&
+    {
+        static thread_local monotonic_arena arena;
+        return arena;
+    }
+
+private:
+    /**
+     * Header of the memory block, followed by the block memory.
+     */
+    struct block
+    {
+        block* next; ///< previously allocated block
+    };
+
+    static auto align(std::uintptr_t pos, std::size_t alignment) -> std::uintptr_t
+    {
+        return (pos + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    }
+
+    auto add_block(std::size_t bytes) -> void
+    {
+        const auto size = sizeof(block) + std::max(bytes, m_block_size);
+        auto* blk = static_cast<block*>(::operator new(size));
+        blk->next = m_blocks;
+        m_blocks = blk;
+        ++m_n_blocks;
+        m_reserved += size;
+
+        m_cursor = reinterpret_cast<std::uintptr_t>(blk + 1);
+        m_end = reinterpret_cast<std::uintptr_t>(blk) + size;
+    }
+
+    std::size_t m_block_size;   ///< minimal size of the memory blocks
+    block* m_blocks{nullptr};   ///< allocated blocks, the current first
+    std::uintptr_t m_cursor{0}; ///< free memory of the current block
+    std::uintptr_t m_end{0};    ///< end of the current block
+    std::size_t m_n_blocks{0};  ///< number of the blocks
+    std::size_t m_reserved{0};  ///< total size of the blocks
+};
+
+/**
+ * Allocator serving the memory from `monotonic_arena`.
+ *
+ * The default constructed allocator uses the arena of the calling thread.
+ * ```c++
+ * geri::arena_payload_frame frame;  // hits in geri::monotonic_arena::this_thread()
+ * geri::arena_payload_frame other{geri::arena_allocator<geri::gbt_hit>(&arena)};
+ * ```
+ */
+template <typename T> class arena_allocator
+{
+public:
+    using value_type = T;
+
+    arena_allocator() noexcept : m_arena{&monotonic_arena::this_thread()} {}
+
+    /**
+     * @param arena the arena, must outlive the allocated memory
+     */
+    explicit arena_allocator(monotonic_arena* arena) noexcept : m_arena{arena} {}
+
+    template <typename U> arena_allocator(const arena_allocator<U>& other) noexcept : m_arena{other.arena()} {}
+
+    auto allocate(std::size_t n) -> T*
+    {
+        if (n > std::size_t(-1) / sizeof(T)) { throw std::bad_alloc(); }
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    auto deallocate(T* ptr, std::size_t n) noexcept -> void { m_arena->deallocate(ptr, n * sizeof(T)); }
+
+    /// @return the arena
+    auto arena() const noexcept -> monotonic_arena* { return m_arena; }
+
+    template <typename U> auto operator==(const arena_allocator<U>& rhs) const noexcept -> bool
+    {
+        return m_arena == rhs.arena();
+    }
+
+    template <typename U> auto operator!=(const arena_allocator<U>& rhs) const noexcept -> bool
+    {
+        return m_arena != rhs.arena();
+    }
+
+private:
+    monotonic_arena* m_arena; ///< the arena
+};
+
+/**
+ * Payload data, which is a collection of gbt_hit with system timestamp and event number info.
+ *
+ * The hits are allocated with the `Allocator`, see `payload_frame` for the default one, `arena_payload_frame` and
+ * `pmr::payload_frame`.
+ */
+template <typename Allocator = std::allocator<gbt_hit>> struct basic_payload_frame
+{
+    using allocator_type = Allocator;
+
+    uint32_t event_no{0};                 ///< event number
+    uint64_t system_ts{0};                ///< system timestamp
+    bool data_dropped{false};             ///< flag if data was dropped in the preceding payload
+
+    std::vector<gbt_hit, Allocator> hits; ///< hits in the event
+
+    basic_payload_frame() = default;
+
+    /**
+     * @param alloc allocator of the hits
+     */
+    explicit basic_payload_frame(const Allocator& alloc) : hits(alloc) {}
+
+    /// @return allocator of the hits
+    auto get_allocator() const -> allocator_type { return hits.get_allocator(); }
+
+    /**
+     * Reset the frame for reuse. The hits capacity is kept.
+     */
+    auto clear() -> void
+    {
+        event_no = 0;
+        system_ts = 0;
+        data_dropped = false;
+        hits.clear();
+    }
+};
+
+/**
+ * Payload frame with the hits in the global heap.
+ */
+using payload_frame = basic_payload_frame<>;
+
+/**
+ * Payload frame with the hits in `monotonic_arena`.
+ */
+using arena_payload_frame = basic_payload_frame<arena_allocator<gbt_hit>>;
+
+/**
+ * Payload data stored column-wise (structure of arrays).
+ *
+ * Each hit field is stored in a separate contiguous array, so analyses scanning one or two fields access only the
+ * data they need. The fields redundant in `gbt_hit` are not stored: GBT and uplink numbers are derived from the unique
+ * address, and the 10-bit hit timestamp from the full timestamp. Hits can be still accessed as `gbt_hit` objects:
+ * ```c++
+ * for (const auto& hit : frame) { ... }
+ * ```
+ */
+class columnar_frame
+{
+public:
+    /**
+     * Bits of the hit flags.
+     */
+    enum FLAGS : uint8_t
+    {
+        event_missing = 0x1   ///< previous event was missing
+    };
+
+    uint32_t event_no{0};     ///< event number
+    uint64_t system_ts{0};    ///< system timestamp
+    bool data_dropped{false}; ///< flag if data was dropped in the preceding payload
+
+    /**
+     * Iterator over hits, yields `gbt_hit` objects assembled from the columns.
+     */
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = gbt_hit;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const gbt_hit*;
+        using reference = gbt_hit;
+
+        const_iterator(const columnar_frame* frame, std::size_t idx) : m_frame{frame}, m_idx{idx} {}
+
+        auto operator*() const -> gbt_hit { return m_frame->hit(m_idx); }
+        auto operator++() -> const_iterator&
+        {
+            ++m_idx;
+            return *this;
+        }
+        auto operator++(int) -> const_iterator
+        {
+            auto tmp = *this;
+            ++m_idx;
+            return tmp;
+        }
+        auto operator==(const const_iterator& rhs) const -> bool { return m_idx == rhs.m_idx; }
+        auto operator!=(const const_iterator& rhs) const -> bool { return m_idx != rhs.m_idx; }
+
+    private:
+        const columnar_frame* m_frame; ///< iterated frame
+        std::size_t m_idx;             ///< index of the hit
+    };
+
+    /**
+     * Append the hit.
+     *
+     * @param unique_addr GBT/uplink unique address
+     * @param channel channel number
+     * @param adc adc value
+     * @param full_ts full timestamp
+     * @param flags hit flags, see FLAGS
+     */
+    auto push_back(uint8_t unique_addr, uint8_t channel, uint8_t adc, uint16_t full_ts, uint8_t flags) -> void
+    {
+        m_addr.push_back(unique_addr);
+        m_channel.push_back(channel);
+        m_adc.push_back(adc);
+        m_full_ts.push_back(full_ts);
+        m_flags.push_back(flags);
+    }
+
+    /**
+     * Append the hit.
+     *
+     * @param hit the hit
+     */
+    auto push_back(const gbt_hit& hit) -> void
+    {
+        push_back(hit.unique_addr, hit.channel, hit.adc, hit.full_ts,
+                  static_cast<uint8_t>(hit.event_missing ? FLAGS::event_missing : 0));
+    }
+
+    /**
+     * Set the hit at the index, e.g. after `resize()`.
+     *
+     * @param idx hit index
+     * @param unique_addr GBT/uplink unique address
+     * @param channel channel number
+     * @param adc adc value
+     * @param full_ts full timestamp
+     * @param flags hit flags, see FLAGS
+     */
+    auto set(std::size_t idx, uint8_t unique_addr, uint8_t channel, uint8_t adc, uint16_t full_ts, uint8_t flags)
+        -> void
+    {
+        m_addr[idx] = unique_addr;
+        m_channel[idx] = channel;
+        m_adc[idx] = adc;
+        m_full_ts[idx] = full_ts;
+        m_flags[idx] = flags;
+    }
+
+    /**
+     * Get the hit assembled from the columns.
+     *
+     * @param idx hit index
+     * @return the hit
+     */
+    auto hit(std::size_t idx) const -> gbt_hit
+    {
+        gbt_hit assembled{gbt::get_gbt_uplink_addr(uint32_t{m_addr[idx]} << 24)};
+        assembled.channel = m_channel[idx];
+        assembled.adc = m_adc[idx];
+        assembled.ts = m_full_ts[idx] & 0x3ff;
+        assembled.full_ts = m_full_ts[idx];
+        assembled.event_missing = (m_flags[idx] & FLAGS::event_missing) != 0;
+        return assembled;
+    }
+
+    auto begin() const -> const_iterator { return {this, 0}; }
+    auto end() const -> const_iterator { return {this, size()}; }
+
+    /// @return GBT/uplink unique addresses of the hits
+    auto addr() const -> span<const uint8_t> { return {m_addr.data(), m_addr.size()}; }
+    /// @return channel numbers of the hits
+    auto channel() const -> span<const uint8_t> { return {m_channel.data(), m_channel.size()}; }
+    /// @return adc values of the hits
+    auto adc() const -> span<const uint8_t> { return {m_adc.data(), m_adc.size()}; }
+    /// @return full timestamps of the hits
+    auto full_ts() const -> span<const uint16_t> { return {m_full_ts.data(), m_full_ts.size()}; }
+    /// @return flags of the hits, see FLAGS
+    auto flags() const -> span<const uint8_t> { return {m_flags.data(), m_flags.size()}; }
+
+    /// @return number of hits
+    auto size() const -> std::size_t { return m_addr.size(); }
+    /// @return true if there are no hits
+    auto empty() const -> bool { return m_addr.empty(); }
+    /// @return number of hits which fit into the columns without reallocation
+    auto capacity() const -> std::size_t { return m_addr.capacity(); }
+
+    /**
+     * Reserve space for hits in all columns.
+     *
+     * @param n number of hits
+     */
+    auto reserve(std::size_t n) -> void
+    {
+        m_addr.reserve(n);
+        m_channel.reserve(n);
+        m_adc.reserve(n);
+        m_full_ts.reserve(n);
+        m_flags.reserve(n);
+    }
+
+    /**
+     * Resize all columns, the added hits are zero.
+     *
+     * @param n number of hits
+     */
+    auto resize(std::size_t n) -> void
+    {
+        m_addr.resize(n);
+        m_channel.resize(n);
+        m_adc.resize(n);
+        m_full_ts.resize(n);
+        m_flags.resize(n);
+    }
+
+    /**
+     * Release unused capacity of all columns.
+     */
+    auto shrink_to_fit() -> void
+    {
+        m_addr.shrink_to_fit();
+        m_channel.shrink_to_fit();
+        m_adc.shrink_to_fit();
+        m_full_ts.shrink_to_fit();
+        m_flags.shrink_to_fit();
+    }
+
+    /**
+     * Reset the frame for reuse. The columns capacity is kept.
+     */
+    auto clear() -> void
+    {
+        event_no = 0;
+        system_ts = 0;
+        data_dropped = false;
+        m_addr.clear();
+        m_channel.clear();
+        m_adc.clear();
+        m_full_ts.clear();
+        m_flags.clear();
+    }
+
+private:
+    std::vector<uint8_t> m_addr;     ///< GBT/uplink unique addresses
+    std::vector<uint8_t> m_channel;  ///< channel numbers
+    std::vector<uint8_t> m_adc;      ///< adc values
+    std::vector<uint16_t> m_full_ts; ///< full timestamps
+    std::vector<uint8_t> m_flags;    ///< hit flags
+};
+
+/**
+ * Pool of reusable payload frames.
+ *
+ * Frames are handed out as `frame_ptr`, which returns the frame to the pool when destroyed, so the frames and their
+ * hits capacity are recycled also when they are passed to and released by other threads. The pool is thread-safe and
+ * must outlive all acquired frames.
+ * ```c++
+ * geri::frame_pool pool;
+ * auto frame = pool.acquire();
+ * decoder.decode_frame(*frame);
+ * ```
+ *
+ * The new frames are created with the allocator of the pool. With `arena_payload_frame` the arena is not synchronized,
+ * so the frames shall be acquired and filled by the thread owning the arena, and can be released by any thread.
+ */
+template <typename Frame = payload_frame> class basic_frame_pool
+{
+public:
+    /**
+     * Returns the frame to its pool.
+     */
+    class recycler
+    {
+    public:
+        recycler() = default;
+        explicit recycler(basic_frame_pool* pool) : m_pool{pool} {}
+
+        auto operator()(Frame* frame) const -> void
+        {
+            if (m_pool) { m_pool->release(frame); }
+            else { delete frame; }
+        }
+
+    private:
+        basic_frame_pool* m_pool{nullptr}; ///< owning pool
+    };
+
+    using allocator_type = typename Frame::allocator_type;
+    using frame_ptr = std::unique_ptr<Frame, recycler>;
+
+    /**
+     * @param max_cached maximal number of idle frames kept in the pool, excess frames are freed
+     * @param alloc allocator of the hits of the new frames
+     */
+    explicit basic_frame_pool(std::size_t max_cached = default_max_cached, const allocator_type& alloc = {})
+        : m_max_cached{max_cached}, m_alloc{alloc}
+    {
+    }
+
+    basic_frame_pool(const basic_frame_pool&) = delete;
+    auto operator=(const basic_frame_pool&) -> basic_frame_pool& = delete;
+
+    ~basic_frame_pool()
+    {
+        for (auto* frame : m_frames)
+        {
+            delete frame;
+        }
+    }
+
+    /**
+     * Get a cleared frame from the pool, new frame is created if the pool is empty.
+     *
+     * @return the frame
+     */
+    auto acquire() -> frame_ptr
+    {
+        Frame* frame{nullptr};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_frames.empty())
+            {
+                frame = m_frames.back();
+                m_frames.pop_back();
+            }
+        }
+
+        if (frame == nullptr) { frame = new Frame(m_alloc); }
+
+        return frame_ptr(frame, recycler(this));
+    }
+
+    /**
+     * @return number of idle frames in the pool
+     */
+    auto size() const -> std::size_t
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_frames.size();
+    }
+
+private:
+    static constexpr std::size_t default_max_cached{64}; ///< default maximal number of idle frames
+
+    auto release(Frame* frame) -> void
+    {
+        frame->clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_frames.size() < m_max_cached)
+            {
+                m_frames.push_back(frame);
+                return;
+            }
+        }
+        delete frame;
+    }
+
+    std::size_t m_max_cached;     ///< maximal number of idle frames
+    allocator_type m_alloc;       ///< allocator of the new frames
+    std::vector<Frame*> m_frames; ///< idle frames
+    mutable std::mutex m_mutex;   ///< guards the idle frames
+};
+
+/**
+ * Pool of the payload frames with the hits in the global heap.
+ */
+using frame_pool = basic_frame_pool<>;
+
+/**
+ * Pool of the payload frames with the hits in `monotonic_arena`.
+ */
+using arena_frame_pool = basic_frame_pool<arena_payload_frame>;
+
+#ifdef __cpp_lib_memory_resource
+namespace pmr
+{
+/**
+ * Payload frame with the hits in `std::pmr::memory_resource`, C++17.
+ */
+using payload_frame = basic_payload_frame<std::pmr::polymorphic_allocator<gbt_hit>>;
+
+/**
+ * Pool of the payload frames with the hits in `std::pmr::memory_resource`, C++17.
+ */
+using frame_pool = basic_frame_pool<payload_frame>;
+} // namespace pmr
+#endif
+
+inline void close_file(std::FILE* fp) { std::fclose(fp); }
+
+/**
+ * Handles file from which the data will be read from.
+ *
+ * It owns the file pointer. The file is read in large blocks (see `default_block_size`) into an internal buffer, from
+ * which the data words are served. Exposes:
+ * - `read_word()` which returns the next data word, and `try_read_word()` which signals EOF without throwing,
+ * - `read_words()` which copies up to `n` next data words into the user buffer,
+ * - `read_block()` which returns view of all the buffered data words not consumed yet.
+ */
+class file_reader
+{
+private:
+    std::unique_ptr<FILE, decltype(&close_file)> fp; ///< file pointer
+
+    std::vector<uint64_t> buffer;                    ///< block buffer
+    std::size_t head{0};                             ///< index of the next word to be consumed
+    std::size_t tail{0};                             ///< number of valid words in the buffer
+
+    /**
+     * Read the next block of data from the file. Unconsumed data are discarded.
+     *
+     * @return true if any word was read
+     */
+    auto refill() -> bool
+    {
+        head = 0;
+        tail = std::fread(buffer.data(), sizeof(uint64_t), buffer.size(), fp.get());
+        return tail != 0;
+    }
+
+public:
+    static constexpr std::size_t default_block_size{4UL * 1024UL * 1024UL}; ///< default block size in bytes
+
+    /**
+     * @param filename file to read from
+     * @param block_size size of the read block in bytes, rounded down to the full words
+     */
+    explicit file_reader(const char* filename, std::size_t block_size = default_block_size)
+        : fp{fopen(filename, "rxe"), &close_file}, buffer(std::max<std::size_t>(block_size / sizeof(uint64_t), 1))
+    {
+        if (fp == nullptr) { abort(); }
+
+        // data are buffered here already, and the file is read sequentially from begin to end
+        std::setvbuf(fp.get(), nullptr, _IONBF, 0);
+#if defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(fileno(fp.get()), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+
+    /**
+     * Read the next data word from the file, without throwing.
+     *
+     * @param word 64-bit word
+     * @return `ok` or `end_of_data`
+     */
+    auto try_read_word(uint64_t& word) -> DECODE_STATUS
+    {
+        if (head == tail and !refill()) { return DECODE_STATUS::end_of_data; }
+
+        word = buffer[head++];
+        return DECODE_STATUS::ok;
+    }
+
+    /**
+     * Red the next data word from the file.
+     *
+     * EOF is marked by `std::out_of_range` exception.
+     *
+     * @return 64-bit word
+     */
+    auto read_word() -> uint64_t
+    {
+        uint64_t word{0};
+        if (try_read_word(word) != DECODE_STATUS::ok) { throw std::out_of_range("END OF DATA"); }
+
+        return word;
+    }
+
+    /**
+     * Read up to `n` next data words.
+     *
+     * @param dst destination buffer, must hold at least `n` words
+     * @param n number of words to read
+     * @return number of words read, smaller than `n` only at the end of file
+     */
+    auto read_words(uint64_t* dst, std::size_t n) -> std::size_t
+    {
+        std::size_t copied{0};
+
+        while (copied != n)
+        {
+            if (head == tail and !refill()) { break; }
+
+            auto count = std::min(n - copied, tail - head);
+            std::copy(buffer.data() + head, buffer.data() + head + count, dst + copied);
+            head += count;
+            copied += count;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Return all buffered data words which were not consumed yet, the next block is read if necessary. The returned
+     * words are marked as consumed. The view is valid until the next read call.
+     *
+     * @return view of the data words, empty at the end of file
+     */
+    auto read_block() -> span<const uint64_t>
+    {
+        if (head == tail and !refill()) { return {}; }
+
+        auto block = span<const uint64_t>(buffer.data() + head, tail - head);
+        head = tail;
+        return block;
+    }
+
+    /**
+     * Move to the position in the file. Buffered data are discarded.
+     *
+     * @param offset position in bytes from the beginning of the file, should be aligned to the full words
+     * @return false if the position cannot be set
+     */
+    auto seek(uint64_t offset) -> bool
+    {
+        head = tail = 0;
+        clearerr(fp.get());
+#if defined(GERI_SMX_DECODER_POSIX)
+        return fseeko(fp.get(), static_cast<off_t>(offset), SEEK_SET) == 0;
+#elif defined(_WIN32)
+        return _fseeki64(fp.get(), static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+        return offset <= LONG_MAX and std::fseek(fp.get(), static_cast<long>(offset), SEEK_SET) == 0;
+#endif
+    }
+};
+
+/**
+ * Reads data words from memory buffer, e.g. DMA or shared memory region.
+ *
+ * It does not own the buffer, the buffer must outlive the reader. Provides the same interface as `file_reader`, but
+ * `read_block()` returns all remaining words at once, so the decoder walks the buffer in place without any copy.
+ */
+class memory_reader
+{
+private:
+    span<const uint64_t> words; ///< data buffer
+    std::size_t pos{0};         ///< index of the next word to be consumed
+
+public:
+    /**
+     * @param data buffer of the data words
+     */
+    explicit memory_reader(span<const uint64_t> data) : words{data} {}
+
+    /**
+     * @param data pointer to the first data word
+     * @param size number of data words
+     */
+    memory_reader(const uint64_t* data, std::size_t size) : words{data, size} {}
+
+    /**
+     * Read the next data word from the buffer, without throwing.
+     *
+     * @param word 64-bit word
+     * @return `ok` or `end_of_data`
+     */
+    auto try_read_word(uint64_t& word) -> DECODE_STATUS
+    {
+        if (pos == words.size()) { return DECODE_STATUS::end_of_data; }
+
+        word = words[pos++];
+        return DECODE_STATUS::ok;
+    }
+
+    /**
+     * Red the next data word from the buffer.
+     *
+     * EOF is marked by `std::out_of_range` exception.
+     *
+     * @return 64-bit word
+     */
+    auto read_word() -> uint64_t
+    {
+        uint64_t word{0};
+        if (try_read_word(word) != DECODE_STATUS::ok) { throw std::out_of_range("END OF DATA"); }
+
+        return word;
+    }
+
+    /**
+     * Read up to `n` next data words.
+     *
+     * @param dst destination buffer, must hold at least `n` words
+     * @param n number of words to read
+     * @return number of words read, smaller than `n` only at the end of buffer
+     */
+    auto read_words(uint64_t* dst, std::size_t n) -> std::size_t
+    {
+        auto count = std::min(n, words.size() - pos);
+        std::copy(words.data() + pos, words.data() + pos + count, dst);
+        pos += count;
+        return count;
+    }
+
+    /**
+     * Return all data words which were not consumed yet and mark them as consumed.
+     *
+     * @return view of the data words, empty at the end of buffer
+     */
+    auto read_block() -> span<const uint64_t>
+    {
+        auto block = span<const uint64_t>(words.data() + pos, words.size() - pos);
+        pos = words.size();
+        return block;
+    }
+
+    /**
+     * Move to the position in the buffer.
+     *
+     * @param offset position in bytes from the beginning of the buffer, rounded down to the full words
+     * @return false if the position is beyond the buffer
+     */
+    auto seek(uint64_t offset) -> bool
+    {
+        if (offset / sizeof(uint64_t) > words.size()) { return false; }
+
+        pos = static_cast<std::size_t>(offset / sizeof(uint64_t));
+        return true;
+    }
+
+    /**
+     * @return view of the whole buffer
+     */
+    auto data() const -> span<const uint64_t> { return words; }
+};
+
+#ifdef GERI_SMX_DECODER_POSIX
+namespace detail
+{
+/**
+ * Read-only mapping of the whole file as bytes.
+ */
+struct byte_mapping
+{
+    void* addr{MAP_FAILED}; ///< mapping address
+    std::size_t length{0};  ///< mapping length in bytes
+
+    /**
+     * @param filename file to map, terminates the program if the file cannot be mapped
+     * @param advice expected access pattern passed to `madvise()`
+     */
+    explicit byte_mapping(const char* filename, int advice = MADV_SEQUENTIAL)
+    {
+        auto fd = open(filename, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) { abort(); }
+
+        struct stat file_stat{};
+        if (fstat(fd, &file_stat) != 0) { abort(); }
+
+        length = static_cast<std::size_t>(file_stat.st_size);
+        if (length != 0)
+        {
+            addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) { abort(); }
+
+            madvise(addr, length, advice);
+        }
+
+        close(fd);
+    }
+
+    byte_mapping(const byte_mapping&) = delete;
+    auto operator=(const byte_mapping&) -> byte_mapping& = delete;
+
+    ~byte_mapping()
+    {
+        if (addr != MAP_FAILED) { munmap(addr, length); }
+    }
+
+    auto data() const -> const unsigned char*
+    { return addr == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(addr); }
+};
+} // namespace detail
+
+/**
+ * Maps the whole file into memory and reads data words directly from the mapping.
+ *
+ * See `memory_reader` for the interface. The file is mapped read-only with sequential access hint. Available on the
+ * POSIX systems only.
+ */
+class mmap_reader : public memory_reader
+{
+private:
+    std::unique_ptr<detail::byte_mapping> file_map; ///< file mapping viewed by the base reader
+
+    explicit mmap_reader(std::unique_ptr<detail::byte_mapping> fmap)
+        : memory_reader{reinterpret_cast<const uint64_t*>(fmap->data()), fmap->length / sizeof(uint64_t)},
+          file_map{std::move(fmap)}
+    {
+    }
+
+public:
+    /**
+     * @param filename file to map
+     */
+    explicit mmap_reader(const char* filename)
+        : mmap_reader{std::unique_ptr<detail::byte_mapping>(new detail::byte_mapping(filename))}
+    {
+    }
+};
+#endif
+
+namespace detail
+{
+/**
+ * Detects whether reader provides bulk `read_block()` interface.
+ */
+template <typename T, typename = void> struct has_read_block : std::false_type
+{
+};
+
+template <typename T>
+struct has_read_block<T, decltype(void(std::declval<T&>().read_block()))> : std::true_type
+{
+};
+
+/**
+ * Detects whether reader provides non-throwing `try_read_word()` interface.
+ */
+template <typename T, typename = void> struct has_try_read_word : std::false_type
+{
+};
+
+template <typename T>
+struct has_try_read_word<T, decltype(void(std::declval<T&>().try_read_word(std::declval<uint64_t&>())))>
+    : std::true_type
+{
+};
+
+template <typename R> auto try_read_word(R& reader, uint64_t& word, std::true_type /*nothrow*/) -> bool
+{
+    return reader.try_read_word(word) == DECODE_STATUS::ok;
+}
+
+template <typename R> auto try_read_word(R& reader, uint64_t& word, std::false_type /*nothrow*/) -> bool
+{
+    try
+    {
+        word = reader.read_word();
+        return true;
+    }
+    catch (const std::out_of_range&)
+    {
+        return false;
+    }
+}
+
+/**
+ * Read the next data word with `try_read_word()` if the reader provides it, otherwise with `read_word()`.
+ *
+ * @param reader the reader
+ * @param word 64-bit word
+ * @return false at the end of data
+ */
+template <typename R> auto try_read_word(R& reader, uint64_t& word) -> bool
+{
+    return try_read_word(reader, word, has_try_read_word<R>{});
+}
+} // namespace detail
+
+/**
+ * Index of the frames in the data stream.
+ *
+ * The index is built once by scanning the start and stop markers, and allows to locate the frames by event number
+ * without decoding the stream. It can be stored in a compact sidecar file next to the data file:
+ * ```c++
+ * geri::event_index index;
+ * if (!index.load(geri::event_index::sidecar_filename(filename).c_str()))
+ * {
+ *     geri::mmap_reader mrdr(filename);
+ *     index.build(mrdr);
+ *     index.save(geri::event_index::sidecar_filename(filename).c_str());
+ * }
+ * ```
+ */
+class event_index
+{
+public:
+    /**
+     * Location of the single frame.
+     */
+    struct entry
+    {
+        uint64_t offset{0};    ///< offset of the frame start marker in bytes
+        uint32_t event_no{0};  ///< event number
+        uint32_t n_words{0};   ///< number of 64-bit words of the frame, including the start and stop frames
+        uint64_t system_ts{0}; ///< system timestamp of the frame
+    };
+
+    /**
+     * Scan the reader from its current position to the end and index all complete frames. The current position is
+     * assumed to be the beginning of the stream, offsets are counted from there.
+     *
+     * @param reader the reader
+     */
+    template <typename R> auto build(R& reader) -> void
+    {
+        m_entries.clear();
+        scanner scan{};
+        scan_reader(reader, scan, detail::has_read_block<R>{});
+    }
+
+    /**
+     * @return all indexed frames, ordered by offset
+     */
+    auto entries() const -> const std::vector<entry>& { return m_entries; }
+
+    /// @return number of indexed frames
+    auto size() const -> std::size_t { return m_entries.size(); }
+
+    /**
+     * Find the frame by event number.
+     *
+     * @param event_no event number
+     * @return the frame location or nullptr if not found
+     */
+    auto find(uint32_t event_no) const -> const entry*
+    {
+        auto found = std::lower_bound(m_entries.begin(), m_entries.end(), event_no,
+                                      [](const entry& lhs, uint32_t rhs) { return lhs.event_no < rhs; });
+
+        if (found == m_entries.end() or found->event_no != event_no)
+        {
+            // event numbers not ordered, e.g. wrapped
+            found = std::find_if(m_entries.begin(), m_entries.end(),
+                                 [event_no](const entry& ent) { return ent.event_no == event_no; });
+        }
+
+        return found == m_entries.end() ? nullptr : &*found;
+    }
+
+    /**
+     * Write the index to file.
+     *
+     * @param filename index file
+     * @return false if the file cannot be written
+     */
+    auto save(const char* filename) const -> bool
+    {
+        std::unique_ptr<FILE, decltype(&close_file)> fp{fopen(filename, "wbe"), &close_file};
+        if (fp == nullptr) { return false; }
+
+        uint64_t count = m_entries.size();
+        auto written = std::fwrite(file_magic(), magic_size, 1, fp.get());
+        written += std::fwrite(&count, sizeof(count), 1, fp.get());
+        for (const auto& ent : m_entries)
+        {
+            written += write_entry(fp.get(), ent);
+        }
+
+        return written == 2 + m_entries.size();
+    }
+
+    /**
+     * Read the index from file.
+     *
+     * @param filename index file
+     * @return false if the file cannot be read or is not an index file, the index is empty then
+     */
+    auto load(const char* filename) -> bool
+    {
+        m_entries.clear();
+
+        std::unique_ptr<FILE, decltype(&close_file)> fp{fopen(filename, "rbe"), &close_file};
+        if (fp == nullptr) { return false; }
+
+        char magic[magic_size]{};
+        uint64_t count{0};
+        if (std::fread(magic, sizeof(magic), 1, fp.get()) != 1 or
+            !std::equal(magic, magic + magic_size, file_magic()) or
+            std::fread(&count, sizeof(count), 1, fp.get()) != 1)
+        {
+            return false;
+        }
+
+        // corrupted count must not allocate more than the file holds
+        if (count > remaining_bytes(fp.get()) / entry_size) { return false; }
+
+        m_entries.resize(static_cast<std::size_t>(count));
+        for (auto& ent : m_entries)
+        {
+            if (!read_entry(fp.get(), ent))
+            {
+                m_entries.clear();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * @param data_filename data file
+     * @return default name of the index file for the data file
+     */
+    static auto sidecar_filename(const std::string& data_filename) -> std::string { return data_filename + ".idx"; }
+
+private:
+    static const std::size_t magic_size{8};                    ///< size of the index file signature
+    static const std::size_t entry_size{3 * sizeof(uint64_t)}; ///< size of the entry in the index file
+
+    /// @return index file signature
+    static auto file_magic() -> const char* { return "GERIIDX1"; }
+
+    /**
+     * Scanning state.
+     */
+    struct scanner
+    {
+        uint64_t offset{0};        ///< offset of the current word, in words
+        uint64_t frame_start{0};   ///< offset of the current frame start marker, in words
+        uint64_t stop_offset{0};   ///< offset of the current frame stop marker, in words
+        uint64_t candidate{0};     ///< offset of the start marker waiting for the header check, in words
+        uint32_t event_no{0};      ///< event number of the current frame
+        uint32_t candidate_no{0};  ///< event number of the start marker candidate
+        bool in_frame{false};      ///< start marker was found
+        bool in_trailer{false};    ///< stop marker was found
+        bool has_candidate{false}; ///< start marker is waiting for the header check
+    };
+
+    /**
+     * Feed the next word to the scanner.
+     *
+     * The start marker is accepted only with valid frame header, as in `markers::valid_header()`. Valid start marker
+     * within the open frame begins a new frame, so a frame which lost its stop marker does not hide the following ones.
+     */
+    auto scan_word(scanner& scan, uint64_t word) -> void
+    {
+        if (scan.has_candidate and scan.offset == scan.candidate + 3)
+        {
+            scan.has_candidate = false;
+            if (word == 0x0)
+            {
+                scan.in_frame = true;
+                scan.in_trailer = false;
+                scan.frame_start = scan.candidate;
+                scan.event_no = scan.candidate_no;
+                ++scan.offset;
+                return;
+            }
+        }
+
+        if (scan.in_trailer)
+        {
+            if (scan.offset == scan.stop_offset + 1)
+            {
+                entry ent;
+                ent.offset = scan.frame_start * sizeof(uint64_t);
+                ent.event_no = scan.event_no;
+                ent.n_words = static_cast<uint32_t>(scan.stop_offset + 4 - scan.frame_start);
+                ent.system_ts = word;
+                m_entries.push_back(ent);
+            }
+            if (scan.offset == scan.stop_offset + 3)
+            {
+                scan.in_frame = false;
+                scan.in_trailer = false;
+            }
+        }
+        // the frame header cannot contain the markers
+        else if (!scan.in_frame or scan.offset >= scan.frame_start + 4)
+        {
+            if (markers::is_start(word) and !scan.has_candidate)
+            {
+                scan.has_candidate = true;
+                scan.candidate = scan.offset;
+                scan.candidate_no = static_cast<uint32_t>(word >> 32);
+            }
+            else if (scan.in_frame and markers::is_stop(word) and (word >> 32) == scan.event_no)
+            {
+                scan.in_trailer = true;
+                scan.stop_offset = scan.offset;
+            }
+        }
+
+        ++scan.offset;
+    }
+
+    template <typename R> auto scan_reader(R& reader, scanner& scan, std::true_type /*bulk*/) -> void
+    {
+        for (auto block = reader.read_block(); !block.empty(); block = reader.read_block())
+        {
+            const auto* last = block.data() + block.size();
+            for (const auto* word = block.data(); word != last;)
+            {
+                // jump to the next marker candidate, the words in between do not change the scanning state
+                if (!scan.in_trailer and !scan.has_candidate and
+                    (!scan.in_frame or scan.offset >= scan.frame_start + 4))
+                {
+                    const auto* found = markers::find(word, last, scan.in_frame ? markers::stop : markers::start);
+                    // new frame can begin before the stop marker of the open one
+                    if (scan.in_frame) { found = markers::find(word, found, markers::start); }
+
+                    scan.offset += static_cast<uint64_t>(found - word);
+                    word = found;
+                    if (word == last) { break; }
+                }
+
+                scan_word(scan, *word++);
+            }
+        }
+    }
+
+    template <typename R> auto scan_reader(R& reader, scanner& scan, std::false_type /*bulk*/) -> void
+    {
+        uint64_t word{0};
+        while (detail::try_read_word(reader, word))
+        {
+            scan_word(scan, word);
+        }
+    }
+
+    static auto write_entry(FILE* fp, const entry& ent) -> std::size_t
+    {
+        uint64_t packed[3] = {ent.offset, (uint64_t{ent.n_words} << 32) | ent.event_no, ent.system_ts};
+        return std::fwrite(packed, sizeof(packed), 1, fp);
+    }
+
+    /**
+     * @return number of bytes from the current position to the end of the file, 0 if it cannot be determined
+     */
+    static auto remaining_bytes(FILE* fp) -> uint64_t
+    {
+        const auto pos = std::ftell(fp);
+        if (pos < 0 or std::fseek(fp, 0, SEEK_END) != 0) { return 0; }
+
+        const auto end = std::ftell(fp);
+        if (std::fseek(fp, pos, SEEK_SET) != 0 or end < pos) { return 0; }
+
+        return static_cast<uint64_t>(end - pos);
+    }
+
+    static auto read_entry(FILE* fp, entry& ent) -> bool
+    {
+        uint64_t packed[3]{};
+        if (std::fread(packed, sizeof(packed), 1, fp) != 1) { return false; }
+
+        ent.offset = packed[0];
+        ent.event_no = static_cast<uint32_t>(packed[1]);
+        ent.n_words = static_cast<uint32_t>(packed[1] >> 32);
+        ent.system_ts = packed[2];
+        return true;
+    }
+
+    std::vector<entry> m_entries; ///< indexed frames
+};
+
+/**
+ * Data quality counters of the single GBT/uplink.
+ */
+struct uplink_counters
+{
+    std::array<uint64_t, smx::n_uplink_frame_types> words{}; ///< words of each type, including dropped hits
+    uint64_t ts_mismatch{0};                                 ///< hits dropped due to timestamp mismatch
+    uint64_t filtered{0};                                    ///< hits rejected by the hit filter
+    uint64_t invalid_ts_msb{0};                              ///< broken TS_MSB words
+    uint64_t crc_errors{0};                                  ///< TS_MSB words with wrong CRC, if checked
+
+    /**
+     * @param type the word type
+     * @return number of words of the type
+     */
+    auto count(smx::UPLINK_FRAME_TYPE type) const -> uint64_t { return words[static_cast<std::size_t>(type)]; }
+
+    /**
+     * @return number of stored hits
+     */
+    auto hits() const -> uint64_t { return count(smx::UPLINK_FRAME_TYPE::hit) - ts_mismatch - filtered; }
+};
+
+/**
+ * Data quality counters of the decoder, see `payload_decoder::get_counters()`.
+ */
+struct decoder_counters
+{
+    std::array<uplink_counters, 256> uplinks; ///< counters indexed by the unique GBT/uplink address
+    uint64_t frames{0};                       ///< decoded frames
+    uint64_t data_dropped{0};                 ///< frames with the data dropped bit set
+    uint64_t event_gaps{0};                   ///< frames not following the event number of the previous frame
+    uint64_t event_mismatches{0};             ///< stop markers with event number of other frame
+    uint64_t systime_mismatches{0};           ///< frames with last system time different from the previous frame
+    uint64_t resyncs{0};                      ///< frames preceded by data skipped while searching for the start
+    uint64_t skipped_bytes{0};                ///< bytes skipped while searching for the frame start marker
+    uint64_t false_markers{0};                ///< start marker candidates not followed by valid frame header
+    uint64_t invalid_frames{0};               ///< frames with broken or lost trailer
+
+    /**
+     * @return sum of the counters of all uplinks
+     */
+    auto total() const -> uplink_counters
+    {
+        uplink_counters sum;
+        for (const auto& uplink : uplinks)
+        {
+            for (std::size_t type = 0; type < sum.words.size(); ++type)
+            {
+                sum.words[type] += uplink.words[type];
+            }
+            sum.ts_mismatch += uplink.ts_mismatch;
+            sum.filtered += uplink.filtered;
+            sum.invalid_ts_msb += uplink.invalid_ts_msb;
+            sum.crc_errors += uplink.crc_errors;
+        }
+        return sum;
+    }
+};
+
+namespace detail
+{
+/**
+ * Counter written by a single thread, which can be read by any thread.
+ *
+ * The single writer increments it with plain load and store, no locked instruction is needed.
+ */
+class relaxed_counter
+{
+public:
+    relaxed_counter() = default;
+    relaxed_counter(const relaxed_counter& other) : value{other.load()} {}
+
+    auto operator=(const relaxed_counter& other) -> relaxed_counter&
+    {
+        value.store(other.load(), std::memory_order_relaxed);
+        return *this;
+    }
+
+    auto operator++() -> relaxed_counter&
+    {
+        value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return *this;
+    }
+
+    auto operator+=(uint64_t n) -> relaxed_counter&
+    {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        return *this;
+    }
+
+    auto load() const -> uint64_t { return value.load(std::memory_order_relaxed); }
+
+    auto reset() -> void { value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{0}; ///< counter value
+};
+
+/**
+ * Counters updated by the decoder, see `decoder_counters`.
+ */
+struct live_counters
+{
+    struct uplink
+    {
+        std::array<relaxed_counter, smx::n_uplink_frame_types> words;
+        relaxed_counter ts_mismatch;
+        relaxed_counter filtered;
+        relaxed_counter invalid_ts_msb;
+        relaxed_counter crc_errors;
+    };
+
+    std::array<uplink, 256> uplinks;
+    relaxed_counter frames;
+    relaxed_counter data_dropped;
+    relaxed_counter event_gaps;
+    relaxed_counter event_mismatches;
+    relaxed_counter systime_mismatches;
+    relaxed_counter resyncs;
+    relaxed_counter skipped_bytes;
+    relaxed_counter false_markers;
+    relaxed_counter invalid_frames;
+
+    auto snapshot() const -> decoder_counters
+    {
+        decoder_counters res;
+        for (std::size_t addr = 0; addr < uplinks.size(); ++addr)
+        {
+            for (std::size_t type = 0; type < smx::n_uplink_frame_types; ++type)
+            {
+                res.uplinks[addr].words[type] = uplinks[addr].words[type].load();
+            }
+            res.uplinks[addr].ts_mismatch = uplinks[addr].ts_mismatch.load();
+            res.uplinks[addr].filtered = uplinks[addr].filtered.load();
+            res.uplinks[addr].invalid_ts_msb = uplinks[addr].invalid_ts_msb.load();
+            res.uplinks[addr].crc_errors = uplinks[addr].crc_errors.load();
+        }
+        res.frames = frames.load();
+        res.data_dropped = data_dropped.load();
+        res.event_gaps = event_gaps.load();
+        res.event_mismatches = event_mismatches.load();
+        res.systime_mismatches = systime_mismatches.load();
+        res.resyncs = resyncs.load();
+        res.skipped_bytes = skipped_bytes.load();
+        res.false_markers = false_markers.load();
+        res.invalid_frames = invalid_frames.load();
+        return res;
+    }
+
+    auto reset() -> void
+    {
+        for (auto& upl : uplinks)
+        {
+            for (auto& word : upl.words)
+            {
+                word.reset();
+            }
+            upl.ts_mismatch.reset();
+            upl.filtered.reset();
+            upl.invalid_ts_msb.reset();
+            upl.crc_errors.reset();
+        }
+        for (auto* counter :
+             {&frames, &data_dropped, &event_gaps, &event_mismatches, &systime_mismatches, &resyncs, &skipped_bytes,
+              &false_markers, &invalid_frames})
+        {
+            counter->reset();
+        }
+    }
+};
+} // namespace detail
+
+/**
+ * Base of the frame visitors, see `payload_decoder::decode_frame(Visitor&&)`.
+ *
+ * All callbacks do nothing, derived visitors define only the callbacks they need. The callbacks are not virtual, they
+ * are resolved by the visitor type.
+ */
+struct frame_visitor
+{
+    /**
+     * Called when the frame header was decoded.
+     *
+     * @param event_no event number
+     * @param data_dropped whether data was dropped in the preceding frame
+     */
+    auto on_frame_begin(uint32_t /*event_no*/, bool /*data_dropped*/) -> void {}
+
+    /**
+     * Called for each hit matching the uplink timestamp.
+     *
+     * @param hit the hit
+     */
+    auto on_hit(const gbt_hit& /*hit*/) -> void {}
+
+    /**
+     * Called for each valid TS_MSB word.
+     *
+     * @param unique_addr GBT/uplink unique address
+     * @param ts_msb the new timestamp MSB of the uplink
+     */
+    auto on_ts_msb(uint8_t /*unique_addr*/, uint16_t /*ts_msb*/) -> void {}
+
+    /**
+     * Called for dummy hits, ack, nack, alert, seq_error and rdata_ack words.
+     *
+     * @param unique_addr GBT/uplink unique address
+     * @param type the word type
+     * @param word 32-bit GBT/uplink + SMX word
+     */
+    auto on_other_word(uint8_t /*unique_addr*/, smx::UPLINK_FRAME_TYPE /*type*/, uint32_t /*word*/) -> void {}
+
+    /**
+     * Called when the frame trailer was decoded.
+     *
+     * @param system_ts system timestamp of the frame
+     */
+    auto on_frame_end(uint64_t /*system_ts*/) -> void {}
+};
+
+/**
+ * Selection of the hits passed on by the decoder, see `payload_decoder::set_filter()`.
+ *
+ * The address, channel and adc of the hit are tested with bitmask lookups on the fields of the data word, before the
+ * `gbt_hit` is built, so the rejected hits are neither stored in the frame nor passed to the visitor. Each selection
+ * is independent: without `select_addr()`/`select_gbt()` all addresses are accepted, without `select_channels()` all
+ * channels. Dummy hits are never stored, with or without the filter.
+ * ```c++
+ * geri::hit_filter filter;
+ * filter.select_gbt(1).select_channels(0, 63).set_min_adc(4).set_skip_data_dropped();
+ * decoder.set_filter(filter);
+ * ```
+ */
+class hit_filter
+{
+public:
+    /**
+     * Accept the hits of the GBT/uplink, in addition to the already selected ones.
+     *
+     * @param addr GBT/uplink unique address
+     */
+    auto select_addr(uint8_t addr) -> hit_filter&
+    {
+        if (all_addrs)
+        {
+            addr_mask.fill(0);
+            all_addrs = false;
+        }
+        addr_mask[addr >> 6U] |= uint64_t{1} << (addr & 0x3fU);
+        return *this;
+    }
+
+    /**
+     * Accept the hits of all uplinks of the GBT, in addition to the already selected ones.
+     *
+     * @param gbt 3-bit GBT address
+     */
+    auto select_gbt(uint8_t gbt) -> hit_filter&
+    {
+        for (unsigned uplink = 0; uplink < 32; ++uplink)
+        {
+            select_addr(static_cast<uint8_t>(((gbt & 0x7U) << 5U) | uplink));
+        }
+        return *this;
+    }
+
+    /**
+     * Accept the channels of the range, in addition to the already selected ones.
+     *
+     * @param first first channel
+     * @param last last channel, inclusive
+     */
+    auto select_channels(uint8_t first, uint8_t last) -> hit_filter&
+    {
+        if (all_channels)
+        {
+            channel_mask.fill(0);
+            all_channels = false;
+        }
+        for (unsigned channel = first; channel <= std::min<unsigned>(last, 0x7f); ++channel)
+        {
+            channel_mask[channel >> 6U] |= uint64_t{1} << (channel & 0x3fU);
+        }
+        return *this;
+    }
+
+    /**
+     * @param adc lowest accepted adc value
+     */
+    auto set_min_adc(uint8_t adc) -> hit_filter&
+    {
+        adc_mask = adc < 32 ? ~uint32_t{0} << adc : 0;
+        return *this;
+    }
+
+    /**
+     * Drop all hits of the frames with the data dropped bit set. The frames are still decoded, with no hits.
+     *
+     * @param skip whether the hits are dropped
+     */
+    auto set_skip_data_dropped(bool skip = true) -> hit_filter&
+    {
+        skip_data_dropped = skip;
+        return *this;
+    }
+
+    /**
+     * @param addr GBT/uplink unique address
+     * @param channel 7-bit channel
+     * @param adc 5-bit adc
+     * @return whether the hit is accepted
+     */
+    auto accepts(uint8_t addr, uint8_t channel, uint8_t adc) const -> bool
+    {
+        return accept_bit(addr, channel, adc) != 0;
+    }
+
+    /**
+     * Branchless variant of `accepts()`.
+     *
+     * @return 1 if the hit is accepted, 0 otherwise
+     */
+    auto accept_bit(uint8_t addr, uint8_t channel, uint8_t adc) const -> uint32_t
+    {
+        const auto addr_bit = addr_mask[addr >> 6U] >> (addr & 0x3fU);
+        const auto channel_bit = channel_mask[(channel >> 6U) & 0x1U] >> (channel & 0x3fU);
+        return static_cast<uint32_t>(addr_bit & channel_bit & (adc_mask >> (adc & 0x1fU)) & 0x1U);
+    }
+
+    /**
+     * @param data_dropped data dropped bit of the frame
+     * @return whether the hits of the frame can be accepted
+     */
+    auto accepts_frame(bool data_dropped) const -> bool { return !(data_dropped and skip_data_dropped); }
+
+    /**
+     * @return whether all hits are accepted
+     */
+    auto accepts_all() const -> bool
+    {
+        return all_addrs and all_channels and adc_mask == ~uint32_t{0} and !skip_data_dropped;
+    }
+
+private:
+    static constexpr uint64_t all_bits{~uint64_t{0}};                            ///< mask accepting all values
+
+    std::array<uint64_t, 4> addr_mask{{all_bits, all_bits, all_bits, all_bits}}; ///< bits of accepted addresses
+    std::array<uint64_t, 2> channel_mask{{all_bits, all_bits}};                  ///< bits of accepted channels
+    uint32_t adc_mask{~uint32_t{0}};                                             ///< bits of accepted adc values
+    bool all_addrs{true};                                                        ///< no address was selected
+    bool all_channels{true};                                                     ///< no channel was selected
+    bool skip_data_dropped{false};                                               ///< drop hits of data dropped frames
+};
+
+namespace detail
+{
+/**
+ * Visitor storing the frame content in `payload_frame` or `columnar_frame`.
+ */
+template <typename Frame> struct frame_filler : frame_visitor
+{
+    Frame& frame; ///< frame to fill
+
+    explicit frame_filler(Frame& target) : frame{target} {}
+
+    auto on_frame_begin(uint32_t event_no, bool data_dropped) -> void
+    {
+        frame.event_no = event_no;
+        frame.data_dropped = data_dropped;
+    }
+
+    auto on_hit(const gbt_hit& hit) -> void { store(frame, hit); }
+
+    auto on_frame_end(uint64_t system_ts) -> void { frame.system_ts = system_ts; }
+
+    template <typename Allocator> static auto store(basic_payload_frame<Allocator>& target, const gbt_hit& hit) -> void
+    {
+        target.hits.push_back(hit);
+    }
+
+    static auto store(columnar_frame& target, const gbt_hit& hit) -> void { target.push_back(hit); }
+};
+
+/**
+ * Hits of a batch appended to `columnar_frame` by index, the columns are resized once per batch.
+ */
+struct columnar_appender : frame_visitor
+{
+    columnar_frame& frame; ///< frame to fill
+    std::size_t size;      ///< number of the hits stored in the frame
+
+    explicit columnar_appender(columnar_frame& target) : frame{target}, size{target.size()} {}
+};
+
+/**
+ * Detects `basic_payload_frame` of any allocator and the derived types.
+ */
+template <typename Allocator> auto payload_frame_base(const basic_payload_frame<Allocator>*) -> std::true_type;
+auto payload_frame_base(const void*) -> std::false_type;
+
+template <typename Frame>
+using is_payload_frame = decltype(payload_frame_base(std::declval<typename std::decay<Frame>::type*>()));
+
+/**
+ * Enables the visitor overloads of the decoder for other types than the frames.
+ */
+template <typename Visitor>
+using enable_if_visitor =
+    typename std::enable_if<!is_payload_frame<Visitor>::value and
+                            !std::is_base_of<columnar_frame, typename std::decay<Visitor>::type>::value>::type;
+} // namespace detail
+
+/**
+ * Decodes the paylod data.
+ *
+ * This class does most of the work. To use it, create the file reader, initialize the payload decode and read frames:
+ * ```c++
+ * geri::file_reader frdr(filename);
+ * auto decoder = geri::payload_decoder(&frdr);
+ * auto n_evts = 0l;
+ * while (true) {
+ *   try {
+ *     auto res = decoder.decode_frame();
+ *     // do something with the data:
+ *     // res.event_no, res.hits
+ *     n_evts++;
+ *   } catch (const std::out_of_range&) { break; }// end of file
+ * }
+ * ```
+ *
+ * The `try_decode_frame()` functions report the end of data and broken frames with `DECODE_STATUS` instead of
+ * exceptions, the errors within the frames are counted in both variants, see `get_counters()`:
+ * ```c++
+ * geri::payload_frame res;
+ * for (auto status = decoder.try_decode_frame(res); status != geri::DECODE_STATUS::end_of_data;
+ *      status = decoder.try_decode_frame(res)) {
+ *   if (status == geri::DECODE_STATUS::ok) { ... }
+ * }
+ * ```
+ *
+ * To process the hits without storing them in the frame, pass a visitor derived from `frame_visitor` to
+ * `decode_frame()`.
+ *
+ * With `mmap_reader` or `memory_reader` the data words are decoded in place, without copying them out of the mapped
+ * file or memory buffer:
+ * ```c++
+ * geri::mmap_reader mrdr(filename);
+ * auto decoder = geri::payload_decoder(&mrdr);
+ * ```
+ */
+template <typename T> class payload_decoder
+{
+public:
+    /**
+     * Last timestamp MSB of each uplink, indexed by the unique GBT/uplink address.
+     */
+    using ts_state = std::array<uint16_t, 256>;
+
+private:
+    T* data_reader{nullptr};                          ///< pointer to the reader
+
+    static const std::size_t min_trim_capacity{4096}; ///< reused frames below this capacity are never trimmed
+
+    uint64_t last_systime = 0;                        ///< track the system time and its change
+
+    std::size_t hits_hint{0};                         ///< expected number of hits in the frame, adapted to the data
+
+    ts_state ts_msb_state{};                          ///< last ts_msb of each uplink, zero if unknown
+
+    const uint64_t* block_cursor{nullptr};            ///< next word in the block, for bulk readers
+    const uint64_t* block_end{nullptr};               ///< end of the block, for bulk readers
+    std::array<uint64_t, 4> peeked{};                 ///< words read ahead, for per-word readers
+    std::size_t peek_head{0};                         ///< next read ahead word
+    std::size_t peek_tail{0};                         ///< end of the read ahead words
+
+    const event_index* frames_index{nullptr};         ///< index of the frames, for seeking by event number
+
+    smx::word_batch_kernel batch_kernel{nullptr};     ///< kernel decoding the data words
+    markers::find_kernel find_marker{nullptr};        ///< kernel scanning for the markers
+    smx::word_batch batch;                            ///< decoded data words
+
+    uint32_t last_event_no{0};                        ///< event number of the previous frame
+    bool has_last_event{false};                       ///< whether the previous frame is known
+
+    hit_filter filter;                                ///< selection of the passed hits
+    bool filtering{false};                            ///< whether the filter rejects any hits
+    bool frame_accepted{true};                        ///< whether the hits of the current frame can be accepted
+    bool check_crc{false};                            ///< whether the TS_MSB CRC is verified
+    std::array<uint32_t, 256> filtered_pending{};     ///< rejected hits of each uplink, not yet counted
+    std::size_t n_filtered_pending{0};                ///< rejected hits not yet counted
+
+    detail::live_counters counters;                                  ///< data quality counters
+
+    /**
+     * Fetch the next data word from the reader. Readers which provide `read_block()` are read block-wise and the
+     * words are walked in place, other readers are read with `try_read_word()` or `read_word()`.
+     *
+     * @param word 64-bit word
+     * @return false at the end of data
+     */
+    auto next_word(uint64_t& word) -> bool { return next_word(word, detail::has_read_block<T>{}); }
+
+    auto next_word(uint64_t& word, std::true_type /*bulk*/) -> bool
+    {
+        if (!fill_block()) { return false; }
+
+        word = *block_cursor++;
+        return true;
+    }
+
+    /**
+     * Read the next block from the bulk reader, if the current one is consumed.
+     *
+     * @return false at the end of data
+     */
+    auto fill_block() -> bool
+    {
+        if (block_cursor == block_end)
+        {
+            auto block = data_reader->read_block();
+            if (block.empty()) { return false; }
+
+            block_cursor = block.data();
+            block_end = block.data() + block.size();
+        }
+
+        return true;
+    }
+
+    /**
+     * Skip the data up to the next frame start marker and fetch the marker word and the frame header. Bulk readers
+     * are scanned with the vectorized `markers::find()`, per-word readers are read ahead, and the candidates not
+     * followed by valid frame header are rejected. The candidates at the end of the block, whose header cannot be
+     * checked in advance, are rejected after reading the header, and their header words are skipped too. The skipped
+     * data are counted, see `decoder_counters::skipped_bytes` and `decoder_counters::false_markers`.
+     *
+     * @param word the start marker word
+     * @param header the three words of the header following the marker
+     * @return false at the end of data
+     */
+    auto next_frame_header(uint64_t& word, std::array<uint64_t, 3>& header) -> bool
+    {
+        uint64_t skipped{0};
+        auto found = false;
+        while (!found and next_start_word(word, skipped, detail::has_read_block<T>{}))
+        {
+            if (!next_word(header[0]) or !next_word(header[1]) or !next_word(header[2])) { break; }
+
+            found = header[2] == 0x0;
+            if (!found)
+            {
+                ++counters.false_markers;
+                skipped += 1 + header.size();
+            }
+        }
+
+        if (skipped != 0)
+        {
+            ++counters.resyncs;
+            counters.skipped_bytes += skipped * sizeof(uint64_t);
+        }
+
+        return found;
+    }
+
+    auto next_start_word(uint64_t& word, uint64_t& skipped, std::true_type /*bulk*/) -> bool
+    {
+        while (fill_block())
+        {
+            const auto* found = find_marker(block_cursor, block_end, markers::start);
+            while (found != block_end and !markers::valid_header(found, block_end))
+            {
+                ++counters.false_markers;
+                found = find_marker(found + 1, block_end, markers::start);
+            }
+
+            skipped += static_cast<uint64_t>(found - block_cursor);
+            block_cursor = found;
+
+            if (found != block_end)
+            {
+                word = *block_cursor++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto next_start_word(uint64_t& word, uint64_t& skipped, std::false_type /*bulk*/) -> bool
+    {
+        while (next_word(word))
+        {
+            if (markers::is_start(word))
+            {
+                // the candidate at the end of data is accepted, its header is incomplete anyway
+                if (header_follows() or peek(3) < 3) { return true; }
+                ++counters.false_markers;
+            }
+            ++skipped;
+            // std::print("Invalid data word {:#018x}\n", word);
+        }
+
+        return false;
+    }
+
+    auto next_word(uint64_t& word, std::false_type /*bulk*/) -> bool
+    {
+        if (peek_head != peek_tail)
+        {
+            word = peeked[peek_head++];
+            return true;
+        }
+
+        return detail::try_read_word(*data_reader, word);
+    }
+
+    /**
+     * Read ahead of the per-word reader, the words are returned by `next_word()` later.
+     *
+     * @param n number of the words needed
+     * @return number of the words available, smaller than `n` only at the end of data
+     */
+    auto peek(std::size_t n) -> std::size_t
+    {
+        std::copy(peeked.begin() + static_cast<std::ptrdiff_t>(peek_head),
+                  peeked.begin() + static_cast<std::ptrdiff_t>(peek_tail), peeked.begin());
+        peek_tail -= peek_head;
+        peek_head = 0;
+
+        uint64_t word{0};
+        while (peek_tail < n and detail::try_read_word(*data_reader, word))
+        {
+            peeked[peek_tail++] = word;
+        }
+
+        return peek_tail;
+    }
+
+    /**
+     * Give back the word just fetched with `next_word()`.
+     *
+     * @param word the word
+     */
+    auto unread(uint64_t word) -> void { unread(word, detail::has_read_block<T>{}); }
+
+    auto unread(uint64_t /*word*/, std::true_type /*bulk*/) -> void { --block_cursor; }
+
+    auto unread(uint64_t word, std::false_type /*bulk*/) -> void
+    {
+        if (peek_head == 0)
+        {
+            std::copy_backward(peeked.begin(), peeked.begin() + static_cast<std::ptrdiff_t>(peek_tail),
+                               peeked.begin() + static_cast<std::ptrdiff_t>(peek_tail) + 1);
+            ++peek_tail;
+        }
+        else
+        {
+            --peek_head;
+        }
+        peeked[peek_head] = word;
+    }
+
+    /**
+     * Check whether the start marker just fetched with `next_word()` is followed by valid frame header, see
+     * `markers::valid_header()`. The header of the marker which cannot be checked, at the end of the block or data,
+     * is not valid. Per-word readers are read ahead.
+     *
+     * @return test result
+     */
+    auto header_follows() -> bool { return header_follows(detail::has_read_block<T>{}); }
+
+    auto header_follows(std::true_type /*bulk*/) -> bool
+    {
+        const auto* marker = block_cursor - 1;
+        return block_end - marker >= 4 and markers::valid_header(marker, block_end);
+    }
+
+    auto header_follows(std::false_type /*bulk*/) -> bool { return peek(3) == 3 and peeked[2] == 0x0; }
+
+    /**
+     * Count the data words which can be decoded as a batch. Only words already available in the block are counted,
+     * and the counting stops at the first stop or start marker candidate.
+     *
+     * @return number of 64-bit data words, always zero for readers without `read_block()`
+     */
+    auto batch_words() const -> std::size_t { return batch_words(detail::has_read_block<T>{}); }
+
+    auto batch_words(std::true_type /*bulk*/) const -> std::size_t
+    {
+        auto last = block_cursor + std::min<std::ptrdiff_t>(block_end - block_cursor, smx::word_batch::max_words);
+
+        last = find_marker(block_cursor, last, markers::stop);
+        return static_cast<std::size_t>(find_marker(block_cursor, last, markers::start) - block_cursor);
+    }
+
+    auto batch_words(std::false_type /*bulk*/) const -> std::size_t { return 0; }
+
+    /**
+     * @return hits container of the frame
+     */
+    template <typename Allocator>
+    static auto frame_hits(basic_payload_frame<Allocator>& payload_data) -> std::vector<gbt_hit, Allocator>&
+    {
+        return payload_data.hits;
+    }
+
+    static auto frame_hits(columnar_frame& payload_data) -> columnar_frame& { return payload_data; }
+
+    /**
+     * Process the decoded data words: update the uplinks timestamps and pass the words to the visitor.
+     *
+     * With the hit filter, the filter is evaluated for all words without branching and the words are compacted into
+     * the lists of kept words and rejected hits, so the random accept decisions do not cause branch mispredictions.
+     * Only the kept words are decoded, the rejected hits are counted at the end of the frame, see `flush_filtered()`.
+     *
+     * @param visitor the frame visitor
+     */
+    template <typename Visitor> auto process_batch(Visitor& visitor) -> void
+    {
+        if (!filtering)
+        {
+            for (std::size_t idx = 0; idx < batch.size; ++idx)
+            {
+                process_word(visitor, idx);
+            }
+            return;
+        }
+
+        // local lists and filter copy, so the stores to the lists do not alias the batch and the filter
+        uint8_t kept[smx::word_batch::max_size];
+        uint8_t rejected[smx::word_batch::max_size];
+        const auto selection = filter;
+        const uint32_t accept_hits = frame_accepted ? 1U : 0U;
+        std::size_t n_kept{0};
+        std::size_t n_rejected{0};
+        for (std::size_t idx = 0; idx < batch.size; ++idx)
+        {
+            const uint32_t is_hit = batch.type[idx] == static_cast<uint32_t>(smx::UPLINK_FRAME_TYPE::hit) ? 1U : 0U;
+            const auto accepted = selection.accept_bit(static_cast<uint8_t>(batch.addr[idx]),
+                                                       static_cast<uint8_t>(batch.channel[idx]),
+                                                       static_cast<uint8_t>(batch.adc[idx]));
+            const auto keep = (is_hit ^ 1U) | (accept_hits & accepted);
+            kept[n_kept] = static_cast<uint8_t>(idx);
+            rejected[n_rejected] = static_cast<uint8_t>(batch.addr[idx]);
+            n_kept += keep;
+            n_rejected += keep ^ 1U;
+        }
+
+        for (std::size_t idx = 0; idx < n_rejected; ++idx)
+        {
+            ++filtered_pending[rejected[idx]];
+        }
+        n_filtered_pending += n_rejected;
+
+        for (std::size_t idx = 0; idx < n_kept; ++idx)
+        {
+            process_word(visitor, kept[idx]);
+        }
+    }
+
+    /**
+     * Process the decoded data words into the columnar frame, the hits are written directly from the batch columns.
+     *
+     * @param filler the frame filler
+     */
+    auto process_batch(detail::frame_filler<columnar_frame>& filler) -> void
+    {
+        detail::columnar_appender appender{filler.frame};
+        filler.frame.resize(appender.size + batch.size);
+        process_batch<detail::columnar_appender>(appender);
+        filler.frame.resize(appender.size);
+    }
+
+    /**
+     * Add the hits rejected by the filter to the counters.
+     */
+    auto flush_filtered() -> void
+    {
+        if (n_filtered_pending == 0) { return; }
+
+        for (std::size_t addr = 0; addr < filtered_pending.size(); ++addr)
+        {
+            if (filtered_pending[addr] == 0) { continue; }
+
+            auto& uplink = counters.uplinks[addr];
+            uplink.words[static_cast<std::size_t>(smx::UPLINK_FRAME_TYPE::hit)] += filtered_pending[addr];
+            uplink.filtered += filtered_pending[addr];
+            filtered_pending[addr] = 0;
+        }
+        n_filtered_pending = 0;
+    }
+
+    /**
+     * Process the decoded data word, see `process_batch()`.
+     *
+     * @param visitor the frame visitor
+     * @param idx index of the word in the batch
+     */
+    template <typename Visitor> auto process_word(Visitor& visitor, std::size_t idx) -> void
+    {
+        auto addr = static_cast<uint8_t>(batch.addr[idx]);
+        auto& uplink = counters.uplinks[addr];
+        ++uplink.words[batch.type[idx]];
+
+        switch (static_cast<smx::UPLINK_FRAME_TYPE>(batch.type[idx]))
+        {
+            case smx::UPLINK_FRAME_TYPE::hit:
+            {
+                auto last_ts = ts_msb_state[addr];
+                auto hit_ts = static_cast<uint16_t>(batch.ts[idx]);
+
+                if (!smx::ts_matches(last_ts, hit_ts))
+                {
+                    // std::print("ERROR: {:s}\n", geri::exceptions::ts_match_error(last_ts, hit_ts).what());
+                    ++uplink.ts_mismatch;
+                    break;
+                }
+
+                store_hit(visitor, idx, hit_ts, static_cast<uint16_t>(last_ts | hit_ts));
+            }
+            break;
+
+            case smx::UPLINK_FRAME_TYPE::ts_msb:
+            {
+                // corrupted ts_msb would shift the full timestamps of all following hits of the uplink
+                if (check_crc and smx::ts_msb_crc_syndrome(batch.raw[idx]) != 0)
+                {
+                    ++uplink.crc_errors;
+                    break;
+                }
+                if (smx::try_decode_smx_ts_msb(batch.raw[idx], ts_msb_state[addr]) != DECODE_STATUS::ok)
+                {
+                    ++uplink.invalid_ts_msb;
+                    break;
+                }
+                // std::print("ts_msb word, current timestamp: {:x}\n", ts_msb_state[addr]);
+
+                visitor.on_ts_msb(addr, ts_msb_state[addr]);
+            }
+            break;
+
+            default:
+                visitor.on_other_word(addr, static_cast<smx::UPLINK_FRAME_TYPE>(batch.type[idx]), batch.raw[idx]);
+                break;
+        }
+    }
+
+    /**
+     * Pass the hit matching the uplink timestamp to the visitor.
+     *
+     * @param visitor the frame visitor
+     * @param idx index of the word in the batch
+     * @param hit_ts 10-bit timestamp of the hit
+     * @param full_ts full timestamp of the hit
+     */
+    template <typename Visitor>
+    auto store_hit(Visitor& visitor, std::size_t idx, uint16_t hit_ts, uint16_t full_ts) const -> void
+    {
+        gbt_hit decoded_hit(gbt::get_gbt_uplink_addr(batch.raw[idx]));
+        decoded_hit.channel = static_cast<uint8_t>(batch.channel[idx]);
+        decoded_hit.adc = static_cast<uint8_t>(batch.adc[idx]);
+        decoded_hit.ts = hit_ts;
+        decoded_hit.full_ts = full_ts;
+        decoded_hit.event_missing = batch.event_missing[idx] != 0;
+
+        visitor.on_hit(decoded_hit);
+    }
+
+    auto store_hit(detail::columnar_appender& appender, std::size_t idx, uint16_t /*hit_ts*/, uint16_t full_ts) const
+        -> void
+    {
+        appender.frame.set(appender.size++, static_cast<uint8_t>(batch.addr[idx]),
+                           static_cast<uint8_t>(batch.channel[idx]), static_cast<uint8_t>(batch.adc[idx]), full_ts,
+                           static_cast<uint8_t>(batch.event_missing[idx] != 0 ? columnar_frame::event_missing : 0));
+    }
+
+    /**
+     * Helper function to check if data matches expected value. The mismatch is reported by the caller, see
+     * `frame_error()`.
+     *
+     * @param word to be tested
+     * @param expected value
+     * @return test result
+     */
+    static auto expect_word(uint64_t word, uint64_t expected) -> bool { return word == expected; }
+
+    /**
+     * Count the broken frame.
+     *
+     * @return `invalid_frame` status
+     */
+    auto frame_error() -> DECODE_STATUS
+    {
+        ++counters.invalid_frames;
+        return DECODE_STATUS::invalid_frame;
+    }
+
+    /**
+     * Translate the status of the non-throwing API into exception.
+     *
+     * @param status decoding status
+     */
+    static auto check_status(DECODE_STATUS status) -> void
+    {
+        switch (status)
+        {
+            case DECODE_STATUS::ok:
+                return;
+            case DECODE_STATUS::end_of_data:
+                throw std::out_of_range("END OF DATA");
+            case DECODE_STATUS::invalid_offset:
+                throw std::out_of_range("INVALID OFFSET");
+            default:
+                throw geri::exceptions::invalid_gbt_frame();
+        }
+    }
+
+    /**
+     * Follow the number of hits per frame: raise immediately, decay slowly.
+     *
+     * @param n_hits number of hits in the last frame
+     */
+    auto update_hits_hint(std::size_t n_hits) -> void { hits_hint = std::max(n_hits, hits_hint - hits_hint / 16); }
+
+    /**
+     * @return capacity above which reused frame is trimmed
+     */
+    auto hits_capacity_limit() const -> std::size_t { return std::max(4 * hits_hint, std::size_t{min_trim_capacity}); }
+
+    /**
+     * Trim the reused frame if its capacity exceeds the limit.
+     */
+    template <typename Hits> auto trim_hits(Hits& hits) const -> void
+    {
+        if (hits.capacity() > hits_capacity_limit())
+        {
+            hits.shrink_to_fit();
+            hits.reserve(hits_hint);
+        }
+    }
+
+    /**
+     * The arena memory is never freed, trimming would only waste it.
+     */
+    auto trim_hits(std::vector<gbt_hit, arena_allocator<gbt_hit>>& /*hits*/) const -> void {}
+
+public:
+    /**
      * @param reader the reader object
      */
-    explicit payload_decoder(T* reader) : data_reader(reader) {}
+    explicit payload_decoder(T* reader) : data_reader(reader) { set_simd_level(smx::detect_simd_level()); }
+
+    /**
+     * Select the instruction set of the batch and markers scanning kernels, by default the best one supported by the
+     * CPU is used.
+     *
+     * @param level the SIMD level
+     */
+    auto set_simd_level(smx::SIMD_LEVEL level) -> void
+    {
+        batch_kernel = smx::get_word_batch_kernel(level);
+        find_marker = markers::get_find_kernel(level);
+    }
+
+    /**
+     * Select the hits stored in the frames and passed to the visitors, by default all hits are passed. The rejected
+     * hits are counted in `uplink_counters::filtered`, they are rejected before the timestamp check.
+     *
+     * @param selection the hits filter
+     */
+    auto set_filter(const hit_filter& selection) -> void
+    {
+        filter = selection;
+        filtering = !filter.accepts_all();
+    }
+
+    /**
+     * @return the hits filter
+     */
+    auto get_filter() const -> const hit_filter& { return filter; }
+
+    /**
+     * Verify the CRC of the TS_MSB words, see `smx::ts_msb_crc_syndrome()`. The words with wrong CRC do not change the
+     * uplink timestamp and are counted in `uplink_counters::crc_errors`. Disabled by default.
+     *
+     * @param enable whether the CRC is checked
+     */
+    auto set_ts_msb_crc_check(bool enable) -> void { check_crc = enable; }
+
+    /**
+     * Forget the last timestamp MSBs of all uplinks.
+     *
+     * The timestamp MSB state persists across frames, reset it when the stream is not continuous anymore, e.g. after
+     * seeking to another position of the data.
+     */
+    auto reset_ts_state() -> void { ts_msb_state.fill(0x0); }
+
+    /**
+     * @return the last timestamp MSBs of all uplinks
+     */
+    auto get_ts_state() const -> const ts_state& { return ts_msb_state; }
+
+    /**
+     * Set the last timestamp MSBs of all uplinks, e.g. to continue decoding from known state.
+     *
+     * @param state timestamp MSBs state
+     */
+    auto set_ts_state(const ts_state& state) -> void { ts_msb_state = state; }
+
+    /**
+     * Snapshot of the data quality counters: words of each type, dropped hits and broken words per uplink, and the
+     * frame errors. Broken hits and words are counted and skipped, the frame is decoded further, only the broken or
+     * lost frame trailer stops decoding of the frame. Start markers with broken header are skipped as false markers.
+     *
+     * Can be called from any thread, also while decoding, e.g. for monitoring.
+     *
+     * @return the counters
+     */
+    auto get_counters() const -> decoder_counters { return counters.snapshot(); }
+
+    /**
+     * Zero the counters. Must be called from the decoding thread.
+     */
+    auto reset_counters() -> void
+    {
+        counters.reset();
+        filtered_pending.fill(0);
+        n_filtered_pending = 0;
+    }
+
+    /**
+     * Set the index of the frames used by `seek_event()`. The index must outlive the decoder or be reset.
+     *
+     * @param index the index or nullptr
+     */
+    auto set_index(const event_index* index) -> void { frames_index = index; }
+
+    /**
+     * Move the reader to the position of the frame. The reader must provide `seek()`.
+     *
+     * The stream is not continuous after seeking, thus the uplinks timestamps state is reset and the system time is
+     * not checked against the previous frame.
+     *
+     * @param offset frame position in bytes from the beginning of the stream
+     * @return false if the position cannot be set
+     */
+    auto seek(uint64_t offset) -> bool
+    {
+        block_cursor = block_end = nullptr;
+        peek_head = peek_tail = 0;
+        last_systime = 0;
+        has_last_event = false;
+        reset_ts_state();
+
+        return data_reader->seek(offset);
+    }
+
+    /**
+     * Move the reader to the frame with the event number, see `seek()`. Requires the index, see `set_index()`.
+     *
+     * @param event_no event number
+     * @return false if the event is not indexed or the position cannot be set
+     */
+    auto seek_event(uint32_t event_no) -> bool
+    {
+        const auto* ent = frames_index ? frames_index->find(event_no) : nullptr;
+        return ent != nullptr and seek(ent->offset);
+    }
+
+    /**
+     * Decode the frame at the position, see `seek()` and `decode_frame()`.
+     *
+     * @param offset frame position in bytes from the beginning of the stream
+     * @return paylod data in payload_frame object
+     */
+    auto decode_frame_at(uint64_t offset) -> payload_frame
+    {
+        if (!seek(offset)) { throw std::out_of_range("INVALID OFFSET"); }
+        return decode_frame();
+    }
+
+    /**
+     * Decode the frame at the position into existing frame, see `seek()` and `decode_frame(payload_frame&)`.
+     *
+     * @param offset frame position in bytes from the beginning of the stream
+     * @param payload_data frame to store the decoded data
+     */
+    template <typename Frame> auto decode_frame_at(uint64_t offset, Frame& payload_data) -> void
+    {
+        check_status(try_decode_frame_at(offset, payload_data));
+    }
+
+    /**
+     * Decode the frame at the position into existing frame, without throwing, see `try_decode_frame()`.
+     *
+     * @param offset frame position in bytes from the beginning of the stream
+     * @param payload_data frame to store the decoded data
+     * @return decoding status, `invalid_offset` if the position cannot be set
+     */
+    template <typename Frame> auto try_decode_frame_at(uint64_t offset, Frame& payload_data) -> DECODE_STATUS
+    {
+        if (!seek(offset)) { return DECODE_STATUS::invalid_offset; }
+        return try_decode_frame(payload_data);
+    }
 
     /**
      * Decode the dataframe.
@@ -482,53 +3400,155 @@ public:
     auto decode_frame() -> payload_frame
     {
         payload_frame payload_data;
+        payload_data.hits.reserve(hits_hint);
 
-        payload_data.event_no = [&]() -> uint32_t
-        {
-            while (true)
-            {
-                auto word = data_reader->read_word();
+        decode_frame(payload_data);
 
-                if ((word & start_marker) == start_marker) { return static_cast<uint32_t>(word >> 32); }
-                // else
-                // {
-                // std::print("Invalid data word {:#018x}\n", word);
-                // }
-            }
-        }();
+        return payload_data;
+    }
 
-        // std::print("Detected event {:d}\n", payload_data.event_no);
+    /**
+     * Decode the dataframe into existing frame, see `decode_frame()` for details.
+     *
+     * The frame is cleared first, but its hits capacity is kept, so the frame can be reused for the following events
+     * without new allocations. If the capacity greatly exceeds number of hits in recent frames, it is trimmed. The hits
+     * are allocated with the frame allocator, see `basic_payload_frame`.
+     *
+     * @param payload_data frame to store the decoded data
+     * @throws std::out_of_range at the end of data
+     * @throws geri::exceptions::invalid_gbt_frame if the frame trailer is broken or lost
+     */
+    template <typename Allocator> auto decode_frame(basic_payload_frame<Allocator>& payload_data) -> void
+    {
+        check_status(try_decode_frame(payload_data));
+    }
 
-        {
-            auto word = data_reader->read_word();
+    /**
+     * Decode the dataframe into column-wise frame, see `decode_frame()` for details.
+     *
+     * The hits are stored directly in the columns. The frame capacity is reused as in `decode_frame(payload_frame&)`.
+     *
+     * @param payload_data frame to store the decoded data
+     */
+    auto decode_frame(columnar_frame& payload_data) -> void { check_status(try_decode_frame(payload_data)); }
+
+    /**
+     * Decode the dataframe into existing frame without throwing, see `decode_frame(payload_frame&)`.
+     *
+     * The errors within the frame are counted, see `get_counters()`.
+     *
+     * @param payload_data frame to store the decoded data
+     * @return `ok`, `end_of_data` or `invalid_frame`
+     */
+    template <typename Allocator> auto try_decode_frame(basic_payload_frame<Allocator>& payload_data) -> DECODE_STATUS
+    {
+        return decode_frame_into(payload_data);
+    }
+
+    /**
+     * Decode the dataframe into column-wise frame without throwing, see `try_decode_frame(payload_frame&)`.
+     *
+     * @param payload_data frame to store the decoded data
+     * @return `ok`, `end_of_data` or `invalid_frame`
+     */
+    auto try_decode_frame(columnar_frame& payload_data) -> DECODE_STATUS { return decode_frame_into(payload_data); }
+
+    /**
+     * Decode the dataframe and pass its content directly to the visitor, without storing the hits.
+     *
+     * The visitor is called as the frame is decoded, see `frame_visitor` for the callbacks. The visitor type is a
+     * template parameter, so the calls can be inlined into the decoding loop.
+     *
+     * @param visitor the frame visitor
+     * @throws std::out_of_range at the end of data
+     * @throws geri::exceptions::invalid_gbt_frame if the frame trailer is broken or lost
+     */
+    template <typename Visitor, typename = detail::enable_if_visitor<Visitor>>
+    auto decode_frame(Visitor&& visitor) -> void
+    {
+        check_status(try_decode_frame(visitor));
+    }
+
+    /**
+     * Decode the dataframe and pass its content to the visitor, without throwing, see `decode_frame(Visitor&&)`.
+     *
+     * The visitor's `on_frame_end()` is called only if the frame is decoded successfully.
+     *
+     * @param visitor the frame visitor
+     * @return `ok`, `end_of_data` or `invalid_frame`
+     */
+    template <typename Visitor, typename = detail::enable_if_visitor<Visitor>>
+    auto try_decode_frame(Visitor&& visitor) -> DECODE_STATUS
+    {
+        return decode_frame_visit(visitor);
+    }
+
+private:
+    template <typename Frame> auto decode_frame_into(Frame& payload_data) -> DECODE_STATUS
+    {
+        payload_data.clear();
+
+        auto& hits = frame_hits(payload_data);
+        trim_hits(hits);
+
+        detail::frame_filler<Frame> filler{payload_data};
+        auto status = decode_frame_visit(filler);
+        if (status == DECODE_STATUS::ok) { update_hits_hint(hits.size()); }
+
+        return status;
+    }
+
+    template <typename Visitor> auto decode_frame_visit(Visitor& visitor) -> DECODE_STATUS
+    {
+        uint64_t word{0};
+        std::array<uint64_t, 3> header{};
+        if (!next_frame_header(word, header)) { return DECODE_STATUS::end_of_data; }
+
+        auto event_no = static_cast<uint32_t>(word >> 32);
+
+        if (has_last_event and event_no != last_event_no + 1) { ++counters.event_gaps; }
+        last_event_no = event_no;
+        has_last_event = true;
 
-            if (last_systime and word != last_systime)
+        // std::print("Detected event {:d}\n", event_no);
+
+        {
+            if (last_systime and header[0] != last_systime)
             {
-                // std::print("Invalid System Time {:#018x},  expected: {:#018x}", word, last_systime);
+                ++counters.systime_mismatches;
+                // std::print("Invalid System Time {:#018x},  expected: {:#018x}", header[0], last_systime);
             }
 
-            word = data_reader->read_word();
-
-            payload_data.data_dropped = word & 0x1;
-            // if (payload_data.data_dropped)
+            bool data_dropped = header[1] & 0x1;
+            if (data_dropped) { ++counters.data_dropped; }
+            frame_accepted = filter.accepts_frame(data_dropped);
+            // if (data_dropped)
             // {
             //     std::print("  Data dropped persist bit detected\n");
             // }
 
-            if (!expect_word(data_reader->read_word(), 0x0)) { throw geri::exceptions::invalid_gbt_frame(); }
+            // std::print("Event {:d}   System Time {:#018x}\n", event_no, header[0]);
 
-            // std::print("Event {:d}   System Time {:#018x}\n", payload_data.event_no, word);
+            visitor.on_frame_begin(event_no, data_dropped);
         }
 
-        std::map<uint32_t, uint16_t> gbt_event_ts;
-
         while (true)
         {
-            auto word = data_reader->read_word();
-            if ((word & stop_marker) == stop_marker)
+            auto n_words = batch_words();
+            if (n_words != 0)
             {
-                if (word >> 32 != payload_data.event_no)
+                batch_kernel(block_cursor, n_words, batch);
+                block_cursor += n_words;
+                process_batch(visitor);
+                continue;
+            }
+
+            if (!next_word(word)) { return DECODE_STATUS::end_of_data; }
+            if (markers::is_stop(word))
+            {
+                if (word >> 32 != event_no)
                 {
+                    ++counters.event_mismatches;
                     // std::print("Decoded wrong event number at frame end: {:#018x}\n", word);
                 }
                 else
@@ -536,80 +3556,39 @@ public:
                     break;
                 }
             }
+            else if (markers::is_start(word) and header_follows())
+            {
+                // trailer of the frame is lost, the next call decodes the frame beginning here
+                unread(word);
+                return frame_error();
+            }
             else
             {
                 // std::print("Full word: {:#018x}\n", word);
 
-                uint32_t words[2] = {static_cast<uint32_t>(word & 0xffffffff), static_cast<uint32_t>(word >> 32)};
-
-                for (const auto data_word : words)
-                {
-                    gbt_hit payload{gbt::get_gbt_uplink_addr(data_word)};
-
-                    // std::print("Current word: {:08x} -- GBT: {:d}  Uplink: {:2d} -- ", data_word, payload.gbt,
-                    //            payload.uplink);
-
-                    auto word_type = smx::get_uplink_frame_type(data_word);
-
-                    switch (word_type)
-                    {
-                        case smx::UPLINK_FRAME_TYPE::hit:
-                        {
-                            try
-                            {
-                                auto last_ts = gbt_event_ts[payload.unique_addr];
-                                payload = smx::decode_smx_hit(data_word, last_ts);
-
-                                // std::print("SMX data: {}\n", payload);
-
-                                payload_data.hits.push_back(std::move(payload));
-                                // if (!last_ts)
-                                // std::print("hit word - event ts unknown\n");
-                                // else
-                                // std::print("hit word\n");
-                            }
-                            catch (const geri::exceptions::ts_match_error& e)
-                            {
-                                // std::print("ERROR: {:s}\n", e.what());
-                            }
-                        }
-                        break;
-
-                        case smx::UPLINK_FRAME_TYPE::ts_msb:
-                        {
-                            gbt_event_ts[payload.unique_addr] = smx::decode_smx_ts_msb(data_word);
-                            // std::print("ts_msb word, current timestamp: {:x}\n", gbt_event_ts[payload.unique_addr]);
-                        }
-                        break;
-
-                        default:
-                        {
-#ifdef __cpp_lib_print
-                            std::print(stderr, "other word -- unsupporter yet\n");
-#else
-                            std::fprintf(stderr, "other word -- unsupporter yet\n");
-#endif
-                        }
-                        break;
-                    }
-                }
+                smx::decode_word_batch_scalar(&word, 1, batch);
+                process_batch(visitor);
             }
         }
 
         // std::print("Readout {:d} channels data\n", channels_cnt);
 
         {
-            last_systime = data_reader->read_word();
+            if (!next_word(last_systime)) { return DECODE_STATUS::end_of_data; }
 
             // std::print("New System Time: {:#018x}\n", last_systime);
 
-            if (!expect_word(data_reader->read_word(), 0x0)) { throw geri::exceptions::invalid_gbt_frame(); }
-            if (!expect_word(data_reader->read_word(), 0x0)) { throw geri::exceptions::invalid_gbt_frame(); }
+            if (!next_word(word)) { return DECODE_STATUS::end_of_data; }
+            if (!expect_word(word, 0x0)) { return frame_error(); }
+            if (!next_word(word)) { return DECODE_STATUS::end_of_data; }
+            if (!expect_word(word, 0x0)) { return frame_error(); }
         }
 
-        payload_data.system_ts = last_systime;
+        flush_filtered();
+        ++counters.frames;
+        visitor.on_frame_end(last_systime);
 
-        return payload_data;
+        return DECODE_STATUS::ok;
     }
 };
 
@@ -0,0 +1,275 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file histogram.hpp
+ * @brief Online ADC spectra and hit maps of the channels
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace geri
+{
+
+/**
+ * Dimensions of the channel histograms.
+ */
+struct histogram_dims
+{
+    static constexpr std::size_t n_addrs{256};                          ///< GBT/uplink unique addresses
+    static constexpr std::size_t n_channels{128};                       ///< channels of the uplink, 7-bit
+    static constexpr std::size_t n_adcs{32};                            ///< adc values, 5-bit
+    static constexpr std::size_t n_bins{n_addrs * n_channels * n_adcs}; ///< bins of all the spectra
+
+    /// @return index of the bin
+    static constexpr auto bin(uint8_t addr, uint8_t channel, uint8_t adc) -> std::size_t
+    {
+        return (std::size_t{addr} * n_channels + (channel & (n_channels - 1))) * n_adcs + (adc & (n_adcs - 1));
+    }
+};
+
+/**
+ * Summed content of the histograms, see `hit_histograms::snapshot()`.
+ */
+class histogram_snapshot
+{
+public:
+    histogram_snapshot() : bins(histogram_dims::n_bins), hit_map(histogram_dims::n_addrs * histogram_dims::n_channels)
+    {
+    }
+
+    /// @return number of counted frames
+    auto frames() const -> uint64_t { return n_frames; }
+
+    /// @return number of hits of the channel with the adc value
+    auto adc(uint8_t addr, uint8_t channel, uint8_t adc) const -> uint64_t
+    {
+        return bins[histogram_dims::bin(addr, channel, adc)];
+    }
+
+    /// @return ADC spectrum of the channel, `n_adcs` bins
+    auto spectrum(uint8_t addr, uint8_t channel) const -> span<const uint64_t>
+    {
+        return {bins.data() + histogram_dims::bin(addr, channel, 0), histogram_dims::n_adcs};
+    }
+
+    /// @return number of hits of the channel
+    auto hits(uint8_t addr, uint8_t channel) const -> uint64_t
+    {
+        return hit_map[std::size_t{addr} * histogram_dims::n_channels + (channel & (histogram_dims::n_channels - 1))];
+    }
+
+    /// @return hit map of the uplink, `n_channels` entries
+    auto hits(uint8_t addr) const -> span<const uint64_t>
+    {
+        return {hit_map.data() + std::size_t{addr} * histogram_dims::n_channels, histogram_dims::n_channels};
+    }
+
+    /// @return number of hits of the channel per frame
+    auto rate(uint8_t addr, uint8_t channel) const -> double
+    {
+        return n_frames == 0 ? 0.0 : static_cast<double>(hits(addr, channel)) / static_cast<double>(n_frames);
+    }
+
+    /// @return total number of hits
+    auto total_hits() const -> uint64_t
+    {
+        uint64_t res{0};
+        for (auto count : hit_map)
+        {
+            res += count;
+        }
+        return res;
+    }
+
+private:
+    friend class hit_histograms;
+
+    uint64_t n_frames{0};          ///< number of counted frames
+    std::vector<uint64_t> bins;    ///< spectra of all channels, see `histogram_dims::bin()`
+    std::vector<uint64_t> hit_map; ///< hits of all channels
+};
+
+/**
+ * Histograms filled by single thread, see `hit_histograms::make_accumulator()`.
+ *
+ * The bins are dense array of counters indexed by the address, channel and adc, each channel spectrum is 256 bytes,
+ * aligned to the cache line. The array of the accumulator, followed by its frames counter, is mapped separately, so
+ * the threads never share the cache lines. The counters are written only by the owning thread, with relaxed loads
+ * and stores, and can be read by other threads at any time without locking.
+ *
+ * The accumulator can be used as the frame visitor of `payload_decoder`, filling the histograms during decoding
+ * without building the frame, or as the frames consumer of `pipeline` and `parallel_decoder`.
+ */
+class histogram_accumulator : public frame_visitor
+{
+public:
+    histogram_accumulator()
+    {
+        memory = mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) { abort(); }
+
+        bins = static_cast<detail::relaxed_counter*>(memory);
+        for (std::size_t idx = 0; idx < histogram_dims::n_bins; ++idx)
+        {
+            new (bins + idx) detail::relaxed_counter;
+        }
+        frames = new (bins + histogram_dims::n_bins) detail::relaxed_counter;
+    }
+
+    histogram_accumulator(const histogram_accumulator&) = delete;
+    auto operator=(const histogram_accumulator&) -> histogram_accumulator& = delete;
+
+    ~histogram_accumulator() { munmap(memory, bytes()); }
+
+    /**
+     * Count the hit.
+     *
+     * @param addr GBT/uplink unique address
+     * @param channel hit channel
+     * @param adc hit adc
+     */
+    auto fill(uint8_t addr, uint8_t channel, uint8_t adc) -> void { ++bins[histogram_dims::bin(addr, channel, adc)]; }
+
+    /**
+     * Count the frame and its hits.
+     *
+     * @param frame the frame
+     */
+    template <typename Allocator> auto fill(const basic_payload_frame<Allocator>& frame) -> void
+    {
+        for (const auto& hit : frame.hits)
+        {
+            fill(hit.unique_addr, hit.channel, hit.adc);
+        }
+        ++*frames;
+    }
+
+    /**
+     * Count the frame and its hits.
+     *
+     * @param frame the frame
+     */
+    auto fill(const columnar_frame& frame) -> void
+    {
+        const auto addr = frame.addr();
+        const auto channel = frame.channel();
+        const auto adc = frame.adc();
+        for (std::size_t idx = 0; idx < frame.size(); ++idx)
+        {
+            fill(addr[idx], channel[idx], adc[idx]);
+        }
+        ++*frames;
+    }
+
+    /// Frames consumer of `pipeline` and `parallel_decoder`.
+    template <typename Allocator> auto operator()(const basic_payload_frame<Allocator>& frame) -> void { fill(frame); }
+
+    /// Frame visitor callback.
+    auto on_hit(const gbt_hit& hit) -> void { fill(hit.unique_addr, hit.channel, hit.adc); }
+
+    /// Frame visitor callback.
+    auto on_frame_end(uint64_t /*system_ts*/) -> void { ++*frames; }
+
+private:
+    friend class hit_histograms;
+
+    static constexpr auto bytes() -> std::size_t
+    { return (histogram_dims::n_bins + 1) * sizeof(detail::relaxed_counter); }
+
+    void* memory{nullptr};                    ///< mapped bins
+    detail::relaxed_counter* bins{nullptr};   ///< spectra of all channels, see `histogram_dims::bin()`
+    detail::relaxed_counter* frames{nullptr}; ///< number of counted frames, mapped after the bins
+};
+
+/**
+ * Set of the per-thread histogram accumulators.
+ *
+ * Each decoding thread fills its own accumulator, `snapshot()` sums them and can be called by a monitoring thread
+ * while the decoding runs. The decoding threads never lock, the counts of the frames being filled can be partially
+ * included in the snapshot.
+ * ```c++
+ * geri::hit_histograms histograms;
+ * auto& acc = histograms.make_accumulator(); // in the decoding thread
+ * while (decoder.try_decode_frame(acc) != geri::DECODE_STATUS::end_of_data) {}
+ *
+ * auto snap = histograms.snapshot(); // in the monitoring thread
+ * snap.spectrum(addr, channel); snap.hits(addr);
+ * ```
+ */
+class hit_histograms
+{
+public:
+    hit_histograms() = default;
+    hit_histograms(const hit_histograms&) = delete;
+    auto operator=(const hit_histograms&) -> hit_histograms& = delete;
+
+    /**
+     * Create new accumulator, valid for the lifetime of the set. Each thread filling the histograms needs its own.
+     *
+     * @return the accumulator
+     */
+    auto make_accumulator() -> histogram_accumulator&
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        accumulators.emplace_back();
+        return accumulators.back();
+    }
+
+    /// @return number of accumulators
+    auto size() const -> std::size_t
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return accumulators.size();
+    }
+
+    /**
+     * Sum the accumulators. Can be called from any thread, also while the accumulators are filled.
+     *
+     * @return the histograms content
+     */
+    auto snapshot() const -> histogram_snapshot
+    {
+        histogram_snapshot res;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& acc : accumulators)
+            {
+                res.n_frames += acc.frames->load();
+                for (std::size_t idx = 0; idx < histogram_dims::n_bins; ++idx)
+                {
+                    res.bins[idx] += acc.bins[idx].load();
+                }
+            }
+        }
+
+        for (std::size_t idx = 0; idx < res.hit_map.size(); ++idx)
+        {
+            for (std::size_t adc = 0; adc < histogram_dims::n_adcs; ++adc)
+            {
+                res.hit_map[idx] += res.bins[idx * histogram_dims::n_adcs + adc];
+            }
+        }
+
+        return res;
+    }
+
+private:
+    mutable std::mutex mutex;                       ///< guards the accumulators list, not the counters
+    std::deque<histogram_accumulator> accumulators; ///< per-thread accumulators, stable addresses
+};
+
+} // namespace geri
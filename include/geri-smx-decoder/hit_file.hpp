@@ -0,0 +1,597 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file hit_file.hpp
+ * @brief Chunked columnar file of the decoded frames
+ *
+ * The file starts with the 16-byte header: magic `GERIHITS` and 32-bit format version, followed by the chunks. Each
+ * chunk starts with `detail::hit_chunk_header`, holding the chunk statistics and offsets of the columns, followed by
+ * the columns padded to 8 bytes. The frame columns are event number, system timestamp, data dropped flag and number of
+ * hits, the hit columns are the same as in `columnar_frame`. The numbers are stored in the host (little-endian) order.
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace geri
+{
+
+/**
+ * Statistics of the chunk, allow to skip the chunks without reading the columns.
+ */
+struct hit_chunk_stats
+{
+    uint64_t n_hits{0};                  ///< number of hits
+    uint64_t min_system_ts{0};           ///< minimal system timestamp
+    uint64_t max_system_ts{0};           ///< maximal system timestamp
+    std::array<uint64_t, 4> addr_mask{}; ///< bitmap of the GBT/uplink unique addresses of the hits
+    uint32_t n_frames{0};                ///< number of frames
+    uint32_t first_event_no{0};          ///< event number of the first frame
+    uint32_t last_event_no{0};           ///< event number of the last frame
+    uint32_t dropped_frames{0};          ///< number of frames with data dropped flag
+    uint16_t min_full_ts{0};             ///< minimal hit full timestamp
+    uint16_t max_full_ts{0};             ///< maximal hit full timestamp
+    uint8_t min_adc{0};                  ///< minimal hit adc value
+    uint8_t max_adc{0};                  ///< maximal hit adc value
+    uint8_t min_channel{0};              ///< minimal hit channel
+    uint8_t max_channel{0};              ///< maximal hit channel
+
+    /**
+     * @param unique_addr GBT/uplink unique address
+     * @return whether the chunk contains hits of the address
+     */
+    auto has_addr(uint8_t unique_addr) const -> bool
+    { return ((addr_mask[unique_addr >> 6] >> (unique_addr & 0x3f)) & 1) != 0; }
+};
+
+/**
+ * Columns of the chunk, the views into the mapped file. The columns which are not read are empty.
+ */
+struct hit_chunk
+{
+    const hit_chunk_stats* stats{nullptr}; ///< chunk statistics
+    span<const uint32_t> event_no;         ///< event numbers of the frames
+    span<const uint64_t> system_ts;        ///< system timestamps of the frames
+    span<const uint8_t> data_dropped;      ///< data dropped flags of the frames
+    span<const uint32_t> hit_count;        ///< numbers of hits of the frames, always read
+    span<const uint8_t> addr;              ///< GBT/uplink unique addresses of the hits
+    span<const uint8_t> channel;           ///< channel numbers of the hits
+    span<const uint8_t> adc;               ///< adc values of the hits
+    span<const uint16_t> full_ts;          ///< full timestamps of the hits
+    span<const uint8_t> flags;             ///< flags of the hits, see `columnar_frame::FLAGS`
+};
+
+namespace detail
+{
+constexpr char hit_file_magic[8] = {'G', 'E', 'R', 'I', 'H', 'I', 'T', 'S'}; ///< file magic
+constexpr uint32_t hit_file_version{1};                                      ///< format version
+constexpr uint32_t hit_chunk_magic{0x4B4E4843};                              ///< chunk magic, `CHNK`
+constexpr std::size_t hit_file_columns{9};                                   ///< number of columns
+
+/**
+ * Header of the file.
+ */
+struct hit_file_header
+{
+    char magic[8];    ///< `GERIHITS`
+    uint32_t version; ///< format version
+    uint32_t flags;   ///< reserved
+};
+
+/**
+ * Header of the chunk.
+ */
+struct hit_chunk_header
+{
+    uint32_t magic;                                 ///< `CHNK`
+    uint32_t n_columns;                             ///< number of columns
+    uint64_t size;                                  ///< size of the chunk including the header
+    hit_chunk_stats stats;                          ///< chunk statistics
+    std::array<uint64_t, hit_file_columns> offsets; ///< column offsets from the chunk begin
+};
+
+static_assert(std::is_trivially_copyable<hit_chunk_header>::value, "chunk header must be trivially copyable");
+static_assert(sizeof(hit_chunk_stats) == 80, "chunk stats must have fixed layout");
+static_assert(sizeof(hit_chunk_header) == 16 + 80 + 8 * hit_file_columns, "chunk header must have fixed layout");
+
+inline auto padded(std::size_t size) -> std::size_t { return (size + 7) / 8 * 8; }
+} // namespace detail
+
+/**
+ * Options of the hit_file_writer.
+ */
+struct hit_file_options
+{
+    std::size_t frames_per_chunk{4096}; ///< number of frames in the chunk
+};
+
+/**
+ * Writes the decoded frames into the chunked columnar file, see `hit_file.hpp`.
+ *
+ * The frames are collected into the columns in memory and written chunk by chunk, with the chunk statistics. The
+ * incomplete chunk is written by `flush()`, `close()` or the destructor.
+ * ```c++
+ * geri::hit_file_writer writer("run.hits");
+ * while (...) { decoder.decode_frame(frame); writer.write(frame); }
+ * ```
+ */
+class hit_file_writer
+{
+public:
+    /**
+     * Create the file, terminates the program if the file cannot be created.
+     *
+     * @param filename file to write to
+     * @param options writer options
+     */
+    explicit hit_file_writer(const char* filename, hit_file_options options = {})
+        : opts{options}, file{std::fopen(filename, "wb")}
+    {
+        if (file == nullptr) { abort(); }
+
+        opts.frames_per_chunk = std::min<std::size_t>(std::max<std::size_t>(opts.frames_per_chunk, 1), UINT32_MAX);
+
+        detail::hit_file_header header{};
+        std::memcpy(header.magic, detail::hit_file_magic, sizeof(header.magic));
+        header.version = detail::hit_file_version;
+        write_bytes(&header, sizeof(header));
+    }
+
+    hit_file_writer(const hit_file_writer&) = delete;
+    auto operator=(const hit_file_writer&) -> hit_file_writer& = delete;
+
+    ~hit_file_writer() { close(); }
+
+    /**
+     * Append the frame.
+     *
+     * @param frame decoded frame
+     */
+    template <typename Allocator> auto write(const basic_payload_frame<Allocator>& frame) -> void
+    {
+        add_frame(frame.event_no, frame.system_ts, frame.data_dropped, frame.hits.size());
+        for (const auto& hit : frame.hits)
+        {
+            add_hit(hit.unique_addr, hit.channel, hit.adc, hit.full_ts,
+                    static_cast<uint8_t>(hit.event_missing ? columnar_frame::event_missing : 0));
+        }
+        end_frame();
+    }
+
+    /**
+     * Append the frame.
+     *
+     * @param frame decoded frame
+     */
+    auto write(const columnar_frame& frame) -> void
+    {
+        add_frame(frame.event_no, frame.system_ts, frame.data_dropped, frame.size());
+        for (std::size_t idx = 0; idx < frame.size(); ++idx)
+        {
+            add_hit(frame.addr()[idx], frame.channel()[idx], frame.adc()[idx], frame.full_ts()[idx],
+                    frame.flags()[idx]);
+        }
+        end_frame();
+    }
+
+    /**
+     * Write the collected frames as the chunk.
+     *
+     * @return false on write error
+     */
+    auto flush() -> bool
+    {
+        if (file == nullptr) { return false; }
+        if (stats.n_frames == 0) { return good; }
+
+        detail::hit_chunk_header header{};
+        header.magic = detail::hit_chunk_magic;
+        header.n_columns = detail::hit_file_columns;
+        header.stats = stats;
+
+        const std::array<std::size_t, detail::hit_file_columns> sizes{
+            bytes(event_no), bytes(system_ts), bytes(data_dropped), bytes(hit_count), bytes(addr),
+            bytes(channel),  bytes(adc),       bytes(full_ts),      bytes(flags)};
+
+        uint64_t offset{sizeof(header)};
+        for (std::size_t col = 0; col < sizes.size(); ++col)
+        {
+            header.offsets[col] = offset;
+            offset += detail::padded(sizes[col]);
+        }
+        header.size = offset;
+
+        write_bytes(&header, sizeof(header));
+        write_column(event_no);
+        write_column(system_ts);
+        write_column(data_dropped);
+        write_column(hit_count);
+        write_column(addr);
+        write_column(channel);
+        write_column(adc);
+        write_column(full_ts);
+        write_column(flags);
+
+        reset_chunk();
+        return good;
+    }
+
+    /**
+     * Write the remaining frames and close the file.
+     *
+     * @return false if any write failed
+     */
+    auto close() -> bool
+    {
+        if (file == nullptr) { return good; }
+
+        flush();
+        good = std::fclose(file) == 0 and good;
+        file = nullptr;
+        return good;
+    }
+
+    /// @return number of written chunks
+    auto chunks() const -> std::size_t { return n_chunks; }
+
+private:
+    template <typename T> static auto bytes(const std::vector<T>& column) -> std::size_t
+    { return column.size() * sizeof(T); }
+
+    auto write_bytes(const void* data, std::size_t size) -> void
+    {
+        if (size != 0 and std::fwrite(data, 1, size, file) != size) { good = false; }
+    }
+
+    template <typename T> auto write_column(const std::vector<T>& column) -> void
+    {
+        static const uint64_t zero{0};
+        write_bytes(column.data(), bytes(column));
+        write_bytes(&zero, detail::padded(bytes(column)) - bytes(column));
+    }
+
+    auto add_frame(uint32_t frame_event_no, uint64_t frame_system_ts, bool frame_data_dropped, std::size_t n_hits)
+        -> void
+    {
+        if (stats.n_frames == 0)
+        {
+            stats.first_event_no = frame_event_no;
+            stats.min_system_ts = stats.max_system_ts = frame_system_ts;
+        }
+
+        stats.last_event_no = frame_event_no;
+        stats.min_system_ts = std::min(stats.min_system_ts, frame_system_ts);
+        stats.max_system_ts = std::max(stats.max_system_ts, frame_system_ts);
+        stats.dropped_frames += frame_data_dropped ? 1U : 0U;
+
+        event_no.push_back(frame_event_no);
+        system_ts.push_back(frame_system_ts);
+        data_dropped.push_back(frame_data_dropped ? 1 : 0);
+        hit_count.push_back(static_cast<uint32_t>(n_hits));
+    }
+
+    auto add_hit(uint8_t hit_addr, uint8_t hit_channel, uint8_t hit_adc, uint16_t hit_full_ts, uint8_t hit_flags)
+        -> void
+    {
+        if (stats.n_hits == 0)
+        {
+            stats.min_full_ts = stats.max_full_ts = hit_full_ts;
+            stats.min_adc = stats.max_adc = hit_adc;
+            stats.min_channel = stats.max_channel = hit_channel;
+        }
+
+        ++stats.n_hits;
+        stats.min_full_ts = std::min(stats.min_full_ts, hit_full_ts);
+        stats.max_full_ts = std::max(stats.max_full_ts, hit_full_ts);
+        stats.min_adc = std::min(stats.min_adc, hit_adc);
+        stats.max_adc = std::max(stats.max_adc, hit_adc);
+        stats.min_channel = std::min(stats.min_channel, hit_channel);
+        stats.max_channel = std::max(stats.max_channel, hit_channel);
+        stats.addr_mask[hit_addr >> 6] |= uint64_t{1} << (hit_addr & 0x3f);
+
+        addr.push_back(hit_addr);
+        channel.push_back(hit_channel);
+        adc.push_back(hit_adc);
+        full_ts.push_back(hit_full_ts);
+        flags.push_back(hit_flags);
+    }
+
+    auto end_frame() -> void
+    {
+        ++stats.n_frames;
+        if (stats.n_frames == opts.frames_per_chunk) { flush(); }
+    }
+
+    auto reset_chunk() -> void
+    {
+        ++n_chunks;
+        stats = {};
+        event_no.clear();
+        system_ts.clear();
+        data_dropped.clear();
+        hit_count.clear();
+        addr.clear();
+        channel.clear();
+        adc.clear();
+        full_ts.clear();
+        flags.clear();
+    }
+
+    hit_file_options opts;             ///< writer options
+    std::FILE* file;                   ///< output file
+    bool good{true};                   ///< no write error
+    std::size_t n_chunks{0};           ///< number of written chunks
+    hit_chunk_stats stats;             ///< statistics of the current chunk
+
+    std::vector<uint32_t> event_no;    ///< event numbers of the frames
+    std::vector<uint64_t> system_ts;   ///< system timestamps of the frames
+    std::vector<uint8_t> data_dropped; ///< data dropped flags of the frames
+    std::vector<uint32_t> hit_count;   ///< numbers of hits of the frames
+    std::vector<uint8_t> addr;         ///< GBT/uplink unique addresses of the hits
+    std::vector<uint8_t> channel;      ///< channel numbers of the hits
+    std::vector<uint8_t> adc;          ///< adc values of the hits
+    std::vector<uint16_t> full_ts;     ///< full timestamps of the hits
+    std::vector<uint8_t> flags;        ///< flags of the hits
+};
+
+/**
+ * Reads the chunked columnar file written by `hit_file_writer`, see `hit_file.hpp`.
+ *
+ * The file is memory-mapped and the chunks are accessed in place. Only the selected columns are read: when not all
+ * columns are selected the mapping is advised for random access, and the selected columns of each visited chunk are
+ * prefetched, so the pages of the other columns are never read from the disk. The chunks can be skipped by their
+ * statistics before touching the columns.
+ * ```c++
+ * geri::hit_file_reader rdr("run.hits", geri::hit_file_reader::adc | geri::hit_file_reader::addr);
+ * for (std::size_t idx = 0; idx < rdr.chunks(); ++idx)
+ * {
+ *     auto chunk = rdr.chunk(idx);
+ *     for (auto adc : chunk.adc) { ... }
+ * }
+ * ```
+ * The file truncated in the middle of the chunk is read up to the last complete chunk, the same for the chunk with
+ * inconsistent header.
+ */
+class hit_file_reader
+{
+public:
+    /**
+     * Bits of the selected columns.
+     */
+    enum COLUMNS : uint16_t
+    {
+        event_no = 0x1,     ///< event numbers
+        system_ts = 0x2,    ///< system timestamps
+        data_dropped = 0x4, ///< data dropped flags
+        addr = 0x8,         ///< GBT/uplink unique addresses
+        channel = 0x10,     ///< channel numbers
+        adc = 0x20,         ///< adc values
+        full_ts = 0x40,     ///< full timestamps
+        flags = 0x80,       ///< hit flags
+        all = 0xff          ///< all columns
+    };
+
+    /**
+     * Map the file, terminates the program if the file cannot be opened.
+     *
+     * @param filename file to read from
+     * @param columns selected columns, see COLUMNS
+     */
+    explicit hit_file_reader(const char* filename, unsigned columns = all)
+        : selected{columns & all}, file_map{filename, selected == all ? MADV_SEQUENTIAL : MADV_RANDOM}
+    {
+        const auto* data = file_map.data();
+        const auto size = file_map.length;
+
+        detail::hit_file_header header{};
+        if (size < sizeof(header)) { return; }
+
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, detail::hit_file_magic, sizeof(header.magic)) != 0 or
+            header.version != detail::hit_file_version)
+        {
+            return;
+        }
+
+        valid_file = true;
+        for (auto offset = sizeof(header); size - offset >= sizeof(detail::hit_chunk_header);)
+        {
+            const auto* chunk_header = reinterpret_cast<const detail::hit_chunk_header*>(data + offset);
+            if (!valid_chunk(chunk_header, size - offset)) { break; }
+
+            headers.push_back(chunk_header);
+            n_frames += chunk_header->stats.n_frames;
+            n_hits += chunk_header->stats.n_hits;
+            offset += chunk_header->size;
+        }
+    }
+
+    /// @return whether the file has valid header
+    auto valid() const -> bool { return valid_file; }
+    /// @return number of complete chunks
+    auto chunks() const -> std::size_t { return headers.size(); }
+    /// @return total number of frames
+    auto frames() const -> uint64_t { return n_frames; }
+    /// @return total number of hits
+    auto hits() const -> uint64_t { return n_hits; }
+
+    /**
+     * @param idx chunk index
+     * @return statistics of the chunk
+     */
+    auto stats(std::size_t idx) const -> const hit_chunk_stats& { return headers[idx]->stats; }
+
+    /**
+     * Get the selected columns of the chunk, the views are valid for the reader lifetime.
+     *
+     * @param idx chunk index
+     * @return the chunk columns
+     */
+    auto chunk(std::size_t idx) const -> hit_chunk
+    {
+        const auto* header = headers[idx];
+        const auto n_frm = header->stats.n_frames;
+        const auto n_hit = static_cast<std::size_t>(header->stats.n_hits);
+
+        hit_chunk columns;
+        columns.stats = &header->stats;
+        columns.hit_count = column<uint32_t>(header, 3, n_frm, true);
+        columns.event_no = column<uint32_t>(header, 0, n_frm, (selected & event_no) != 0);
+        columns.system_ts = column<uint64_t>(header, 1, n_frm, (selected & system_ts) != 0);
+        columns.data_dropped = column<uint8_t>(header, 2, n_frm, (selected & data_dropped) != 0);
+        columns.addr = column<uint8_t>(header, 4, n_hit, (selected & addr) != 0);
+        columns.channel = column<uint8_t>(header, 5, n_hit, (selected & channel) != 0);
+        columns.adc = column<uint8_t>(header, 6, n_hit, (selected & adc) != 0);
+        columns.full_ts = column<uint16_t>(header, 7, n_hit, (selected & full_ts) != 0);
+        columns.flags = column<uint8_t>(header, 8, n_hit, (selected & flags) != 0);
+        return columns;
+    }
+
+    /**
+     * Move the sequential reading to the beginning of the chunk.
+     *
+     * @param idx chunk index
+     */
+    auto seek_chunk(std::size_t idx) -> void
+    {
+        chunk_idx = idx;
+        frame_idx = 0;
+        hit_idx = 0;
+        if (chunk_idx < headers.size()) { current = chunk(chunk_idx); }
+    }
+
+    /**
+     * Read the next frame. The columns which are not selected are zero.
+     *
+     * @param frame the frame to fill
+     * @return false at the end of file
+     */
+    auto try_read_frame(columnar_frame& frame) -> bool
+    {
+        while (chunk_idx < headers.size() and frame_idx == current.hit_count.size())
+        {
+            seek_chunk(chunk_idx + (current.stats != nullptr ? 1 : 0));
+        }
+        if (chunk_idx >= headers.size()) { return false; }
+
+        frame.clear();
+        frame.event_no = value(current.event_no, frame_idx);
+        frame.system_ts = value(current.system_ts, frame_idx);
+        frame.data_dropped = value(current.data_dropped, frame_idx) != 0;
+
+        const auto count = current.hit_count[frame_idx++];
+        frame.reserve(count);
+        for (auto last = hit_idx + count; hit_idx < last; ++hit_idx)
+        {
+            frame.push_back(value(current.addr, hit_idx), value(current.channel, hit_idx), value(current.adc, hit_idx),
+                            value(current.full_ts, hit_idx), value(current.flags, hit_idx));
+        }
+
+        return true;
+    }
+
+private:
+    /**
+     * Check that the chunk fits in the file, its columns fit in the chunk and are aligned, and the hits counts of the
+     * frames add up to the number of hits.
+     *
+     * @param header the chunk header, aligned to 8 bytes
+     * @param available bytes from the chunk begin to the end of file
+     */
+    static auto valid_chunk(const detail::hit_chunk_header* header, std::size_t available) -> bool
+    {
+        const auto size = header->size;
+        if (header->magic != detail::hit_chunk_magic or header->n_columns != detail::hit_file_columns or
+            size < sizeof(detail::hit_chunk_header) or size % 8 != 0 or size > available)
+        {
+            return false;
+        }
+
+        const uint64_t n_frm = header->stats.n_frames;
+        const auto n_hit = header->stats.n_hits;
+        const std::array<std::pair<uint64_t, std::size_t>, detail::hit_file_columns> columns{{
+            {n_frm, sizeof(uint32_t)},
+            {n_frm, sizeof(uint64_t)},
+            {n_frm, sizeof(uint8_t)},
+            {n_frm, sizeof(uint32_t)},
+            {n_hit, sizeof(uint8_t)},
+            {n_hit, sizeof(uint8_t)},
+            {n_hit, sizeof(uint8_t)},
+            {n_hit, sizeof(uint16_t)},
+            {n_hit, sizeof(uint8_t)},
+        }};
+        for (std::size_t col = 0; col < columns.size(); ++col)
+        {
+            const auto offset = header->offsets[col];
+            if (offset < sizeof(detail::hit_chunk_header) or offset % 8 != 0 or offset > size or
+                columns[col].first > (size - offset) / columns[col].second)
+            {
+                return false;
+            }
+        }
+
+        const auto* hit_count = reinterpret_cast<const uint32_t*>(reinterpret_cast<const unsigned char*>(header) +
+                                                                  header->offsets[3]);
+        uint64_t sum{0};
+        for (uint64_t idx = 0; idx < n_frm; ++idx)
+        {
+            sum += hit_count[idx];
+        }
+        return sum == n_hit;
+    }
+
+    template <typename T> static auto value(span<const T> values, std::size_t idx) -> T
+    { return values.empty() ? T{} : values[idx]; }
+
+    /**
+     * View of the column, prefetched if the columns are projected.
+     */
+    template <typename T>
+    auto column(const detail::hit_chunk_header* header, std::size_t col, std::size_t count, bool read) const
+        -> span<const T>
+    {
+        if (!read or count == 0) { return {}; }
+
+        const auto* begin = reinterpret_cast<const unsigned char*>(header) + header->offsets[col];
+        if (selected != all)
+        {
+            static const auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+            auto first = reinterpret_cast<uintptr_t>(begin) / page * page;
+            madvise(reinterpret_cast<void*>(first), reinterpret_cast<uintptr_t>(begin) - first + count * sizeof(T),
+                    MADV_WILLNEED);
+        }
+
+        return {reinterpret_cast<const T*>(begin), count};
+    }
+
+    unsigned selected;                                    ///< selected columns
+    detail::byte_mapping file_map;                        ///< mapped file
+    bool valid_file{false};                               ///< file has valid header
+    std::vector<const detail::hit_chunk_header*> headers; ///< headers of the complete chunks
+    uint64_t n_frames{0};                                 ///< total number of frames
+    uint64_t n_hits{0};                                   ///< total number of hits
+
+    hit_chunk current;                                    ///< columns of the sequentially read chunk
+    std::size_t chunk_idx{0};                             ///< index of the sequentially read chunk
+    std::size_t frame_idx{0};                             ///< next frame in the chunk
+    std::size_t hit_idx{0};                               ///< next hit in the chunk
+};
+
+} // namespace geri
@@ -0,0 +1,442 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file parallel_decoder.hpp
+ * @brief Multi-threaded decoding of the whole data buffers
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace geri
+{
+
+/**
+ * Options of the parallel_decoder.
+ */
+struct parallel_options
+{
+    unsigned n_threads{0};             ///< number of worker threads, 0 - hardware concurrency
+    bool ordered{true};                ///< deliver frames in the stream order
+    std::size_t frames_per_chunk{256}; ///< number of frames decoded by single task
+    std::size_t max_pending_chunks{0}; ///< maximal number of chunks decoded ahead of the consumer, 0 - 4 per thread
+    hit_filter filter;                 ///< selection of the decoded hits, see `payload_decoder::set_filter()`
+    bool check_crc{false};             ///< verify the TS_MSB CRC, see `payload_decoder::set_ts_msb_crc_check()`
+};
+
+/**
+ * Decodes the whole buffer (e.g. mapped file) on a pool of worker threads.
+ *
+ * The buffer is split at the frame boundaries, found with `event_index`, into chunks of consecutive frames. The
+ * chunks are distributed over the workers, which steal chunks from each other when idle. The decoded frames are
+ * delivered to the consumer in the calling thread, in the stream order or, if requested, in the order of completion.
+ *
+ * The per-uplink timestamp MSB state carries across frames. Before decoding, each chunk is scanned in parallel for
+ * its last ts_msb words, and the state at the beginning of every chunk is resolved from the preceding chunks, so the
+ * frames are decoded exactly as by a single `payload_decoder`.
+ * ```c++
+ * geri::parallel_decoder pdec(filename);
+ * pdec.run([](geri::payload_frame& frame) { ... });
+ * ```
+ */
+class parallel_decoder
+{
+public:
+    using ts_state = payload_decoder<memory_reader>::ts_state; ///< per-uplink timestamp MSB state
+
+    /**
+     * @param data buffer with the data words, must outlive the decoder
+     * @param index index of the frames in the buffer, built if not given, must outlive the decoder
+     * @param options decoding options
+     */
+    explicit parallel_decoder(span<const uint64_t> data, const event_index* index = nullptr,
+                              parallel_options options = {})
+        : words{data}, frames_index{index}, opts{options}
+    {
+        init();
+    }
+
+#ifdef GERI_SMX_DECODER_POSIX
+    /**
+     * @param filename file to map and decode
+     * @param options decoding options
+     */
+    explicit parallel_decoder(const char* filename, parallel_options options = {})
+        : file_map{new mmap_reader(filename)}, words{file_map->data()}, opts{options}
+    {
+        init();
+    }
+#endif
+
+    parallel_decoder(const parallel_decoder&) = delete;
+    auto operator=(const parallel_decoder&) -> parallel_decoder& = delete;
+
+    /**
+     * @return index of the frames
+     */
+    auto index() const -> const event_index& { return *frames_index; }
+
+    /**
+     * Decode all frames and pass them to the consumer.
+     *
+     * The consumer is called in the calling thread as `consumer(payload_frame&)`, the frame is valid only for the
+     * duration of the call. Broken frames are skipped, see `invalid_frames()`. Other exceptions from decoding and
+     * from the consumer stop the decoding and are rethrown.
+     *
+     * @param consumer the frames consumer
+     * @return number of delivered frames
+     */
+    template <typename Consumer> auto run(Consumer&& consumer) -> std::size_t
+    {
+        prepare_chunks();
+        resolve_ts_states();
+
+        std::size_t n_frames{0};
+        n_invalid = 0;
+        workers_guard guard{this};
+        guard.start();
+
+        for (std::size_t consumed = 0; consumed < chunks.size(); ++consumed)
+        {
+            auto idx = wait_for_chunk(consumed);
+            auto& chk = chunks[idx];
+
+            if (chk.error) { std::rethrow_exception(chk.error); }
+
+            for (auto& frame : chk.frames)
+            {
+                consumer(frame);
+            }
+            n_frames += chk.frames.size();
+            n_invalid += chk.invalid;
+
+            release_chunk(idx);
+        }
+
+        return n_frames;
+    }
+
+    /**
+     * @return number of broken frames skipped by the last `run()`
+     */
+    auto invalid_frames() const -> std::size_t { return n_invalid; }
+
+private:
+    /**
+     * Task of decoding consecutive frames.
+     */
+    struct chunk
+    {
+        std::size_t first{0};              ///< first frame in the index
+        std::size_t count{0};              ///< number of frames
+        ts_state initial_ts{};             ///< uplinks timestamp state at the chunk begin
+        ts_state last_ts{};                ///< last ts_msb seen in the chunk
+        std::array<bool, 256> ts_seen{};   ///< whether ts_msb of the uplink was seen in the chunk
+        std::vector<payload_frame> frames; ///< decoded frames
+        std::size_t invalid{0};            ///< number of broken frames skipped
+        std::exception_ptr error;          ///< decoding error
+        bool done{false};                  ///< chunk was decoded
+    };
+
+    /**
+     * Starts the workers and stops them when leaving the scope.
+     */
+    struct workers_guard
+    {
+        parallel_decoder* pdec;
+
+        auto start() -> void
+        {
+            for (unsigned id = 0; id < pdec->n_threads; ++id)
+            {
+                pdec->workers.emplace_back([this, id]() { pdec->work(id); });
+            }
+        }
+
+        ~workers_guard()
+        {
+            {
+                std::lock_guard<std::mutex> lock(pdec->mutex);
+                pdec->stopping = true;
+            }
+            pdec->workers_cv.notify_all();
+            for (auto& worker : pdec->workers)
+            {
+                worker.join();
+            }
+            pdec->workers.clear();
+        }
+    };
+
+    auto init() -> void
+    {
+        if (frames_index == nullptr)
+        {
+            own_index.reset(new event_index);
+            memory_reader reader(words);
+            own_index->build(reader);
+            frames_index = own_index.get();
+        }
+
+        n_threads = opts.n_threads ? opts.n_threads : std::max(1U, std::thread::hardware_concurrency());
+        max_pending = opts.max_pending_chunks ? opts.max_pending_chunks : 4 * std::size_t{n_threads};
+    }
+
+    auto prepare_chunks() -> void
+    {
+        const auto& entries = frames_index->entries();
+        const auto per_chunk = std::max<std::size_t>(opts.frames_per_chunk, 1);
+
+        chunks.clear();
+        chunks.resize((entries.size() + per_chunk - 1) / per_chunk);
+        queues.assign(n_threads, {});
+
+        for (std::size_t idx = 0; idx < chunks.size(); ++idx)
+        {
+            chunks[idx].first = idx * per_chunk;
+            chunks[idx].count = std::min(per_chunk, entries.size() - chunks[idx].first);
+            // contiguous ranges, so workers start far apart and steal from the front of the others
+            queues[idx * n_threads / chunks.size()].push_back(idx);
+        }
+
+        consumed_chunks = 0;
+        outstanding = 0;
+        stopping = false;
+        ready.clear();
+    }
+
+    /**
+     * Scan chunks for the ts_msb words in parallel and resolve the timestamp state at the beginning of each chunk.
+     */
+    auto resolve_ts_states() -> void
+    {
+        std::atomic<std::size_t> next{0};
+        std::vector<std::thread> scanners;
+        for (unsigned id = 0; id < n_threads; ++id)
+        {
+            scanners.emplace_back(
+                [this, &next]()
+                {
+                    for (auto idx = next++; idx < chunks.size(); idx = next++)
+                    {
+                        scan_ts_msb(chunks[idx]);
+                    }
+                });
+        }
+        for (auto& scanner : scanners)
+        {
+            scanner.join();
+        }
+
+        ts_state state{};
+        for (auto& chk : chunks)
+        {
+            chk.initial_ts = state;
+            for (std::size_t addr = 0; addr < state.size(); ++addr)
+            {
+                if (chk.ts_seen[addr]) { state[addr] = chk.last_ts[addr]; }
+            }
+        }
+    }
+
+    auto scan_ts_msb(chunk& chk) const -> void
+    {
+        for (auto frm = chk.first; frm < chk.first + chk.count; ++frm)
+        {
+            const auto& ent = frames_index->entries()[frm];
+            const auto* first = words.data() + ent.offset / sizeof(uint64_t) + 4;
+            const auto* last = words.data() + ent.offset / sizeof(uint64_t) + ent.n_words - 4;
+
+            for (const auto* word = first; word < last; ++word)
+            {
+                // skipped by the decoder
+                if (markers::is_stop(*word)) { continue; }
+
+                for (auto data_word : {static_cast<uint32_t>(*word & 0xffffffff), static_cast<uint32_t>(*word >> 32)})
+                {
+                    if (smx::get_uplink_frame_type(data_word) != smx::UPLINK_FRAME_TYPE::ts_msb) { continue; }
+                    if (opts.check_crc and smx::ts_msb_crc_syndrome(data_word) != 0) { continue; }
+
+                    auto addr = data_word >> 24;
+                    uint16_t ts_msb{0};
+                    if (smx::try_decode_smx_ts_msb(data_word, ts_msb) != DECODE_STATUS::ok) { continue; }
+
+                    chk.last_ts[addr] = ts_msb;
+                    chk.ts_seen[addr] = true;
+                }
+            }
+        }
+    }
+
+    /**
+     * Check whether the chunk can be decoded without exceeding the pending chunks limit.
+     */
+    auto eligible(std::size_t idx) const -> bool
+    {
+        return opts.ordered ? idx < consumed_chunks + max_pending : outstanding < max_pending;
+    }
+
+    /**
+     * Take the next chunk from own queue or steal from the others. Must be called with the lock held.
+     */
+    auto take_chunk(unsigned id, std::size_t& idx) -> bool
+    {
+        for (unsigned off = 0; off < n_threads; ++off)
+        {
+            auto& queue = queues[(id + off) % n_threads];
+            if (!queue.empty() and eligible(queue.front()))
+            {
+                idx = queue.front();
+                queue.pop_front();
+                ++outstanding;
+
+                if (!spare_frames.empty())
+                {
+                    chunks[idx].frames = std::move(spare_frames.back());
+                    spare_frames.pop_back();
+                }
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto all_taken() const -> bool
+    {
+        return std::all_of(queues.begin(), queues.end(),
+                           [](const std::deque<std::size_t>& queue) { return queue.empty(); });
+    }
+
+    auto work(unsigned id) -> void
+    {
+        while (true)
+        {
+            std::size_t idx{0};
+            bool taken{false};
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workers_cv.wait(lock,
+                                [&]()
+                                {
+                                    if (stopping) { return true; }
+                                    taken = take_chunk(id, idx);
+                                    return taken or all_taken();
+                                });
+                if (!taken) { return; }
+            }
+
+            decode_chunk(chunks[idx]);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunks[idx].done = true;
+                ready.push_back(idx);
+            }
+            consumer_cv.notify_one();
+        }
+    }
+
+    auto decode_chunk(chunk& chk) -> void
+    {
+        const auto& entries = frames_index->entries();
+        const auto& first = entries[chk.first];
+        const auto& last = entries[chk.first + chk.count - 1];
+
+        memory_reader reader(words.data() + first.offset / sizeof(uint64_t),
+                             (last.offset - first.offset) / sizeof(uint64_t) + last.n_words);
+        payload_decoder<memory_reader> decoder(&reader);
+        decoder.set_ts_state(chk.initial_ts);
+        decoder.set_filter(opts.filter);
+        decoder.set_ts_msb_crc_check(opts.check_crc);
+
+        chk.frames.resize(chk.count);
+        chk.invalid = 0;
+        try
+        {
+            std::size_t n_decoded{0};
+            for (std::size_t frm = 0; frm < chk.count; ++frm)
+            {
+                auto status = decoder.try_decode_frame(chk.frames[n_decoded]);
+                if (status == DECODE_STATUS::ok) { ++n_decoded; }
+                else if (status == DECODE_STATUS::end_of_data) { break; }
+                else { ++chk.invalid; }
+            }
+            chk.frames.resize(n_decoded);
+        }
+        catch (...)
+        {
+            chk.error = std::current_exception();
+        }
+    }
+
+    auto wait_for_chunk(std::size_t consumed) -> std::size_t
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (opts.ordered)
+        {
+            consumer_cv.wait(lock, [&]() { return chunks[consumed].done; });
+            return consumed;
+        }
+
+        consumer_cv.wait(lock, [&]() { return !ready.empty(); });
+        auto idx = ready.front();
+        ready.pop_front();
+        return idx;
+    }
+
+    auto release_chunk(std::size_t idx) -> void
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            spare_frames.push_back(std::move(chunks[idx].frames));
+            chunks[idx].frames.clear();
+            ++consumed_chunks;
+            --outstanding;
+        }
+        workers_cv.notify_all();
+    }
+
+#ifdef GERI_SMX_DECODER_POSIX
+    std::unique_ptr<mmap_reader> file_map;                ///< mapped file, if decoding a file
+#endif
+    span<const uint64_t> words;                           ///< data words
+    std::unique_ptr<event_index> own_index;               ///< index built by the decoder
+    const event_index* frames_index{nullptr};             ///< index of the frames
+    parallel_options opts;                                ///< decoding options
+    unsigned n_threads{1};                                ///< number of workers
+    std::size_t max_pending{1};                           ///< maximal number of chunks ahead of the consumer
+    std::size_t n_invalid{0};                             ///< broken frames skipped by the last run
+
+    std::vector<chunk> chunks;                            ///< decoding tasks
+    std::vector<std::deque<std::size_t>> queues;          ///< chunks queue of each worker
+    std::deque<std::size_t> ready;                        ///< decoded chunks, in order of completion
+    std::vector<std::vector<payload_frame>> spare_frames; ///< frames of the consumed chunks, for reuse
+    std::size_t consumed_chunks{0};                       ///< number of consumed chunks
+    std::size_t outstanding{0};                           ///< number of taken but not consumed chunks
+    bool stopping{false};                                 ///< workers should stop
+
+    std::vector<std::thread> workers;                     ///< worker threads
+    std::mutex mutex;                                     ///< guards the scheduling state
+    std::condition_variable workers_cv;                   ///< wakes up workers
+    std::condition_variable consumer_cv;                  ///< wakes up consumer
+};
+
+} // namespace geri
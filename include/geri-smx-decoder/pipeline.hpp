@@ -0,0 +1,553 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file pipeline.hpp
+ * @brief Reading, decoding and processing of the data in separate threads
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace geri
+{
+
+/**
+ * Bounded lock-free queue for single producer and single consumer thread.
+ *
+ * The capacity is rounded up to the power of two. The objects are moved in and out of the queue, the slots keep the
+ * moved-from objects.
+ */
+template <typename T> class spsc_ring
+{
+public:
+    static constexpr std::size_t cache_line{64}; ///< separates the producer and consumer indices
+
+    /**
+     * @param min_capacity minimal number of queued objects
+     */
+    explicit spsc_ring(std::size_t min_capacity) : slots(round_capacity(min_capacity)), mask{slots.size() - 1} {}
+
+    spsc_ring(const spsc_ring&) = delete;
+    auto operator=(const spsc_ring&) -> spsc_ring& = delete;
+
+    /**
+     * Move the object into the queue. Only the producer thread may call it.
+     *
+     * @param value the object, moved-from on success
+     * @return false if the queue is full
+     */
+    auto try_push(T& value) -> bool
+    {
+        auto pos = tail.load(std::memory_order_relaxed);
+        if (pos - head_cache == slots.size())
+        {
+            head_cache = head.load(std::memory_order_acquire);
+            if (pos - head_cache == slots.size()) { return false; }
+        }
+
+        slots[pos & mask] = std::move(value);
+        tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Move the object out of the queue. Only the consumer thread may call it.
+     *
+     * @param value the object
+     * @return false if the queue is empty
+     */
+    auto try_pop(T& value) -> bool
+    {
+        auto pos = head.load(std::memory_order_relaxed);
+        if (pos == tail_cache)
+        {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (pos == tail_cache) { return false; }
+        }
+
+        value = std::move(slots[pos & mask]);
+        head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @return number of queued objects, approximate when called concurrently
+     */
+    auto size() const -> std::size_t
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return maximal number of queued objects
+     */
+    auto capacity() const -> std::size_t { return slots.size(); }
+
+private:
+    static auto round_capacity(std::size_t min_capacity) -> std::size_t
+    {
+        std::size_t capacity{1};
+        while (capacity < min_capacity)
+        {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    std::vector<T> slots;                                 ///< queued objects
+    std::size_t mask;                                     ///< maps the index to the slot
+
+    alignas(cache_line) std::atomic<std::size_t> head{0}; ///< next slot to pop, written by the consumer
+    std::size_t tail_cache{0};                            ///< last seen tail, consumer only
+
+    alignas(cache_line) std::atomic<std::size_t> tail{0}; ///< next slot to push, written by the producer
+    std::size_t head_cache{0};                            ///< last seen head, producer only
+};
+
+/**
+ * Options of the pipeline.
+ */
+struct pipeline_options
+{
+    std::size_t block_words{64UL * 1024UL}; ///< number of data words in the raw block
+    std::size_t n_blocks{32};               ///< number of raw blocks in flight
+    std::size_t n_frames{256};              ///< number of decoded frames in flight
+    int reader_cpu{-1};                     ///< CPU to pin the reader thread to, -1 - no pinning
+    int decoder_cpu{-1};                    ///< CPU to pin the decoder thread to, -1 - no pinning
+    int consumer_cpu{-1};                   ///< CPU to pin the calling thread to, -1 - no pinning
+};
+
+/**
+ * Snapshot of the pipeline counters.
+ *
+ * The stall times count the time the stage waits: the reader and the decoder for a free block or frame (back-pressure
+ * from the next stage), the decoder and the consumer for the data from the previous stage.
+ */
+struct pipeline_stats
+{
+    uint64_t words_read{0};          ///< number of data words read from the source
+    uint64_t blocks_read{0};         ///< number of raw blocks read from the source
+    uint64_t frames_decoded{0};      ///< number of decoded frames
+    uint64_t frames_invalid{0};      ///< number of broken frames skipped by the decoder
+    uint64_t frames_consumed{0};     ///< number of frames passed to the consumer
+    std::size_t blocks_depth{0};     ///< number of raw blocks queued for decoding
+    std::size_t frames_depth{0};     ///< number of decoded frames queued for the consumer
+    std::size_t max_blocks_depth{0}; ///< highest number of queued raw blocks
+    std::size_t max_frames_depth{0}; ///< highest number of queued frames
+    uint64_t reader_stall_ns{0};     ///< reader waiting for a free block
+    uint64_t decoder_wait_ns{0};     ///< decoder waiting for a raw block
+    uint64_t decoder_stall_ns{0};    ///< decoder waiting for a free frame
+    uint64_t consumer_wait_ns{0};    ///< consumer waiting for a frame
+};
+
+/**
+ * Pin the calling thread to the CPU.
+ *
+ * @param cpu CPU number, negative value does nothing
+ * @return false if the thread could not be pinned
+ */
+inline auto pin_current_thread(int cpu) -> bool
+{
+    if (cpu < 0) { return true; }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<std::size_t>(cpu), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Reads, decodes and processes the data in three threads.
+ *
+ * The reader thread copies the data words from the source reader into raw blocks, the decoder thread decodes the
+ * blocks with `payload_decoder` and the decoded frames are passed to the consumer in the calling thread. The stages
+ * are connected with `spsc_ring` queues. The blocks and frames are recycled, their number is bounded by the options,
+ * so a slow stage holds the preceding ones back instead of growing the memory. A slow consumer does not stall the
+ * reader until all the frames and blocks in flight are filled.
+ *
+ * The source reader `R` must provide `read_block()` or `read_word()`, like the readers accepted by `payload_decoder`.
+ * ```c++
+ * geri::file_reader frdr(filename);
+ * geri::pipeline<geri::file_reader> pipe(&frdr);
+ * pipe.run([](geri::payload_frame& frame) { ... });
+ * ```
+ */
+template <typename R> class pipeline
+{
+    /**
+     * Provides the raw blocks queued by the reader thread to the decoder.
+     */
+    class block_source
+    {
+    public:
+        explicit block_source(pipeline* owner) : pipe{owner} {}
+
+        /**
+         * Return the next raw block. The previous block is given back to the reader.
+         *
+         * @return view of the data words, empty at the end of data
+         */
+        auto read_block() -> span<const uint64_t>
+        {
+            if (!current.empty())
+            {
+                current.clear();
+                pipe->free_blocks.try_push(current); // never full, holds all the blocks
+            }
+
+            if (!pipe->wait_pop(pipe->full_blocks, current, pipe->reader_done, pipe->decoder_wait_ns))
+            {
+                return {};
+            }
+
+            return {current.data(), current.size()};
+        }
+
+    private:
+        pipeline* pipe;                ///< owning pipeline
+        std::vector<uint64_t> current; ///< block being decoded
+    };
+
+public:
+    /**
+     * @param reader source of the data words, must outlive the pipeline
+     * @param options pipeline options
+     */
+    explicit pipeline(R* reader, pipeline_options options = {})
+        : data_reader{reader}, opts{options}, free_blocks{opts.n_blocks}, full_blocks{opts.n_blocks},
+          free_frames{opts.n_frames}, full_frames{opts.n_frames}, source{this}, frames_decoder{&source}
+    {
+    }
+
+    pipeline(const pipeline&) = delete;
+    auto operator=(const pipeline&) -> pipeline& = delete;
+
+    /**
+     * @return the decoder, e.g. to set the SIMD level or the timestamp state before `run()`
+     */
+    auto decoder() -> payload_decoder<block_source>& { return frames_decoder; }
+
+    /**
+     * Read and decode the data until the end of the source or `stop()`, and pass the frames to the consumer.
+     *
+     * The consumer is called in the calling thread as `consumer(payload_frame&)`, the frame is valid only for the
+     * duration of the call. Broken frames are skipped and counted in `pipeline_stats::frames_invalid`. Exceptions
+     * from reading, decoding and from the consumer stop the pipeline and are rethrown. The pipeline can be run only
+     * once.
+     *
+     * @param consumer the frames consumer
+     * @return number of consumed frames
+     */
+    template <typename Consumer> auto run(Consumer&& consumer) -> std::size_t
+    {
+        pin_current_thread(opts.consumer_cpu);
+
+        for (std::size_t n = 0; n < opts.n_blocks; ++n)
+        {
+            std::vector<uint64_t> block;
+            block.reserve(std::max<std::size_t>(opts.block_words, 1));
+            free_blocks.try_push(block);
+        }
+        for (std::size_t n = 0; n < opts.n_frames; ++n)
+        {
+            payload_frame frame;
+            free_frames.try_push(frame);
+        }
+
+        threads_guard guard{this, {}};
+        guard.threads.emplace_back([this]() { guarded(reader_error, reader_done, [this]() { read_loop(); }); });
+        guard.threads.emplace_back([this]() { guarded(decoder_error, decoder_done, [this]() { decode_loop(); }); });
+
+        try
+        {
+            payload_frame frame;
+            while (wait_pop(full_frames, frame, decoder_done, consumer_wait_ns))
+            {
+                consumer(frame);
+                frames_consumed.fetch_add(1, std::memory_order_relaxed);
+                free_frames.try_push(frame); // never full, holds all the frames
+            }
+        }
+        catch (...)
+        {
+            cancelled.store(true, std::memory_order_release);
+            throw;
+        }
+
+        guard.join();
+        if (reader_error) { std::rethrow_exception(reader_error); }
+        if (decoder_error) { std::rethrow_exception(decoder_error); }
+
+        return frames_consumed.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Request the pipeline to stop. The reader stops reading, the data already read are decoded and consumed. Can be
+     * called from any thread, including the consumer.
+     */
+    auto stop() -> void { stop_requested.store(true, std::memory_order_release); }
+
+    /**
+     * Can be called from any thread, also while running.
+     *
+     * @return snapshot of the counters
+     */
+    auto stats() const -> pipeline_stats
+    {
+        pipeline_stats res;
+        res.words_read = words_read.load(std::memory_order_relaxed);
+        res.blocks_read = blocks_read.load(std::memory_order_relaxed);
+        res.frames_decoded = frames_decoded.load(std::memory_order_relaxed);
+        res.frames_invalid = frames_invalid.load(std::memory_order_relaxed);
+        res.frames_consumed = frames_consumed.load(std::memory_order_relaxed);
+        res.blocks_depth = full_blocks.size();
+        res.frames_depth = full_frames.size();
+        res.max_blocks_depth = max_blocks_depth.load(std::memory_order_relaxed);
+        res.max_frames_depth = max_frames_depth.load(std::memory_order_relaxed);
+        res.reader_stall_ns = reader_stall_ns.load(std::memory_order_relaxed);
+        res.decoder_wait_ns = decoder_wait_ns.load(std::memory_order_relaxed);
+        res.decoder_stall_ns = decoder_stall_ns.load(std::memory_order_relaxed);
+        res.consumer_wait_ns = consumer_wait_ns.load(std::memory_order_relaxed);
+        return res;
+    }
+
+private:
+    /**
+     * Joins the stage threads when leaving the scope, also on the consumer exception.
+     */
+    struct threads_guard
+    {
+        pipeline* pipe;
+        std::vector<std::thread> threads;
+
+        auto join() -> void
+        {
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            threads.clear();
+        }
+
+        ~threads_guard()
+        {
+            pipe->cancelled.store(true, std::memory_order_release);
+            join();
+        }
+    };
+
+    /**
+     * Wait strategy of the stages: spin shortly, then yield, then sleep.
+     */
+    static auto backoff(unsigned& rounds) -> void
+    {
+        static const unsigned spin_rounds{64};
+        static const unsigned yield_rounds{1024};
+
+        if (rounds < yield_rounds)
+        {
+            if (rounds++ < spin_rounds)
+            {
+#ifdef GERI_SMX_DECODER_X86_SIMD
+                _mm_pause();
+#endif
+            }
+            else { std::this_thread::yield(); }
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    static auto elapsed_ns(std::chrono::steady_clock::time_point begin) -> uint64_t
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+    }
+
+    /**
+     * Pop the object from the queue, waiting until it is available.
+     *
+     * @param ring the queue
+     * @param value the popped object
+     * @param done set when the producer finished, the queue is drained first
+     * @param stall_ns accumulates the waiting time
+     * @return false if the producer finished and the queue is empty, or the pipeline was cancelled
+     */
+    template <typename T>
+    auto wait_pop(spsc_ring<T>& ring, T& value, const std::atomic<bool>& done, std::atomic<uint64_t>& stall_ns)
+        -> bool
+    {
+        if (ring.try_pop(value)) { return true; }
+
+        auto begin = std::chrono::steady_clock::now();
+        unsigned rounds{0};
+        bool res{false};
+        while (!cancelled.load(std::memory_order_acquire))
+        {
+            // check the flag before the queue, so the items pushed just before finishing are not lost
+            auto finished = done.load(std::memory_order_acquire);
+            if (ring.try_pop(value))
+            {
+                res = true;
+                break;
+            }
+            if (finished) { break; }
+            backoff(rounds);
+        }
+
+        stall_ns.fetch_add(elapsed_ns(begin), std::memory_order_relaxed);
+        return res;
+    }
+
+    /**
+     * Push the object into the queue and record the queue depth.
+     */
+    template <typename T> static auto push(spsc_ring<T>& ring, T& value, std::atomic<std::size_t>& max_depth) -> void
+    {
+        ring.try_push(value); // never full, holds all the objects
+        auto depth = ring.size();
+        if (depth > max_depth.load(std::memory_order_relaxed)) { max_depth.store(depth, std::memory_order_relaxed); }
+    }
+
+    /**
+     * Run the stage, store its exception and mark it as finished.
+     */
+    template <typename Stage> auto guarded(std::exception_ptr& error, std::atomic<bool>& done, Stage stage) -> void
+    {
+        try
+        {
+            stage();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+            cancelled.store(true, std::memory_order_release);
+        }
+        done.store(true, std::memory_order_release);
+    }
+
+    auto read_loop() -> void
+    {
+        pin_current_thread(opts.reader_cpu);
+
+        std::vector<uint64_t> block;
+        while (!stop_requested.load(std::memory_order_acquire))
+        {
+            if (!wait_pop(free_blocks, block, cancelled, reader_stall_ns)) { return; }
+
+            fill_block(block, detail::has_read_block<R>{});
+            if (block.empty()) { return; }
+
+            words_read.fetch_add(block.size(), std::memory_order_relaxed);
+            blocks_read.fetch_add(1, std::memory_order_relaxed);
+            push(full_blocks, block, max_blocks_depth);
+        }
+    }
+
+    auto fill_block(std::vector<uint64_t>& block, std::true_type /*bulk*/) -> void
+    {
+        const auto block_words = block.capacity();
+        while (block.size() != block_words)
+        {
+            if (pending.empty())
+            {
+                pending = data_reader->read_block();
+                if (pending.empty()) { return; }
+            }
+
+            auto count = std::min(block_words - block.size(), pending.size());
+            block.insert(block.end(), pending.begin(), pending.begin() + count);
+            pending = span<const uint64_t>(pending.data() + count, pending.size() - count);
+
+            // pass what the source has now, rather than waiting for the full block
+            if (pending.empty()) { return; }
+        }
+    }
+
+    auto fill_block(std::vector<uint64_t>& block, std::false_type /*bulk*/) -> void
+    {
+        const auto block_words = block.capacity();
+        uint64_t word{0};
+        while (block.size() != block_words and detail::try_read_word(*data_reader, word))
+        {
+            block.push_back(word);
+        }
+    }
+
+    auto decode_loop() -> void
+    {
+        pin_current_thread(opts.decoder_cpu);
+
+        payload_frame frame;
+        while (wait_pop(free_frames, frame, cancelled, decoder_stall_ns))
+        {
+            auto status = frames_decoder.try_decode_frame(frame);
+            while (status != DECODE_STATUS::ok and status != DECODE_STATUS::end_of_data)
+            {
+                frames_invalid.fetch_add(1, std::memory_order_relaxed);
+                status = frames_decoder.try_decode_frame(frame);
+            }
+            if (status == DECODE_STATUS::end_of_data) { return; }
+
+            frames_decoded.fetch_add(1, std::memory_order_relaxed);
+            push(full_frames, frame, max_frames_depth);
+        }
+    }
+
+    R* data_reader;                               ///< source of the data words
+    pipeline_options opts;                        ///< pipeline options
+    span<const uint64_t> pending;                 ///< words of the source block not copied yet
+
+    spsc_ring<std::vector<uint64_t>> free_blocks; ///< blocks returned to the reader
+    spsc_ring<std::vector<uint64_t>> full_blocks; ///< blocks queued for decoding
+    spsc_ring<payload_frame> free_frames;         ///< frames returned to the decoder
+    spsc_ring<payload_frame> full_frames;         ///< frames queued for the consumer
+
+    block_source source;                          ///< decoder view of the queued blocks
+    payload_decoder<block_source> frames_decoder; ///< decodes the queued blocks
+
+    std::atomic<bool> stop_requested{false};      ///< reader should stop
+    std::atomic<bool> cancelled{false};           ///< all stages should stop immediately
+    std::atomic<bool> reader_done{false};         ///< reader finished
+    std::atomic<bool> decoder_done{false};        ///< decoder finished
+    std::exception_ptr reader_error;              ///< exception of the reader thread
+    std::exception_ptr decoder_error;             ///< exception of the decoder thread
+
+    std::atomic<uint64_t> words_read{0};          ///< number of data words read
+    std::atomic<uint64_t> blocks_read{0};         ///< number of blocks read
+    std::atomic<uint64_t> frames_decoded{0};      ///< number of decoded frames
+    std::atomic<uint64_t> frames_invalid{0};      ///< number of skipped broken frames
+    std::atomic<uint64_t> frames_consumed{0};     ///< number of consumed frames
+    std::atomic<std::size_t> max_blocks_depth{0}; ///< highest number of queued blocks
+    std::atomic<std::size_t> max_frames_depth{0}; ///< highest number of queued frames
+    std::atomic<uint64_t> reader_stall_ns{0};     ///< reader waiting for a free block
+    std::atomic<uint64_t> decoder_wait_ns{0};     ///< decoder waiting for a block
+    std::atomic<uint64_t> decoder_stall_ns{0};    ///< decoder waiting for a free frame
+    std::atomic<uint64_t> consumer_wait_ns{0};    ///< consumer waiting for a frame
+};
+
+} // namespace geri
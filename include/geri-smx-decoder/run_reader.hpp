@@ -0,0 +1,325 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file run_reader.hpp
+ * @brief Reader of the run split into many files, with prefetching of the next file
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace geri
+{
+
+/**
+ * Options of the run_reader.
+ */
+struct run_options
+{
+    std::size_t block_size{4UL * 1024UL * 1024UL}; ///< size of the read block in bytes, rounded down to the full words
+    std::size_t readahead{64UL * 1024UL * 1024UL}; ///< bytes of the next file read ahead, 0 disables the prefetching
+};
+
+/**
+ * Reads the files of the run as one continuous stream.
+ *
+ * A run of the DAQ is split into many sequential files, the frames and even the data words can be split between them.
+ * With a single reader and decoder for the whole run, the uplinks timestamps state, the last system time and the
+ * counters are kept across the files, and the frames split at the file boundary are decoded as any other.
+ *
+ * When a file is opened, a background thread opens the next one and reads its beginning into the page cache (see
+ * `run_options::readahead`), so the decoding continues at the file boundary without waiting for the disk. Provides
+ * the same interface as `file_reader`, except `seek()`.
+ * ```c++
+ * geri::run_reader rdr({"run_0001.bin", "run_0002.bin", "run_0003.bin"});
+ * auto decoder = geri::payload_decoder<geri::run_reader>(&rdr);
+ * ```
+ */
+class run_reader
+{
+public:
+    /**
+     * Check the files, terminates the program if any of them cannot be read.
+     *
+     * @param filenames files of the run, in order
+     * @param options reader options
+     */
+    explicit run_reader(std::vector<std::string> filenames, run_options options = {})
+        : paths{std::move(filenames)},
+          opts{options},
+          buffer(std::max<std::size_t>(opts.block_size / sizeof(uint64_t), 1))
+    {
+        for (const auto& path : paths)
+        {
+            if (access(path.c_str(), R_OK) != 0) { abort(); }
+        }
+
+        if (paths.empty()) { return; }
+
+        fd = open_file(paths.front().c_str(), 0);
+        next_no = 1;
+        if (opts.readahead != 0 and paths.size() > 1) { worker = std::thread([this]() { prefetch(); }); }
+    }
+
+    run_reader(const run_reader&) = delete;
+    auto operator=(const run_reader&) -> run_reader& = delete;
+
+    ~run_reader()
+    {
+        if (worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            cv.notify_all();
+            worker.join();
+        }
+
+        if (fd >= 0) { close(fd); }
+        if (next_fd >= 0) { close(next_fd); }
+    }
+
+    /**
+     * @return index of the file being read, number of the files at the end of the run
+     */
+    auto file_index() const -> std::size_t { return file_no; }
+
+    /**
+     * @return number of the files of the run
+     */
+    auto files() const -> std::size_t { return paths.size(); }
+
+    /**
+     * @return number of the file boundaries at which the reader waited for the prefetching
+     */
+    auto waits() const -> std::size_t { return n_waits; }
+
+    /**
+     * Read the next data word, without throwing.
+     *
+     * @param word 64-bit word
+     * @return `ok` or `end_of_data`
+     */
+    auto try_read_word(uint64_t& word) -> DECODE_STATUS
+    {
+        if (head == tail and !refill()) { return DECODE_STATUS::end_of_data; }
+
+        word = buffer[head++];
+        return DECODE_STATUS::ok;
+    }
+
+    /**
+     * Read the next data word.
+     *
+     * End of the run is marked by `std::out_of_range` exception.
+     *
+     * @return 64-bit word
+     */
+    auto read_word() -> uint64_t
+    {
+        uint64_t word{0};
+        if (try_read_word(word) != DECODE_STATUS::ok) { throw std::out_of_range("END OF DATA"); }
+
+        return word;
+    }
+
+    /**
+     * Read up to `n` next data words.
+     *
+     * @param dst destination buffer, must hold at least `n` words
+     * @param n number of words to read
+     * @return number of words read, smaller than `n` only at the end of the run
+     */
+    auto read_words(uint64_t* dst, std::size_t n) -> std::size_t
+    {
+        std::size_t copied{0};
+
+        while (copied != n)
+        {
+            if (head == tail and !refill()) { break; }
+
+            auto count = std::min(n - copied, tail - head);
+            std::copy(buffer.data() + head, buffer.data() + head + count, dst + copied);
+            head += count;
+            copied += count;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Return all buffered data words which were not consumed yet, the next block is read if necessary. The returned
+     * words are marked as consumed. The view is valid until the next read call.
+     *
+     * @return view of the data words, empty at the end of the run
+     */
+    auto read_block() -> span<const uint64_t>
+    {
+        if (head == tail and !refill()) { return {}; }
+
+        auto block = span<const uint64_t>(buffer.data() + head, tail - head);
+        head = tail;
+        return block;
+    }
+
+private:
+    /**
+     * Open the file for sequential reading, terminates the program if the file cannot be opened.
+     *
+     * @param filename file to open
+     * @param readahead_bytes bytes read into the page cache, blocks until they are read
+     */
+    static auto open_file(const char* filename, std::size_t readahead_bytes) -> int
+    {
+        auto file_fd = open(filename, O_RDONLY | O_CLOEXEC);
+        if (file_fd < 0) { abort(); }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(file_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        if (readahead_bytes != 0)
+        {
+#if defined(__linux__)
+            readahead(file_fd, 0, readahead_bytes);
+#elif defined(POSIX_FADV_WILLNEED)
+            posix_fadvise(file_fd, 0, static_cast<off_t>(readahead_bytes), POSIX_FADV_WILLNEED);
+#endif
+        }
+
+        return file_fd;
+    }
+
+    /**
+     * Prefetching thread, opens the next file as soon as the previous one is taken.
+     */
+    auto prefetch() -> void
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            cv.wait(lock, [this]() { return stopping or (next_fd < 0 and next_no < paths.size()); });
+            if (stopping) { return; }
+
+            const auto* filename = paths[next_no].c_str();
+            lock.unlock();
+            auto file_fd = open_file(filename, opts.readahead);
+            lock.lock();
+
+            next_fd = file_fd;
+            cv.notify_all();
+        }
+    }
+
+    /**
+     * Continue with the next file of the run.
+     *
+     * @return false at the end of the run
+     */
+    auto next_file() -> bool
+    {
+        if (next_no == paths.size())
+        {
+            file_no = paths.size();
+            return false;
+        }
+
+        if (worker.joinable())
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (next_fd < 0)
+            {
+                ++n_waits;
+                cv.wait(lock, [this]() { return next_fd >= 0; });
+            }
+            fd = std::exchange(next_fd, -1);
+            ++next_no;
+            lock.unlock();
+            cv.notify_all();
+        }
+        else
+        {
+            fd = open_file(paths[next_no++].c_str(), 0);
+        }
+
+        file_no = next_no - 1;
+        return true;
+    }
+
+    /**
+     * Read the next block of data, across the file boundaries. The bytes of the word split between the files are kept
+     * for the next block. Unconsumed data are discarded.
+     *
+     * @return true if any word was read
+     */
+    auto refill() -> bool
+    {
+        auto* dst = reinterpret_cast<unsigned char*>(buffer.data());
+        const auto capacity = buffer.size() * sizeof(uint64_t);
+
+        std::size_t filled{n_carry};
+        std::memcpy(dst, carry.data(), n_carry);
+
+        while (filled < sizeof(uint64_t))
+        {
+            if (fd < 0 and !next_file()) { break; }
+
+            auto res = read(fd, dst + filled, capacity - filled);
+            if (res > 0) { filled += static_cast<std::size_t>(res); }
+            else if (res == 0 or errno != EINTR)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+
+        head = 0;
+        tail = filled / sizeof(uint64_t);
+        n_carry = filled % sizeof(uint64_t);
+        std::memcpy(carry.data(), dst + tail * sizeof(uint64_t), n_carry);
+
+        return tail != 0;
+    }
+
+    std::vector<std::string> paths;       ///< files of the run
+    run_options opts;                     ///< reader options
+    std::vector<uint64_t> buffer;         ///< block buffer
+    std::size_t head{0};                  ///< index of the next word to be consumed
+    std::size_t tail{0};                  ///< number of valid words in the buffer
+    std::array<unsigned char, 8> carry{}; ///< bytes of the word split between the files
+    std::size_t n_carry{0};               ///< number of the carried bytes
+
+    int fd{-1};                           ///< file being read
+    std::size_t file_no{0};               ///< index of the file being read
+    std::size_t next_no{0};               ///< index of the next file to read
+    std::size_t n_waits{0};               ///< waits for the prefetching
+
+    std::thread worker;                   ///< prefetching thread
+    std::mutex mutex;                     ///< guards the prefetched file
+    std::condition_variable cv;           ///< signals the prefetched and taken files
+    int next_fd{-1};                      ///< prefetched next file
+    bool stopping{false};                 ///< stops the prefetching thread
+};
+
+} // namespace geri
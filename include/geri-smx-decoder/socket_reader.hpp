@@ -0,0 +1,610 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file socket_reader.hpp
+ * @brief Readers of the data streamed over network sockets
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace geri
+{
+
+/**
+ * Statistics of the received data.
+ */
+struct socket_stats
+{
+    uint64_t packets{0};           ///< received datagrams (UDP) or successful receive calls (TCP)
+    uint64_t bytes{0};             ///< received bytes, including the sequence headers
+    uint64_t lost_packets{0};      ///< datagrams missing in the sequence and not received later
+    uint64_t reordered_packets{0}; ///< datagrams received after a datagram with higher sequence number
+    uint64_t malformed_packets{0}; ///< datagrams without full header or full words, and partial word at TCP EOF
+};
+
+namespace detail
+{
+/**
+ * Owns the socket file descriptor.
+ */
+class socket_handle
+{
+public:
+    explicit socket_handle(int socket_fd = -1) : fd{socket_fd} {}
+
+    socket_handle(const socket_handle&) = delete;
+    auto operator=(const socket_handle&) -> socket_handle& = delete;
+
+    socket_handle(socket_handle&& other) noexcept : fd{other.fd} { other.fd = -1; }
+    auto operator=(socket_handle&& other) noexcept -> socket_handle&
+    {
+        std::swap(fd, other.fd);
+        return *this;
+    }
+
+    ~socket_handle()
+    {
+        if (fd >= 0) { close(fd); }
+    }
+
+    auto get() const -> int { return fd; }
+
+private:
+    int fd; ///< socket file descriptor
+};
+
+/**
+ * Create the socket and bind it (`passive`) or connect it to the address.
+ *
+ * @param host host name or address, nullptr - any local address
+ * @param port port number
+ * @param type socket type, `SOCK_DGRAM` or `SOCK_STREAM`
+ * @param passive whether to bind instead of connect
+ * @return the socket, invalid on failure
+ */
+inline auto open_socket(const char* host, uint16_t port, int type, bool passive) -> socket_handle
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = type;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+    addrinfo* addresses{nullptr};
+    auto service = std::to_string(port);
+    if (getaddrinfo(host, service.c_str(), &hints, &addresses) != 0) { return socket_handle{}; }
+
+    socket_handle sock;
+    for (auto* addr = addresses; addr != nullptr; addr = addr->ai_next)
+    {
+        socket_handle candidate{socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol)};
+        if (candidate.get() < 0) { continue; }
+
+        auto res = passive ? bind(candidate.get(), addr->ai_addr, addr->ai_addrlen)
+                           : connect(candidate.get(), addr->ai_addr, addr->ai_addrlen);
+        if (res == 0)
+        {
+            sock = std::move(candidate);
+            break;
+        }
+    }
+
+    freeaddrinfo(addresses);
+    return sock;
+}
+
+/**
+ * @param fd socket file descriptor
+ * @return local port of the socket
+ */
+inline auto local_port(int fd) -> uint16_t
+{
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) { return 0; }
+
+    if (addr.ss_family == AF_INET6) { return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port); }
+    return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+}
+} // namespace detail
+
+/**
+ * Options of the udp_reader.
+ */
+struct udp_options
+{
+    const char* address{nullptr};          ///< local address to bind to, nullptr - any
+    std::size_t max_datagram{9000};        ///< maximal size of the datagram in bytes
+    std::size_t batch_size{64};            ///< number of datagrams received by single system call
+    std::size_t receive_buffer{8UL << 20}; ///< size of the socket receive buffer in bytes, 0 - system default
+    bool sequence_header{true};            ///< datagrams begin with 64-bit sequence number
+    int timeout_ms{-1};                    ///< end the stream after given time without data, -1 - never
+};
+
+/**
+ * Receives the data words from UDP datagrams.
+ *
+ * Datagrams are received in batches with `recvmmsg()` into an internal buffer and `read_block()` returns view of the
+ * data words of a single datagram, without copying. Each datagram carries full 64-bit words, optionally preceded by
+ * the 64-bit sequence number used to detect lost and reordered datagrams. The reordered datagrams are still delivered
+ * in the order of arrival, the decoder resynchronizes on the next frame. A datagram without data words (e.g. the one
+ * sent by `udp_sender::finish()`) or no data within the timeout ends the stream. Provides the same interface as
+ * `file_reader`, except seeking.
+ */
+class udp_reader
+{
+public:
+    /**
+     * Bind to the port, terminates the program if the socket cannot be bound.
+     *
+     * @param port local port, 0 - any free port, see `port()`
+     * @param options reader options
+     */
+    explicit udp_reader(uint16_t port, udp_options options = {})
+        : opts{options},
+          sock{detail::open_socket(options.address, port, SOCK_DGRAM, true)},
+          slot_words{(std::max<std::size_t>(options.max_datagram, sizeof(uint64_t)) + sizeof(uint64_t) - 1) /
+                     sizeof(uint64_t)},
+          buffer(slot_words * std::max<std::size_t>(options.batch_size, 1)),
+          iovs(std::max<std::size_t>(options.batch_size, 1)),
+          msgs(iovs.size())
+    {
+        if (sock.get() < 0) { abort(); }
+
+        if (opts.receive_buffer != 0)
+        {
+            auto size = static_cast<int>(std::min<std::size_t>(opts.receive_buffer, INT32_MAX));
+            setsockopt(sock.get(), SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        }
+
+        for (std::size_t idx = 0; idx < iovs.size(); ++idx)
+        {
+            iovs[idx].iov_base = buffer.data() + idx * slot_words;
+            iovs[idx].iov_len = slot_words * sizeof(uint64_t);
+            msgs[idx].msg_hdr.msg_iov = &iovs[idx];
+            msgs[idx].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    /**
+     * @return local port of the socket
+     */
+    auto port() const -> uint16_t { return detail::local_port(sock.get()); }
+
+    /**
+     * @return statistics of the received datagrams, to be called from the reading thread
+     */
+    auto stats() const -> const socket_stats& { return counts; }
+
+    /**
+     * Read the next data word, without throwing.
+     *
+     * @param word 64-bit word
+     * @return `ok` or `end_of_data`
+     */
+    auto try_read_word(uint64_t& word) -> DECODE_STATUS
+    {
+        if (pos == current.size() and !next_datagram()) { return DECODE_STATUS::end_of_data; }
+
+        word = current[pos++];
+        return DECODE_STATUS::ok;
+    }
+
+    /**
+     * Read the next data word.
+     *
+     * End of stream is marked by `std::out_of_range` exception.
+     *
+     * @return 64-bit word
+     */
+    auto read_word() -> uint64_t
+    {
+        uint64_t word{0};
+        if (try_read_word(word) != DECODE_STATUS::ok) { throw std::out_of_range("END OF DATA"); }
+
+        return word;
+    }
+
+    /**
+     * Read up to `n` next data words.
+     *
+     * @param dst destination buffer, must hold at least `n` words
+     * @param n number of words to read
+     * @return number of words read, smaller than `n` only at the end of stream
+     */
+    auto read_words(uint64_t* dst, std::size_t n) -> std::size_t
+    {
+        std::size_t copied{0};
+
+        while (copied != n)
+        {
+            if (pos == current.size() and !next_datagram()) { break; }
+
+            auto count = std::min(n - copied, current.size() - pos);
+            std::copy(current.data() + pos, current.data() + pos + count, dst + copied);
+            pos += count;
+            copied += count;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Return the data words of the current datagram which were not consumed yet, the next datagram is received if
+     * necessary. The view is valid until the next read call.
+     *
+     * @return view of the data words, empty at the end of stream
+     */
+    auto read_block() -> span<const uint64_t>
+    {
+        if (pos == current.size() and !next_datagram()) { return {}; }
+
+        auto block = span<const uint64_t>(current.data() + pos, current.size() - pos);
+        pos = current.size();
+        return block;
+    }
+
+private:
+    /**
+     * Receive the next batch of datagrams.
+     *
+     * @return false at the end of stream
+     */
+    auto receive() -> bool
+    {
+        next_msg = n_received = 0;
+        while (!finished)
+        {
+            pollfd pfd{sock.get(), POLLIN, 0};
+            auto ready = poll(&pfd, 1, opts.timeout_ms);
+            if (ready == 0 or (ready < 0 and errno != EINTR)) { finished = true; }
+            if (ready <= 0) { continue; }
+
+            auto res = recvmmsg(sock.get(), msgs.data(), static_cast<unsigned>(msgs.size()), MSG_DONTWAIT, nullptr);
+            if (res > 0)
+            {
+                n_received = static_cast<std::size_t>(res);
+                return true;
+            }
+            if (res < 0 and errno != EINTR and errno != EAGAIN and errno != EWOULDBLOCK) { finished = true; }
+        }
+
+        return false;
+    }
+
+    /**
+     * Check the sequence number of the datagram.
+     */
+    auto check_sequence(uint64_t seq) -> void
+    {
+        if (!has_sequence or seq == next_seq)
+        {
+            next_seq = seq + 1;
+        }
+        else if (seq > next_seq)
+        {
+            counts.lost_packets += seq - next_seq;
+            next_seq = seq + 1;
+        }
+        else
+        {
+            ++counts.reordered_packets;
+            if (counts.lost_packets != 0) { --counts.lost_packets; }
+        }
+        has_sequence = true;
+    }
+
+    /**
+     * Move to the next datagram with data words.
+     *
+     * @return false at the end of stream
+     */
+    auto next_datagram() -> bool
+    {
+        const std::size_t header_words{opts.sequence_header ? 1U : 0U};
+
+        while (!finished)
+        {
+            if (next_msg == n_received and !receive()) { return false; }
+
+            const auto idx = next_msg++;
+            const auto* slot = buffer.data() + idx * slot_words;
+            const std::size_t length = msgs[idx].msg_len;
+
+            ++counts.packets;
+            counts.bytes += length;
+
+            if (length % sizeof(uint64_t) != 0 or length < header_words * sizeof(uint64_t) or
+                (msgs[idx].msg_hdr.msg_flags & MSG_TRUNC) != 0)
+            {
+                ++counts.malformed_packets;
+                if (length < header_words * sizeof(uint64_t)) { continue; }
+            }
+
+            if (header_words != 0) { check_sequence(slot[0]); }
+
+            const auto n_words = length / sizeof(uint64_t) - header_words;
+            if (n_words == 0)
+            {
+                finished = true;
+                break;
+            }
+
+            current = span<const uint64_t>(slot + header_words, n_words);
+            pos = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    udp_options opts;             ///< reader options
+    detail::socket_handle sock;   ///< bound socket
+    std::size_t slot_words;       ///< size of the buffer of a single datagram in words
+    std::vector<uint64_t> buffer; ///< buffers of the datagrams
+    std::vector<iovec> iovs;      ///< buffer of each datagram
+    std::vector<mmsghdr> msgs;    ///< headers of the received datagrams
+    std::size_t n_received{0};    ///< number of datagrams in the last batch
+    std::size_t next_msg{0};      ///< index of the next datagram of the batch
+    span<const uint64_t> current; ///< data words of the current datagram
+    std::size_t pos{0};           ///< index of the next word of the current datagram
+    uint64_t next_seq{0};         ///< expected sequence number
+    bool has_sequence{false};     ///< whether any sequence number was received
+    bool finished{false};         ///< whether the stream ended
+    socket_stats counts;          ///< statistics of the datagrams
+};
+
+/**
+ * Sends the data words in UDP datagrams in the format expected by `udp_reader`, e.g. to replay recorded data or for
+ * testing.
+ */
+class udp_sender
+{
+public:
+    /**
+     * Connect to the receiver, terminates the program if the socket cannot be created.
+     *
+     * @param host receiver host name or address
+     * @param port receiver port
+     * @param max_datagram maximal size of the datagram in bytes
+     * @param sequence_header whether to prepend the datagrams with the sequence number
+     */
+    udp_sender(const char* host, uint16_t port, std::size_t max_datagram = 8192, bool sequence_header = true)
+        : sock{detail::open_socket(host, port, SOCK_DGRAM, false)},
+          words_per_datagram{std::max<std::size_t>(max_datagram / sizeof(uint64_t), 2) - (sequence_header ? 1 : 0)},
+          with_header{sequence_header}
+    {
+        if (sock.get() < 0) { abort(); }
+    }
+
+    /**
+     * Send the words split into datagrams.
+     *
+     * @param words data words
+     * @return false on send error
+     */
+    auto send(span<const uint64_t> words) -> bool
+    {
+        for (std::size_t offset = 0; offset < words.size(); offset += words_per_datagram)
+        {
+            auto count = std::min(words_per_datagram, words.size() - offset);
+            if (!send_datagram(next_seq++, span<const uint64_t>(words.data() + offset, count))) { return false; }
+        }
+
+        return true;
+    }
+
+    /**
+     * Send single datagram with given sequence number, the sequence numbers of `send()` are not affected.
+     *
+     * @param seq sequence number
+     * @param words data words, at most the datagram size
+     * @return false on send error
+     */
+    auto send_datagram(uint64_t seq, span<const uint64_t> words) -> bool
+    {
+        iovec iov[2]{{&seq, sizeof(seq)},
+                     {const_cast<uint64_t*>(words.data()), words.size() * sizeof(uint64_t)}};
+        msghdr msg{};
+        msg.msg_iov = with_header ? iov : iov + 1;
+        msg.msg_iovlen = with_header ? 2 : 1;
+
+        return sendmsg(sock.get(), &msg, 0) >= 0;
+    }
+
+    /**
+     * Send the datagram without data words, which ends the stream of `udp_reader`.
+     *
+     * @return false on send error
+     */
+    auto finish() -> bool { return send_datagram(next_seq++, {}); }
+
+private:
+    detail::socket_handle sock;     ///< connected socket
+    std::size_t words_per_datagram; ///< maximal number of data words in a datagram
+    bool with_header;               ///< whether to prepend the sequence number
+    uint64_t next_seq{0};           ///< sequence number of the next datagram
+};
+
+/**
+ * Receives the data words from TCP stream.
+ *
+ * The stream is received in large blocks into an internal buffer, from which the data words are served, the same way
+ * as by `file_reader`. The words split between two receive calls are joined. Provides the same interface as
+ * `file_reader`, except seeking.
+ */
+class tcp_reader
+{
+public:
+    static constexpr std::size_t default_block_size{4UL * 1024UL * 1024UL}; ///< default block size in bytes
+
+    /**
+     * Connect to the sender, terminates the program if the connection fails.
+     *
+     * @param host sender host name or address
+     * @param port sender port
+     * @param block_size size of the receive block in bytes, rounded down to the full words
+     */
+    tcp_reader(const char* host, uint16_t port, std::size_t block_size = default_block_size)
+        : tcp_reader{detail::open_socket(host, port, SOCK_STREAM, false), block_size}
+    {
+    }
+
+    /**
+     * Take the connected socket, e.g. accepted from the listening socket.
+     *
+     * @param socket_fd connected socket, closed by the reader
+     * @param block_size size of the receive block in bytes, rounded down to the full words
+     */
+    explicit tcp_reader(int socket_fd, std::size_t block_size = default_block_size)
+        : tcp_reader{detail::socket_handle{socket_fd}, block_size}
+    {
+    }
+
+    /**
+     * @return statistics of the received data, to be called from the reading thread
+     */
+    auto stats() const -> const socket_stats& { return counts; }
+
+    /**
+     * Read the next data word, without throwing.
+     *
+     * @param word 64-bit word
+     * @return `ok` or `end_of_data`
+     */
+    auto try_read_word(uint64_t& word) -> DECODE_STATUS
+    {
+        if (head == tail and !refill()) { return DECODE_STATUS::end_of_data; }
+
+        word = buffer[head++];
+        return DECODE_STATUS::ok;
+    }
+
+    /**
+     * Read the next data word.
+     *
+     * End of stream is marked by `std::out_of_range` exception.
+     *
+     * @return 64-bit word
+     */
+    auto read_word() -> uint64_t
+    {
+        uint64_t word{0};
+        if (try_read_word(word) != DECODE_STATUS::ok) { throw std::out_of_range("END OF DATA"); }
+
+        return word;
+    }
+
+    /**
+     * Read up to `n` next data words.
+     *
+     * @param dst destination buffer, must hold at least `n` words
+     * @param n number of words to read
+     * @return number of words read, smaller than `n` only at the end of stream
+     */
+    auto read_words(uint64_t* dst, std::size_t n) -> std::size_t
+    {
+        std::size_t copied{0};
+
+        while (copied != n)
+        {
+            if (head == tail and !refill()) { break; }
+
+            auto count = std::min(n - copied, tail - head);
+            std::copy(buffer.data() + head, buffer.data() + head + count, dst + copied);
+            head += count;
+            copied += count;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Return all buffered data words which were not consumed yet, the next block is received if necessary. The view
+     * is valid until the next read call.
+     *
+     * @return view of the data words, empty at the end of stream
+     */
+    auto read_block() -> span<const uint64_t>
+    {
+        if (head == tail and !refill()) { return {}; }
+
+        auto block = span<const uint64_t>(buffer.data() + head, tail - head);
+        head = tail;
+        return block;
+    }
+
+private:
+    tcp_reader(detail::socket_handle socket, std::size_t block_size)
+        : sock{std::move(socket)}, buffer(std::max<std::size_t>(block_size / sizeof(uint64_t), 2))
+    {
+        if (sock.get() < 0) { abort(); }
+
+        auto size = static_cast<int>(std::min<std::size_t>(block_size, INT32_MAX));
+        setsockopt(sock.get(), SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+
+    /**
+     * Receive the next block of data, waits until at least one full word is available. The partial word from the
+     * previous block is kept.
+     *
+     * @return true if any word was received
+     */
+    auto refill() -> bool
+    {
+        auto* bytes = reinterpret_cast<char*>(buffer.data());
+        std::memmove(bytes, bytes + tail * sizeof(uint64_t), partial);
+        head = tail = 0;
+
+        const auto capacity = buffer.size() * sizeof(uint64_t);
+        while (!finished and partial < sizeof(uint64_t))
+        {
+            auto res = recv(sock.get(), bytes + partial, capacity - partial, 0);
+            if (res > 0)
+            {
+                ++counts.packets;
+                counts.bytes += static_cast<uint64_t>(res);
+                partial += static_cast<std::size_t>(res);
+            }
+            else if (res == 0 or errno != EINTR)
+            {
+                finished = true;
+                if (partial != 0) { ++counts.malformed_packets; }
+            }
+        }
+
+        tail = partial / sizeof(uint64_t);
+        partial %= sizeof(uint64_t);
+        return tail != 0;
+    }
+
+    detail::socket_handle sock;   ///< connected socket
+    std::vector<uint64_t> buffer; ///< block buffer
+    std::size_t head{0};          ///< index of the next word to be consumed
+    std::size_t tail{0};          ///< number of full words in the buffer
+    std::size_t partial{0};       ///< number of bytes of the partial word following the full words
+    bool finished{false};         ///< whether the stream ended
+    socket_stats counts;          ///< statistics of the received data
+};
+
+} // namespace geri
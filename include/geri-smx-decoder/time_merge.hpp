@@ -0,0 +1,263 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file time_merge.hpp
+ * @brief Time ordering of the frame hits and grouping in coincidence windows
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace geri
+{
+
+/**
+ * Options of the time_merger.
+ */
+struct time_merge_options
+{
+    uint64_t system_ts_scale{1}; ///< hit clock ticks per unit of the frame system timestamp
+    int64_t system_ts_offset{0}; ///< hit clock ticks added to the scaled system timestamp
+};
+
+/**
+ * Hit with the extended timestamp.
+ */
+struct timed_hit
+{
+    uint64_t time{0};  ///< extended hit timestamp, in the hit clock ticks
+    uint32_t index{0}; ///< index of the hit in the frame
+};
+
+/**
+ * Orders the hits of the frame by time with k-way merge of the per-uplink sequences.
+ *
+ * The 14-bit `full_ts` of the hit wraps around, so it is first extended to 64 bits. The first hit of each uplink is
+ * placed at the timestamp nearest to the frame reference time, the scaled `system_ts` (see `time_merge_options`), and
+ * every next hit of the uplink at the timestamp nearest to the previous one, so the wrap-around within the frame is
+ * followed. The hits of the uplink come in time order, thus the frame is split into the runs of the non-decreasing
+ * times of single uplink, and the neighbouring runs are merged pairwise in O(n log k), instead of sorting all hits. A
+ * hit out of order only starts a new run, so the result is ordered for any input. The hits of equal times keep the
+ * stream order.
+ * ```c++
+ * geri::time_merger merger;
+ * for (const auto& thit : merger.merge(frame)) { frame.hits[thit.index] ... }
+ * ```
+ */
+class time_merger
+{
+public:
+    static constexpr uint64_t ts_period{1U << 14}; ///< period of the hit full timestamp
+
+    /**
+     * @param options merging options
+     */
+    explicit time_merger(time_merge_options options = {}) : opts{options} {}
+
+    /**
+     * Order the hits of the frame. The result is valid until the next merge.
+     *
+     * @param frame the frame
+     * @return the hits in time order
+     */
+    template <typename Allocator> auto merge(const basic_payload_frame<Allocator>& frame) -> span<const timed_hit>
+    {
+        start(frame.system_ts, frame.hits.size());
+        for (const auto& hit : frame.hits)
+        {
+            add(hit.unique_addr, hit.full_ts);
+        }
+        return finish();
+    }
+
+    /**
+     * Order the hits of the frame. The result is valid until the next merge.
+     *
+     * @param frame the frame
+     * @return the hits in time order
+     */
+    auto merge(const columnar_frame& frame) -> span<const timed_hit>
+    {
+        start(frame.system_ts, frame.size());
+        for (std::size_t idx = 0; idx < frame.size(); ++idx)
+        {
+            add(frame.addr()[idx], frame.full_ts()[idx]);
+        }
+        return finish();
+    }
+
+    /// @return number of the monotonic runs in the last merged frame
+    auto runs() const -> std::size_t { return n_runs; }
+
+private:
+    /**
+     * Extended timestamp congruent to `full_ts` modulo the period, nearest to the reference.
+     */
+    static auto extend(uint64_t reference, uint16_t full_ts) -> uint64_t
+    {
+        const auto diff = (uint64_t{full_ts} - reference) & (ts_period - 1);
+        // earlier timestamp, unless it would be negative
+        if (diff >= ts_period / 2 and reference + diff >= ts_period) { return reference + diff - ts_period; }
+
+        return reference + diff;
+    }
+
+    auto start(uint64_t system_ts, std::size_t n_hits) -> void
+    {
+        reference = system_ts * opts.system_ts_scale + static_cast<uint64_t>(opts.system_ts_offset);
+        if (++generation == 0)
+        {
+            seen.fill(0);
+            generation = 1;
+        }
+        input.clear();
+        input.reserve(n_hits);
+        run_ends.clear();
+        last_addr = -1;
+    }
+
+    auto add(uint8_t addr, uint16_t full_ts) -> void
+    {
+        const auto time = extend(seen[addr] == generation ? last_time[addr] : reference, full_ts);
+
+        // new run at the uplink change or time going back
+        if (addr != last_addr or time < input.back().time) { run_ends.push_back(input.size()); }
+        run_ends.back() = input.size() + 1;
+
+        input.push_back({time, static_cast<uint32_t>(input.size())});
+        last_time[addr] = time;
+        seen[addr] = generation;
+        last_addr = addr;
+    }
+
+    auto finish() -> span<const timed_hit>
+    {
+        n_runs = run_ends.size();
+        if (run_ends.size() <= 1) { return {input.data(), input.size()}; }
+
+        // pairwise merging of the neighbouring runs, log2(k) passes over the hits
+        output.resize(input.size());
+        auto* src = &input;
+        auto* dst = &output;
+        const auto earlier = [](const timed_hit& lhs, const timed_hit& rhs) { return lhs.time < rhs.time; };
+
+        while (run_ends.size() > 1)
+        {
+            std::size_t begin{0};
+            std::size_t merged{0};
+            for (std::size_t idx = 0; idx < run_ends.size(); idx += 2)
+            {
+                const auto mid = run_ends[idx];
+                const auto end = idx + 1 < run_ends.size() ? run_ends[idx + 1] : mid;
+
+                // hits of the earlier run first at equal times, so the stream order is kept
+                std::merge(src->begin() + static_cast<std::ptrdiff_t>(begin),
+                           src->begin() + static_cast<std::ptrdiff_t>(mid),
+                           src->begin() + static_cast<std::ptrdiff_t>(mid),
+                           src->begin() + static_cast<std::ptrdiff_t>(end),
+                           dst->begin() + static_cast<std::ptrdiff_t>(begin), earlier);
+
+                run_ends[merged++] = end;
+                begin = end;
+            }
+
+            run_ends.resize(merged);
+            std::swap(src, dst);
+        }
+
+        return {src->data(), src->size()};
+    }
+
+    time_merge_options opts;               ///< merging options
+    uint64_t reference{0};                 ///< reference time of the frame
+    std::array<uint64_t, 256> last_time{}; ///< time of the last hit of each uplink
+    std::array<uint32_t, 256> seen{};      ///< generation of the last frame with hit of the uplink
+    uint32_t generation{0};                ///< generation of the merged frame
+    int last_addr{-1};                     ///< uplink of the last hit
+    std::vector<timed_hit> input;          ///< hits in the stream order
+    std::vector<std::size_t> run_ends;     ///< ends of the runs in the input
+    std::size_t n_runs{0};                 ///< number of the runs in the last frame
+    std::vector<timed_hit> output;         ///< buffer of the merging passes
+};
+
+/**
+ * Mode of the coincidence window.
+ */
+enum class WINDOW_MODE : std::uint8_t
+{
+    sliding, ///< hits closer than the window to the previous hit of the group
+    fixed,   ///< hits closer than the window to the first hit of the group
+};
+
+/**
+ * Options of the time_clusterer.
+ */
+struct time_cluster_options
+{
+    uint64_t window{16};                    ///< coincidence window in the hit clock ticks, inclusive
+    WINDOW_MODE mode{WINDOW_MODE::sliding}; ///< window mode
+    std::size_t min_hits{1};                ///< smaller groups are dropped
+};
+
+/**
+ * Groups the time-ordered hits in coincidence windows.
+ * ```c++
+ * geri::time_cluster_options options;
+ * options.window = 8;
+ * geri::time_clusterer clusterer(options);
+ * clusterer.cluster(merger.merge(frame), [&](geri::span<const geri::timed_hit> group) { ... });
+ * ```
+ */
+class time_clusterer
+{
+public:
+    /**
+     * @param options clustering options
+     */
+    explicit time_clusterer(time_cluster_options options = {}) : opts{options} {}
+
+    /**
+     * Pass the groups of the hits to the consumer, called as `consumer(span<const timed_hit>)`.
+     *
+     * @param hits hits in time order
+     * @param consumer groups consumer
+     * @return number of passed groups
+     */
+    template <typename Consumer> auto cluster(span<const timed_hit> hits, Consumer&& consumer) const -> std::size_t
+    {
+        std::size_t n_groups{0};
+        std::size_t first{0};
+
+        for (std::size_t idx = 1; idx <= hits.size(); ++idx)
+        {
+            if (idx != hits.size())
+            {
+                const auto anchor = opts.mode == WINDOW_MODE::sliding ? hits[idx - 1].time : hits[first].time;
+                if (hits[idx].time - anchor <= opts.window) { continue; }
+            }
+
+            if (idx - first >= opts.min_hits)
+            {
+                consumer(span<const timed_hit>(hits.data() + first, idx - first));
+                ++n_groups;
+            }
+            first = idx;
+        }
+
+        return n_groups;
+    }
+
+private:
+    time_cluster_options opts; ///< clustering options
+};
+
+} // namespace geri
@@ -0,0 +1,635 @@
+/* Copyright (C) 2025-2026 Jagiellonian University, Kraków, Poland
+   SPDX-License-Identifier: LGPL-3.0-or-later
+   Authors: Rafał Lalik [committer] */
+
+/**
+ * @file uring_reader.hpp
+ * @brief File reader with asynchronous read-ahead using Linux io_uring
+ */
+
+#pragma once
+
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define GERI_SMX_DECODER_IO_URING
+#endif
+#endif
+
+namespace geri
+{
+
+/**
+ * Options of the uring_reader.
+ */
+struct uring_options
+{
+    std::size_t block_size{4UL * 1024UL * 1024UL}; ///< size of a single read in bytes, rounded up to 4 KiB
+    unsigned queue_depth{8};                       ///< number of reads in flight
+    bool direct_io{false};                         ///< bypass the page cache with `O_DIRECT`, if supported
+    bool register_buffers{true};                   ///< register the buffers with the ring, if allowed
+};
+
+namespace detail
+{
+#ifdef GERI_SMX_DECODER_IO_URING
+/**
+ * Minimal io_uring instance, submission and completion of the read requests with raw system calls.
+ */
+class uring
+{
+public:
+    explicit uring(unsigned entries)
+    {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) { return; }
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) { sq_size = cq_size = std::max(sq_size, cq_size); }
+
+        sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cq_ptr = (params.features & IORING_FEAT_SINGLE_MMAP) != 0
+                     ? sq_ptr
+                     : mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                            IORING_OFF_CQ_RING);
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        auto* sqes_ptr =
+            mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+        if (sq_ptr == MAP_FAILED or cq_ptr == MAP_FAILED or sqes_ptr == MAP_FAILED)
+        {
+            if (sqes_ptr != MAP_FAILED) { munmap(sqes_ptr, sqes_size); }
+            release();
+            return;
+        }
+
+        auto* sq_bytes = static_cast<char*>(sq_ptr);
+        sq_head = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.array);
+        sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+        auto* cq_bytes = static_cast<char*>(cq_ptr);
+        cq_head = reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq_bytes + params.cq_off.cqes);
+    }
+
+    uring(const uring&) = delete;
+    auto operator=(const uring&) -> uring& = delete;
+
+    ~uring()
+    {
+        if (sqes != nullptr) { munmap(sqes, sqes_size); }
+        release();
+    }
+
+    /**
+     * @return whether the ring was set up
+     */
+    auto valid() const -> bool { return sqes != nullptr; }
+
+    /**
+     * Register the buffers for the fixed reads.
+     *
+     * @return false if the registration failed, e.g. due to locked memory limit
+     */
+    auto register_buffers(const std::vector<iovec>& iovs) -> bool
+    {
+        return syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iovs.data(), iovs.size()) == 0;
+    }
+
+    /**
+     * Queue and submit the read request.
+     *
+     * The entry is withdrawn from the ring if the kernel did not take it, so the caller can read the buffer otherwise
+     * without a stray read in flight. The kernel takes the entries only in `io_uring_enter()` of this thread, as the
+     * ring is not polled.
+     *
+     * @param file_fd file to read from
+     * @param iov destination buffer
+     * @param offset offset in the file
+     * @param buf_index index of the registered buffer, -1 - not registered
+     * @param user_data identifier of the request
+     * @return false if the request was not submitted
+     */
+    auto submit_read(int file_fd, const iovec& iov, uint64_t offset, int buf_index, uint64_t user_data) -> bool
+    {
+        const auto tail = *sq_tail;
+        const auto idx = tail & sq_mask;
+
+        auto& sqe = sqes[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.fd = file_fd;
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        if (buf_index >= 0)
+        {
+            sqe.opcode = IORING_OP_READ_FIXED;
+            sqe.addr = reinterpret_cast<uint64_t>(iov.iov_base);
+            sqe.len = static_cast<uint32_t>(iov.iov_len);
+            sqe.buf_index = static_cast<uint16_t>(buf_index);
+        }
+        else
+        {
+            sqe.opcode = IORING_OP_READV;
+            sqe.addr = reinterpret_cast<uint64_t>(&iov);
+            sqe.len = 1;
+        }
+
+        sq_array[idx] = idx;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        while (true)
+        {
+            auto res = syscall(__NR_io_uring_enter, fd, 1, 0, 0, nullptr, 0);
+            if (res == 1) { return true; }
+            if (res < 0 and (errno == EINTR or errno == EAGAIN or errno == EBUSY)) { continue; }
+
+            // not submitted, withdraw the entry unless it was taken anyway
+            if (__atomic_load_n(sq_head, __ATOMIC_ACQUIRE) != tail) { return true; }
+            __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+            return false;
+        }
+    }
+
+    /**
+     * Wait for the next completion.
+     *
+     * @param user_data identifier of the completed request
+     * @param result result of the request, number of bytes read or negative error
+     * @return false on error of the ring
+     */
+    auto wait_completion(uint64_t& user_data, int& result) -> bool
+    {
+        while (true)
+        {
+            const auto head = *cq_head;
+            if (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+            {
+                const auto& cqe = cqes[head & cq_mask];
+                user_data = cqe.user_data;
+                result = cqe.res;
+                __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+
+            auto res = syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (res < 0 and errno != EINTR) { return false; }
+        }
+    }
+
+private:
+    auto release() -> void
+    {
+        if (cq_ptr != MAP_FAILED and cq_ptr != nullptr and cq_ptr != sq_ptr) { munmap(cq_ptr, cq_size); }
+        if (sq_ptr != MAP_FAILED and sq_ptr != nullptr) { munmap(sq_ptr, sq_size); }
+        if (fd >= 0) { close(fd); }
+        fd = -1;
+        sqes = nullptr;
+    }
+
+    int fd{-1};                  ///< ring file descriptor
+    void* sq_ptr{nullptr};       ///< submission ring mapping
+    void* cq_ptr{nullptr};       ///< completion ring mapping
+    std::size_t sq_size{0};      ///< size of the submission ring mapping
+    std::size_t cq_size{0};      ///< size of the completion ring mapping
+    std::size_t sqes_size{0};    ///< size of the submission entries mapping
+    unsigned* sq_head{nullptr};  ///< submission ring head
+    unsigned* sq_tail{nullptr};  ///< submission ring tail
+    unsigned* sq_array{nullptr}; ///< submission ring indices
+    unsigned sq_mask{0};         ///< submission ring mask
+    io_uring_sqe* sqes{nullptr}; ///< submission entries
+    unsigned* cq_head{nullptr};  ///< completion ring head
+    unsigned* cq_tail{nullptr};  ///< completion ring tail
+    unsigned cq_mask{0};         ///< completion ring mask
+    io_uring_cqe* cqes{nullptr}; ///< completion entries
+};
+#endif
+} // namespace detail
+
+/**
+ * Reads the file with several large reads in flight, submitted asynchronously with Linux io_uring.
+ *
+ * The file is read in blocks (see `uring_options::block_size`) into a ring of buffers. While the decoder consumes one
+ * block, the following blocks are read by the kernel, so the device is kept busy at the given queue depth. The
+ * buffers are optionally registered with the ring and the file opened with `O_DIRECT`. When io_uring is not available
+ * (older kernel, seccomp, non-Linux system), the blocks are read synchronously with `pread()`. Provides the same
+ * interface as `file_reader`, `read_block()` returns the view of the buffered block without copying. The buffers of the
+ * files smaller than all the blocks are allocated only for the file size.
+ *
+ * Interrupted reads are retried. The data end at a read error, the data read before are delivered and `error()` is set.
+ */
+class uring_reader
+{
+public:
+    /**
+     * Open the file, terminates the program if the file cannot be opened.
+     *
+     * @param filename file to read from
+     * @param options reader options
+     */
+    explicit uring_reader(const char* filename, uring_options options = {})
+        : fd{open_file(filename, options.direct_io)},
+          buffered_fd{open_buffered(filename, fd)},
+          block_bytes{std::min(round_up(std::max<std::size_t>(options.block_size, 1)), file_limit(fd))},
+          slots(std::min<std::size_t>(std::max(options.queue_depth, 1U), blocks_count(file_limit(fd), block_bytes)))
+#ifdef GERI_SMX_DECODER_IO_URING
+          ,
+          ring{static_cast<unsigned>(slots.size())}
+#endif
+    {
+        memory = static_cast<uint64_t*>(mmap(nullptr, block_bytes * slots.size(), PROT_READ | PROT_WRITE,
+                                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (memory == MAP_FAILED) { abort(); }
+
+        std::vector<iovec> iovs(slots.size());
+        for (std::size_t idx = 0; idx < slots.size(); ++idx)
+        {
+            slots[idx].iov = {memory + idx * block_bytes / sizeof(uint64_t), block_bytes};
+            iovs[idx] = slots[idx].iov;
+        }
+
+#ifdef GERI_SMX_DECODER_IO_URING
+        fixed_buffers = ring.valid() and options.register_buffers and ring.register_buffers(iovs);
+#endif
+        start(0);
+    }
+
+    uring_reader(const uring_reader&) = delete;
+    auto operator=(const uring_reader&) -> uring_reader& = delete;
+
+    ~uring_reader()
+    {
+        drain();
+        munmap(memory, block_bytes * slots.size());
+        if (buffered_fd != fd) { close(buffered_fd); }
+        close(fd);
+    }
+
+    /**
+     * @return whether the reads are submitted with io_uring
+     */
+    auto uses_uring() const -> bool
+    {
+#ifdef GERI_SMX_DECODER_IO_URING
+        return ring.valid();
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @return whether the buffers are registered with the ring
+     */
+    auto uses_fixed_buffers() const -> bool { return fixed_buffers; }
+
+    /**
+     * @return whether the reading stopped at an I/O error
+     */
+    auto error() const -> bool { return failed; }
+
+    /**
+     * Read the next data word from the file, without throwing.
+     *
+     * @param word 64-bit word
+     * @return `ok` or `end_of_data`
+     */
+    auto try_read_word(uint64_t& word) -> DECODE_STATUS
+    {
+        if (head == tail and !next_block()) { return DECODE_STATUS::end_of_data; }
+
+        word = current[head++];
+        return DECODE_STATUS::ok;
+    }
+
+    /**
+     * Read the next data word from the file.
+     *
+     * EOF is marked by `std::out_of_range` exception.
+     *
+     * @return 64-bit word
+     */
+    auto read_word() -> uint64_t
+    {
+        uint64_t word{0};
+        if (try_read_word(word) != DECODE_STATUS::ok) { throw std::out_of_range("END OF DATA"); }
+
+        return word;
+    }
+
+    /**
+     * Read up to `n` next data words.
+     *
+     * @param dst destination buffer, must hold at least `n` words
+     * @param n number of words to read
+     * @return number of words read, smaller than `n` only at the end of file
+     */
+    auto read_words(uint64_t* dst, std::size_t n) -> std::size_t
+    {
+        std::size_t copied{0};
+
+        while (copied != n)
+        {
+            if (head == tail and !next_block()) { break; }
+
+            auto count = std::min(n - copied, tail - head);
+            std::copy(current + head, current + head + count, dst + copied);
+            head += count;
+            copied += count;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Return the data words of the current block which were not consumed yet, the next block is taken if necessary.
+     * The view is valid until the next read call.
+     *
+     * @return view of the data words, empty at the end of file
+     */
+    auto read_block() -> span<const uint64_t>
+    {
+        if (head == tail and !next_block()) { return {}; }
+
+        auto block = span<const uint64_t>(current + head, tail - head);
+        head = tail;
+        return block;
+    }
+
+    /**
+     * Move to the position in the file. The reads in flight are completed and discarded.
+     *
+     * @param offset position in bytes from the beginning of the file, should be aligned to the full words
+     * @return false if the position cannot be set
+     */
+    auto seek(uint64_t offset) -> bool
+    {
+        if (offset % sizeof(uint64_t) != 0) { return false; }
+
+        drain();
+        start(offset);
+        return true;
+    }
+
+private:
+    static constexpr std::size_t alignment{4096}; ///< alignment of the reads required by `O_DIRECT`
+
+    enum class SLOT_STATE : std::uint8_t
+    {
+        idle,
+        pending,
+        ready
+    };
+
+    struct slot
+    {
+        iovec iov{};                        ///< buffer of the block
+        uint64_t block{0};                  ///< index of the block read into the buffer
+        std::size_t length{0};              ///< number of bytes read
+        SLOT_STATE state{SLOT_STATE::idle}; ///< state of the read
+    };
+
+    static auto round_up(std::size_t size) -> std::size_t { return (size + alignment - 1) / alignment * alignment; }
+
+    /**
+     * Open the file, terminates the program if the file cannot be opened.
+     */
+    static auto open_file(const char* filename, bool direct_io) -> int
+    {
+        int file_fd{-1};
+        if (direct_io) { file_fd = open(filename, O_RDONLY | O_CLOEXEC | O_DIRECT); }
+        if (file_fd < 0) { file_fd = open(filename, O_RDONLY | O_CLOEXEC); }
+        if (file_fd < 0) { abort(); }
+
+        return file_fd;
+    }
+
+    /**
+     * Open the file for the reads not aligned for `O_DIRECT`, the same descriptor is used if it is buffered.
+     */
+    static auto open_buffered(const char* filename, int file_fd) -> int
+    {
+        if ((fcntl(file_fd, F_GETFL) & O_DIRECT) == 0) { return file_fd; }
+
+        auto buffered = open(filename, O_RDONLY | O_CLOEXEC);
+        if (buffered < 0) { abort(); }
+
+        return buffered;
+    }
+
+    /**
+     * Total size of the buffers needed for the whole file, so the small files do not allocate all blocks.
+     */
+    static auto file_limit(int file_fd) -> std::size_t
+    {
+        struct stat file_stat{};
+        if (fstat(file_fd, &file_stat) != 0 or !S_ISREG(file_stat.st_mode)) { return SIZE_MAX; }
+
+        return round_up(std::max<std::size_t>(static_cast<std::size_t>(file_stat.st_size), 1));
+    }
+
+    static auto blocks_count(std::size_t size, std::size_t block) -> std::size_t
+    { return size / block + (size % block != 0 ? 1 : 0); }
+
+    /**
+     * Start reading from the offset.
+     */
+    auto start(uint64_t offset) -> void
+    {
+        origin = offset / alignment * alignment;
+        skip_words = static_cast<std::size_t>(offset - origin) / sizeof(uint64_t);
+        next_block_no = 0;
+        end_block = UINT64_MAX;
+        has_current = false;
+        current = nullptr;
+        head = tail = 0;
+        failed = false;
+
+        for (uint64_t block = 0; block < slots.size(); ++block)
+        {
+            submit(block);
+        }
+    }
+
+    /**
+     * Submit the read of the block into its slot.
+     */
+    auto submit(uint64_t block) -> void
+    {
+        auto& blk_slot = slots[block % slots.size()];
+        blk_slot.block = block;
+        blk_slot.length = 0;
+        blk_slot.state = SLOT_STATE::pending;
+
+#ifdef GERI_SMX_DECODER_IO_URING
+        if (ring.valid())
+        {
+            const auto buf_index = fixed_buffers ? static_cast<int>(block % slots.size()) : -1;
+            if (ring.submit_read(fd, blk_slot.iov, block_offset(block), buf_index, block)) { return; }
+        }
+#endif
+        complete(blk_slot, read_rest(fd, blk_slot));
+    }
+
+    /**
+     * Read the rest of the slot synchronously.
+     *
+     * @return number of bytes read or negative error, as the completion of the ring
+     */
+    auto read_rest(int file_fd, const slot& blk_slot) const -> ssize_t
+    {
+        auto res = pread(file_fd, static_cast<char*>(blk_slot.iov.iov_base) + blk_slot.length,
+                         blk_slot.iov.iov_len - blk_slot.length,
+                         static_cast<off_t>(block_offset(blk_slot.block) + blk_slot.length));
+        return res < 0 ? -errno : res;
+    }
+
+    auto block_offset(uint64_t block) const -> uint64_t { return origin + block * block_bytes; }
+
+    /**
+     * Finish the read of the slot. Short or interrupted read is completed synchronously, as the reads end only at the
+     * end of file. The rest is read buffered, its offset is not aligned for `O_DIRECT`.
+     *
+     * @param blk_slot the slot
+     * @param result number of bytes read or negative error
+     */
+    auto complete(slot& blk_slot, ssize_t result) -> void
+    {
+        blk_slot.state = SLOT_STATE::ready;
+        blk_slot.length = 0;
+
+        while (result != 0)
+        {
+            if (result > 0) { blk_slot.length += static_cast<std::size_t>(result); }
+            else if (result != -EAGAIN and result != -EINTR)
+            {
+                failed = true;
+                break;
+            }
+
+            if (blk_slot.length == blk_slot.iov.iov_len) { break; }
+            result = read_rest(buffered_fd, blk_slot);
+        }
+
+        if (blk_slot.length < blk_slot.iov.iov_len) { end_block = std::min(end_block, blk_slot.block + 1); }
+    }
+
+    /**
+     * Wait until the slot is read.
+     *
+     * @return false on error of the ring
+     */
+    auto wait(const slot& blk_slot) -> bool
+    {
+#ifdef GERI_SMX_DECODER_IO_URING
+        while (blk_slot.state == SLOT_STATE::pending)
+        {
+            uint64_t block{0};
+            int result{0};
+            if (!ring.wait_completion(block, result)) { return false; }
+
+            complete(slots[block % slots.size()], result);
+        }
+#endif
+        return blk_slot.state == SLOT_STATE::ready;
+    }
+
+    /**
+     * Wait for all reads in flight.
+     */
+    auto drain() -> void
+    {
+        for (auto& blk_slot : slots)
+        {
+            if (!wait(blk_slot)) { blk_slot.state = SLOT_STATE::idle; }
+        }
+    }
+
+    /**
+     * Release the current block for the next read and move to the next block.
+     *
+     * @return false at the end of file
+     */
+    auto next_block() -> bool
+    {
+        while (true)
+        {
+            if (has_current)
+            {
+                has_current = false;
+                const auto next_read = next_block_no - 1 + slots.size();
+                if (next_read < end_block)
+                {
+                    submit(next_read);
+                }
+                else
+                {
+                    slots[(next_block_no - 1) % slots.size()].state = SLOT_STATE::idle;
+                }
+            }
+
+            if (next_block_no >= end_block) { return false; }
+
+            auto& blk_slot = slots[next_block_no % slots.size()];
+            if (!wait(blk_slot))
+            {
+                failed = true;
+                end_block = next_block_no;
+                return false;
+            }
+
+            ++next_block_no;
+            has_current = true;
+            current = static_cast<const uint64_t*>(blk_slot.iov.iov_base);
+            head = std::min(skip_words, blk_slot.length / sizeof(uint64_t));
+            tail = blk_slot.length / sizeof(uint64_t);
+            skip_words = 0;
+
+            if (head != tail) { return true; }
+        }
+    }
+
+    int fd;                           ///< file descriptor
+    int buffered_fd;                  ///< file descriptor without `O_DIRECT`, for the unaligned reads
+    std::size_t block_bytes;          ///< size of the block in bytes
+    std::vector<slot> slots;          ///< buffers of the blocks, the block `n` is read into the slot `n % size`
+#ifdef GERI_SMX_DECODER_IO_URING
+    detail::uring ring;               ///< the ring
+#endif
+    bool fixed_buffers{false};        ///< whether the buffers are registered
+    uint64_t* memory{nullptr};        ///< memory of all buffers
+    uint64_t origin{0};               ///< offset of the first block in the file
+    std::size_t skip_words{0};        ///< words to skip in the first block after seek
+    uint64_t next_block_no{0};        ///< index of the next block to consume
+    uint64_t end_block{UINT64_MAX};   ///< index of the first block past the end of file
+    bool has_current{false};          ///< whether the current block is taken from its slot
+    const uint64_t* current{nullptr}; ///< data words of the current block
+    std::size_t head{0};              ///< index of the next word to be consumed
+    std::size_t tail{0};              ///< number of valid words in the current block
+    bool failed{false};               ///< I/O error found
+};
+
+} // namespace geri
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/compressed_reader.hpp"
+#include "test_helpers.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using test_helpers::decode_all;
+using test_helpers::make_stream;
+using test_helpers::small_units;
+using test_helpers::write_file;
+
+#if defined(GERI_SMX_DECODER_WITH_ZSTD) || defined(GERI_SMX_DECODER_WITH_LZ4)
+auto read_all(geri::compressed_reader& rdr) -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> words;
+    for (auto block = rdr.read_block(); !block.empty(); block = rdr.read_block())
+    {
+        words.insert(words.end(), block.begin(), block.end());
+    }
+    return words;
+}
+#endif
+
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+/**
+ * Compress into frames of the given size, not aligned to the words, with skippable frame between.
+ */
+auto compress_zstd(const std::vector<uint64_t>& words, std::size_t frame_size) -> std::vector<unsigned char>
+{
+    const auto* bytes = reinterpret_cast<const unsigned char*>(words.data());
+    const auto size = words.size() * sizeof(uint64_t);
+
+    std::vector<unsigned char> out;
+    for (std::size_t offset = 0; offset < size; offset += frame_size)
+    {
+        auto count = std::min(frame_size, size - offset);
+        std::vector<unsigned char> frame(ZSTD_compressBound(count));
+        frame.resize(ZSTD_compress(frame.data(), frame.size(), bytes + offset, count, 1));
+        out.insert(out.end(), frame.begin(), frame.end());
+
+        if (offset == 0)
+        {
+            const unsigned char skippable[] = {0x50, 0x2A, 0x4D, 0x18, 0x02, 0x00, 0x00, 0x00, 0xAA, 0xBB};
+            out.insert(out.end(), std::begin(skippable), std::end(skippable));
+        }
+    }
+    return out;
+}
+
+/**
+ * Compress into single frame of unknown content size.
+ */
+auto compress_zstd_stream(const std::vector<uint64_t>& words) -> std::vector<unsigned char>
+{
+    auto* cctx = ZSTD_createCCtx();
+    std::vector<unsigned char> out(ZSTD_compressBound(words.size() * sizeof(uint64_t)));
+    ZSTD_inBuffer input{words.data(), words.size() * sizeof(uint64_t), 0};
+    ZSTD_outBuffer output{out.data(), out.size(), 0};
+    while (ZSTD_compressStream2(cctx, &output, &input, ZSTD_e_end) != 0)
+    {
+    }
+    ZSTD_freeCCtx(cctx);
+    out.resize(output.pos);
+    return out;
+}
+#endif
+
+#ifdef GERI_SMX_DECODER_WITH_LZ4
+auto compress_lz4(const std::vector<uint64_t>& words, LZ4F_blockMode_t mode,
+                  LZ4F_blockSizeID_t block_size = LZ4F_max64KB) -> std::vector<unsigned char>
+{
+    LZ4F_preferences_t prefs{};
+    prefs.frameInfo.blockMode = mode;
+    prefs.frameInfo.blockSizeID = block_size;
+    prefs.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+    prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+    prefs.frameInfo.contentSize = words.size() * sizeof(uint64_t);
+
+    const auto size = words.size() * sizeof(uint64_t);
+    std::vector<unsigned char> out(LZ4F_compressFrameBound(size, &prefs));
+    out.resize(LZ4F_compressFrame(out.data(), out.size(), words.data(), size, &prefs));
+    return out;
+}
+#endif
+
+} // namespace
+
+TEST(TestCompressedReader, Raw)
+{
+    auto stream = make_stream(2000);
+    auto filename = write_file("compressed_raw.bin", stream.data(), stream.size() * sizeof(uint64_t));
+
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected = decode_all(&mrdr);
+
+    geri::compressed_reader rdr(filename.c_str());
+    ASSERT_EQ(rdr.format(), geri::COMPRESSION::none);
+    ASSERT_EQ(decode_all(&rdr), expected);
+    ASSERT_FALSE(rdr.corrupted());
+
+    geri::compressed_reader words_rdr(filename.c_str());
+    std::vector<uint64_t> words(stream.size() + 10);
+    ASSERT_EQ(words_rdr.read_words(words.data(), words.size()), stream.size());
+    ASSERT_THROW(words_rdr.read_word(), std::out_of_range);
+
+    std::remove(filename.c_str());
+}
+
+#ifdef GERI_SMX_DECODER_WITH_ZSTD
+TEST(TestCompressedReader, Zstd)
+{
+    auto stream = make_stream(2000);
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected = decode_all(&mrdr);
+
+    // parallel frames, streamed frame of unknown size, and frames exceeding the size limit
+    auto frames = compress_zstd(stream, 100003);
+    auto single = compress_zstd_stream(stream);
+
+    for (const auto* data : {&frames, &single})
+    {
+        auto filename = write_file("compressed.zst", data->data(), data->size());
+
+        geri::compressed_reader rdr(filename.c_str(), small_units());
+        ASSERT_EQ(rdr.format(), geri::COMPRESSION::zstd);
+        ASSERT_EQ(decode_all(&rdr), expected);
+        ASSERT_FALSE(rdr.corrupted());
+
+        auto options = small_units();
+        options.max_frame_size = 1000;
+        geri::compressed_reader stream_rdr(filename.c_str(), options);
+        ASSERT_EQ(read_all(stream_rdr), stream);
+
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(TestCompressedReader, ZstdCorrupted)
+{
+    auto stream = make_stream(2000);
+    auto frames = compress_zstd(stream, 100000);
+    frames.resize(frames.size() - 100);
+
+    auto filename = write_file("compressed_corrupted.zst", frames.data(), frames.size());
+    geri::compressed_reader rdr(filename.c_str(), small_units());
+    auto words = read_all(rdr);
+
+    ASSERT_TRUE(rdr.corrupted());
+    ASSERT_LT(words.size(), stream.size());
+    ASSERT_TRUE(std::equal(words.begin(), words.end(), stream.begin()));
+
+    std::remove(filename.c_str());
+}
+#endif
+
+#ifdef GERI_SMX_DECODER_WITH_LZ4
+TEST(TestCompressedReader, Lz4)
+{
+    auto stream = make_stream(2000);
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected = decode_all(&mrdr);
+
+    for (auto mode : {LZ4F_blockIndependent, LZ4F_blockLinked})
+    {
+        // two concatenated frames
+        auto data = compress_lz4(stream, mode);
+        auto second = data;
+        data.insert(data.end(), second.begin(), second.end());
+        auto doubled = expected;
+        doubled.insert(doubled.end(), expected.begin(), expected.end());
+
+        auto filename = write_file("compressed.lz4", data.data(), data.size());
+        geri::compressed_reader rdr(filename.c_str(), small_units());
+        ASSERT_EQ(rdr.format(), geri::COMPRESSION::lz4);
+        ASSERT_EQ(decode_all(&rdr), doubled);
+        ASSERT_FALSE(rdr.corrupted());
+
+        data.resize(data.size() / 2 + 1000);
+        filename = write_file("compressed.lz4", data.data(), data.size());
+        geri::compressed_reader truncated(filename.c_str(), small_units());
+        auto words = read_all(truncated);
+        ASSERT_TRUE(truncated.corrupted());
+        ASSERT_GE(words.size(), stream.size());
+
+        std::remove(filename.c_str());
+    }
+}
+
+TEST(TestCompressedReader, Lz4MixedBlockSizes)
+{
+    auto stream = make_stream(2000);
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected = decode_all(&mrdr);
+
+    // concatenated frames with different maximal block sizes, split while the previous ones are decompressed
+    std::vector<unsigned char> data;
+    std::vector<uint64_t> words;
+    for (auto block_size : {LZ4F_max4MB, LZ4F_max64KB, LZ4F_max1MB, LZ4F_max256KB, LZ4F_max4MB})
+    {
+        auto frame = compress_lz4(stream, LZ4F_blockIndependent, block_size);
+        data.insert(data.end(), frame.begin(), frame.end());
+        words.insert(words.end(), stream.begin(), stream.end());
+    }
+
+    auto filename = write_file("compressed_mixed.lz4", data.data(), data.size());
+    geri::compressed_reader rdr(filename.c_str(), small_units());
+    ASSERT_EQ(read_all(rdr), words);
+    ASSERT_FALSE(rdr.corrupted());
+
+    geri::compressed_reader decode_rdr(filename.c_str(), small_units());
+    ASSERT_EQ(decode_all(&decode_rdr).size(), 5 * expected.size());
+
+    std::remove(filename.c_str());
+}
+#endif
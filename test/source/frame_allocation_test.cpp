@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/generator.hpp"
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+// The global allocation functions are replaced for the whole executable, so the test counting them lives apart from
+// the other tests.
+
+namespace
+{
+std::atomic<uint64_t> heap_allocations{0}; ///< calls of the global operator new
+
+auto counted_alloc(std::size_t size) noexcept -> void*
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+auto counted_alloc(std::size_t size, std::align_val_t align) noexcept -> void*
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto alignment = std::max(static_cast<std::size_t>(align), sizeof(void*));
+    return std::aligned_alloc(alignment, (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment);
+}
+
+template <typename... Args> auto checked_alloc(Args... args) -> void*
+{
+    if (auto* ptr = counted_alloc(args...)) { return ptr; }
+    throw std::bad_alloc();
+}
+} // namespace
+
+auto operator new(std::size_t size) -> void* { return checked_alloc(size); }
+auto operator new[](std::size_t size) -> void* { return checked_alloc(size); }
+auto operator new(std::size_t size, std::align_val_t align) -> void* { return checked_alloc(size, align); }
+auto operator new[](std::size_t size, std::align_val_t align) -> void* { return checked_alloc(size, align); }
+
+auto operator new(std::size_t size, const std::nothrow_t& /*tag*/) noexcept -> void* { return counted_alloc(size); }
+auto operator new[](std::size_t size, const std::nothrow_t& /*tag*/) noexcept -> void* { return counted_alloc(size); }
+auto operator new(std::size_t size, std::align_val_t align, const std::nothrow_t& /*tag*/) noexcept -> void*
+{ return counted_alloc(size, align); }
+auto operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t& /*tag*/) noexcept -> void*
+{ return counted_alloc(size, align); }
+
+auto operator delete(void* ptr) noexcept -> void { std::free(ptr); }
+auto operator delete[](void* ptr) noexcept -> void { std::free(ptr); }
+auto operator delete(void* ptr, std::size_t /*size*/) noexcept -> void { std::free(ptr); }
+auto operator delete[](void* ptr, std::size_t /*size*/) noexcept -> void { std::free(ptr); }
+auto operator delete(void* ptr, std::align_val_t /*align*/) noexcept -> void { std::free(ptr); }
+auto operator delete[](void* ptr, std::align_val_t /*align*/) noexcept -> void { std::free(ptr); }
+auto operator delete(void* ptr, std::size_t /*size*/, std::align_val_t /*align*/) noexcept -> void { std::free(ptr); }
+auto operator delete[](void* ptr, std::size_t /*size*/, std::align_val_t /*align*/) noexcept -> void { std::free(ptr); }
+auto operator delete(void* ptr, const std::nothrow_t& /*tag*/) noexcept -> void { std::free(ptr); }
+auto operator delete[](void* ptr, const std::nothrow_t& /*tag*/) noexcept -> void { std::free(ptr); }
+auto operator delete(void* ptr, std::align_val_t /*align*/, const std::nothrow_t& /*tag*/) noexcept -> void
+{ std::free(ptr); }
+auto operator delete[](void* ptr, std::align_val_t /*align*/, const std::nothrow_t& /*tag*/) noexcept -> void
+{ std::free(ptr); }
+
+TEST(TestFrameAllocation, ArenaFramePool)
+{
+    geri::generator_options options;
+    options.n_gbts = 2;
+    options.mean_hits = 50;
+    auto words = geri::stream_generator(options).generate(200);
+
+    geri::monotonic_arena arena(1 << 16);
+    geri::arena_frame_pool pool(4, geri::arena_allocator<geri::gbt_hit>(&arena));
+
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+
+    // few frames in flight, as in the queue to the consumer thread
+    std::vector<geri::arena_frame_pool::frame_ptr> in_flight;
+    in_flight.reserve(4);
+    auto event_no = options.first_event_no;
+
+    auto decode_frames = [&](int n_frames)
+    {
+        for (int idx = 0; idx < n_frames; ++idx)
+        {
+            auto frame = pool.acquire();
+            ASSERT_EQ(frame->get_allocator().arena(), &arena);
+            ASSERT_EQ(decoder.try_decode_frame(*frame), geri::DECODE_STATUS::ok);
+            ASSERT_EQ(frame->event_no, event_no++);
+
+            in_flight.push_back(std::move(frame));
+            if (in_flight.size() == 3) { in_flight.erase(in_flight.begin()); }
+        }
+    };
+
+    decode_frames(20);
+    const auto blocks = arena.blocks();
+    const auto allocations = heap_allocations.load();
+
+    // steady state, the frames and their hits storage are recycled
+    decode_frames(180);
+    ASSERT_EQ(heap_allocations.load(), allocations);
+    ASSERT_EQ(arena.blocks(), blocks);
+    ASSERT_LE(pool.size(), 4);
+
+    // default allocator uses the arena of the thread
+    geri::arena_payload_frame frame;
+    ASSERT_EQ(frame.get_allocator().arena(), &geri::monotonic_arena::this_thread());
+    frame.hits.resize(1000, geri::gbt_hit{geri::gbt::gbt_uplink_addr{}});
+    ASSERT_GE(geri::monotonic_arena::this_thread().reserved(), 1000 * sizeof(geri::gbt_hit));
+
+    // allocations larger than the block
+    ASSERT_NE(arena.allocate(1 << 17, 64), nullptr);
+    ASSERT_EQ(arena.blocks(), blocks + 1);
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/generator.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+auto decode_all(const std::vector<uint64_t>& words, geri::decoder_counters& counters) -> uint64_t
+{
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+
+    uint64_t n_hits{0};
+    geri::payload_frame frame;
+    for (auto status = decoder.try_decode_frame(frame); status != geri::DECODE_STATUS::end_of_data;
+         status = decoder.try_decode_frame(frame))
+    {
+        if (status == geri::DECODE_STATUS::ok) { n_hits += frame.hits.size(); }
+    }
+
+    counters = decoder.get_counters();
+    return n_hits;
+}
+
+auto sum_ts_mismatch(const geri::decoder_counters& counters) -> uint64_t
+{
+    uint64_t sum{0};
+    for (const auto& uplink : counters.uplinks)
+    {
+        sum += uplink.ts_mismatch;
+    }
+    return sum;
+}
+
+auto sum_invalid_ts_msb(const geri::decoder_counters& counters) -> uint64_t
+{
+    uint64_t sum{0};
+    for (const auto& uplink : counters.uplinks)
+    {
+        sum += uplink.invalid_ts_msb;
+    }
+    return sum;
+}
+
+} // namespace
+
+TEST(TestGenerator, ValidStream)
+{
+    geri::generator_options options;
+    options.n_gbts = 2;
+    options.n_uplinks = 12;
+    options.first_event_no = 100;
+    options.dummy_hit_ratio = 0.1;
+
+    geri::stream_generator gen(options);
+    auto words = gen.generate(500);
+    const auto& stats = gen.stats();
+
+    ASSERT_EQ(stats.frames, 500);
+    ASSERT_EQ(stats.words, words.size());
+    ASSERT_EQ(stats.ts_msb, 500 * 24);
+    ASSERT_GT(stats.dummy_hits, 0);
+
+    geri::decoder_counters counters;
+    auto n_hits = decode_all(words, counters);
+
+    ASSERT_EQ(n_hits, stats.hits);
+    ASSERT_EQ(counters.frames, 500);
+    ASSERT_EQ(counters.total().hits(), stats.hits);
+    ASSERT_EQ(counters.total().count(geri::smx::UPLINK_FRAME_TYPE::dummy_hit), stats.dummy_hits);
+    ASSERT_EQ(sum_ts_mismatch(counters), 0);
+    ASSERT_EQ(counters.event_gaps, 0);
+    ASSERT_EQ(counters.systime_mismatches, 0);
+    ASSERT_EQ(counters.resyncs, 0);
+
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+    ASSERT_EQ(decoder.decode_frame().event_no, 100);
+    ASSERT_EQ(decoder.decode_frame().event_no, 101);
+}
+
+TEST(TestGenerator, HitDistributions)
+{
+    geri::generator_options options;
+    options.mean_hits = 100;
+
+    options.distribution = geri::HIT_DISTRIBUTION::fixed;
+    geri::stream_generator fixed(options);
+    fixed.generate(100);
+    ASSERT_EQ(fixed.stats().hits, 100 * 100);
+
+    for (auto distribution : {geri::HIT_DISTRIBUTION::uniform, geri::HIT_DISTRIBUTION::poisson})
+    {
+        options.distribution = distribution;
+        geri::stream_generator gen(options);
+        gen.generate(1000);
+        ASSERT_NEAR(static_cast<double>(gen.stats().hits) / 1000, 100, 5);
+    }
+
+    options.mean_hits = 0;
+    geri::stream_generator empty(options);
+    empty.generate(100);
+    ASSERT_EQ(empty.stats().hits, 0);
+}
+
+TEST(TestGenerator, Reproducible)
+{
+    geri::generator_options options;
+    options.garbage_ratio = 0.1;
+
+    ASSERT_EQ(geri::stream_generator(options).generate(100), geri::stream_generator(options).generate(100));
+
+    auto other = options;
+    other.seed = 1;
+    ASSERT_NE(geri::stream_generator(options).generate(100), geri::stream_generator(other).generate(100));
+}
+
+TEST(TestGenerator, Corruption)
+{
+    geri::generator_options options;
+    options.data_dropped_ratio = 0.1;
+    options.ts_mismatch_ratio = 0.05;
+    options.event_gap_ratio = 0.1;
+    options.garbage_ratio = 0.1;
+
+    geri::stream_generator gen(options);
+    auto words = gen.generate(1000);
+    const auto& stats = gen.stats();
+
+    ASSERT_GT(stats.ts_mismatches, 0);
+    ASSERT_GT(stats.garbage_words, 0);
+
+    geri::decoder_counters counters;
+    auto n_hits = decode_all(words, counters);
+
+    ASSERT_EQ(n_hits, stats.hits);
+    ASSERT_EQ(counters.frames, 1000);
+    ASSERT_EQ(counters.data_dropped, stats.data_dropped);
+    ASSERT_EQ(sum_ts_mismatch(counters), stats.ts_mismatches);
+    ASSERT_EQ(counters.event_gaps, stats.event_gaps);
+    ASSERT_EQ(counters.skipped_bytes, stats.garbage_words * sizeof(uint64_t));
+
+    options = {};
+    options.invalid_ts_msb_ratio = 0.05;
+    geri::stream_generator invalid_gen(options);
+    words = invalid_gen.generate(1000);
+
+    decode_all(words, counters);
+    ASSERT_GT(invalid_gen.stats().invalid_ts_msb, 0);
+    ASSERT_EQ(sum_invalid_ts_msb(counters), invalid_gen.stats().invalid_ts_msb);
+}
+
+TEST(TestGenerator, WriteFile)
+{
+    geri::generator_options options;
+    auto expected = geri::stream_generator(options).generate(3000);
+
+    std::string filename = testing::TempDir() + "generator_test.bin";
+    auto* fp = std::fopen(filename.c_str(), "wb");
+    geri::stream_generator gen(options);
+    ASSERT_EQ(gen.write(fp, 3000), expected.size() * sizeof(uint64_t));
+    std::fclose(fp);
+
+    geri::mmap_reader rdr(filename.c_str());
+    auto block = rdr.read_block();
+    ASSERT_EQ(std::vector<uint64_t>(block.begin(), block.end()), expected);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestGenerator, InvalidOptions)
+{
+    geri::generator_options options;
+    options.n_gbts = 9;
+    ASSERT_THROW(geri::stream_generator{options}, std::invalid_argument);
+
+    options = {};
+    options.n_uplinks = 0;
+    ASSERT_THROW(geri::stream_generator{options}, std::invalid_argument);
+
+    options = {};
+    options.garbage_ratio = 1.5;
+    ASSERT_THROW(geri::stream_generator{options}, std::invalid_argument);
+
+    options = {};
+    options.mean_hits = -1;
+    ASSERT_THROW(geri::stream_generator{options}, std::invalid_argument);
+}
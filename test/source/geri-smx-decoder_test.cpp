@@ -1,7 +1,71 @@
 #include <gtest/gtest.h>
 
+#include "geri-smx-decoder/generator.hpp"
 #include "geri-smx-decoder/geri-smx-decoder.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Build a single GERI payload frame with given 64-bit data words.
+ */
+auto make_frame(uint32_t event_no, uint64_t prev_systime, uint64_t systime, const std::vector<uint64_t>& data)
+    -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> words{(uint64_t{event_no} << 32) | 0x579acce7, prev_systime, 0x0, 0x0};
+    words.insert(words.end(), data.begin(), data.end());
+    words.insert(words.end(), {(uint64_t{event_no} << 32) | 0xed9acce7, systime, 0x0, 0x0});
+    return words;
+}
+
+/**
+ * Two frames, each with ts_msb and two hits from uplink 0x08 and a single hit from uplink 0x09.
+ */
+auto make_test_stream() -> std::vector<uint64_t>
+{
+    auto stream = make_frame(1, 0x0, 0x100, {0x08012345'08d96590, 0x09012345'08012345});
+    auto second = make_frame(2, 0x100, 0x200, {0x08012345'08d96590, 0x09012345'08012345});
+    stream.insert(stream.end(), second.begin(), second.end());
+    return stream;
+}
+
+auto write_temp_file(const std::vector<uint64_t>& words) -> std::string
+{
+    std::string filename = testing::TempDir() + "geri-smx-decoder_test.bin";
+    auto* fp = std::fopen(filename.c_str(), "wb");
+    std::fwrite(words.data(), sizeof(uint64_t), words.size(), fp);
+    std::fclose(fp);
+    return filename;
+}
+
+/**
+ * Reader which provides only the per-word interface.
+ */
+class word_reader
+{
+public:
+    explicit word_reader(std::vector<uint64_t> words) : m_words{std::move(words)} {}
+
+    auto read_word() -> uint64_t
+    {
+        if (m_pos == m_words.size()) { throw std::out_of_range("END OF DATA"); }
+        return m_words[m_pos++];
+    }
+
+private:
+    std::vector<uint64_t> m_words;
+    std::size_t m_pos{0};
+};
+
+} // namespace
+
 TEST(TestGeriSmx, UplinkFrameType)
 {
     ASSERT_EQ(geri::smx::get_uplink_frame_type(0x000000), geri::smx::UPLINK_FRAME_TYPE::dummy_hit);
@@ -18,6 +82,30 @@ TEST(TestGeriSmx, UplinkFrameType)
     ASSERT_EQ(geri::smx::get_uplink_frame_type(0x800000), geri::smx::UPLINK_FRAME_TYPE::seq_error);
 }
 
+TEST(TestGeriSmx, UplinkFrameTypeAllWords)
+{
+    // reference implementation with masked comparisons
+    auto reference = [](uint32_t word) -> geri::smx::UPLINK_FRAME_TYPE
+    {
+        auto header = (word >> 19) & 0x1f;
+        if ((header & 0b11000) == 0b11000) { return geri::smx::UPLINK_FRAME_TYPE::ts_msb; }
+        if ((header & 0b11100) == 0b10100) { return geri::smx::UPLINK_FRAME_TYPE::rdata_ack; }
+        if (header == 0b10001) { return geri::smx::UPLINK_FRAME_TYPE::ack; }
+        if (header == 0b10010) { return geri::smx::UPLINK_FRAME_TYPE::nack; }
+        if (header == 0b10011) { return geri::smx::UPLINK_FRAME_TYPE::alert_ack; }
+        if (header == 0b10000) { return geri::smx::UPLINK_FRAME_TYPE::seq_error; }
+        if ((word & 0x7ffe00) == 0x0) { return geri::smx::UPLINK_FRAME_TYPE::dummy_hit; }
+        return geri::smx::UPLINK_FRAME_TYPE::hit;
+    };
+
+    for (uint32_t word = 0; word < 0x1000000; ++word)
+    {
+        ASSERT_EQ(geri::smx::get_uplink_frame_type(word), reference(word)) << word;
+    }
+
+    static_assert(geri::smx::get_uplink_frame_type(0xc00000) == geri::smx::UPLINK_FRAME_TYPE::ts_msb, "");
+}
+
 TEST(TestGeriSmx, HitDecodingEmptyTS)
 {
     // 0b0'0000'0001'0010'0011'0100'0101;
@@ -70,8 +158,878 @@ TEST(TestGeriSmx, TsMsbDecoding)
     ASSERT_EQ(geri::smx::decode_smx_ts_msb(word), 0b011001'00000000);
 }
 
+TEST(TestGeriSmx, TsMsbCrc)
+{
+    // bit-serial CRC-4 over the bits <23:4>, x^4 + x + 1
+    auto serial_crc = [](uint32_t word)
+    {
+        uint32_t crc{0};
+        for (int bit = 23; bit >= 4; --bit)
+        {
+            auto feedback = ((crc >> 3) ^ (word >> bit)) & 0x1;
+            crc = ((crc << 1) & 0xf) ^ (feedback != 0 ? geri::smx::ts_msb_crc_poly : 0);
+        }
+        return crc;
+    };
+
+    static_assert(geri::smx::ts_msb_crc_syndrome(0) == 0, "zero frame has zero CRC");
+
+    for (uint32_t data = 0; data < (1U << 20); ++data)
+    {
+        auto word = data << 4;
+        auto crc = serial_crc(word);
+        ASSERT_EQ(geri::smx::ts_msb_crc(word | 0x5), crc);
+        ASSERT_EQ(geri::smx::ts_msb_crc_syndrome(word | crc), 0);
+        ASSERT_NE(geri::smx::ts_msb_crc_syndrome(word | (crc ^ 0x8)), 0);
+    }
+
+    // address byte is ignored
+    auto word = 0xd96590U | geri::smx::ts_msb_crc(0xd96590);
+    ASSERT_EQ(geri::smx::ts_msb_crc_syndrome(word | 0x7f000000), 0);
+}
+
+TEST(TestGeriSmx, TryDecoding)
+{
+    geri::smx::hit res;
+    ASSERT_EQ(geri::smx::try_decode_smx_hit(0x012345, 0x1900, res), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(res.full_ts, 0x19a2);
+    ASSERT_EQ(geri::smx::try_decode_smx_hit(0x012145, 0x1900, res), geri::DECODE_STATUS::ts_mismatch);
+    ASSERT_THROW(geri::smx::decode_smx_hit(0x012145, 0x1900), geri::exceptions::ts_match_error);
+
+    uint16_t ts_msb{0};
+    ASSERT_EQ(geri::smx::try_decode_smx_ts_msb(0xd96590, ts_msb), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(ts_msb, 0b011001'00000000);
+
+    // one of the ts_msb copies differs
+    ts_msb = 0;
+    ASSERT_EQ(geri::smx::get_uplink_frame_type(0xd965a0), geri::smx::UPLINK_FRAME_TYPE::ts_msb);
+    ASSERT_EQ(geri::smx::try_decode_smx_ts_msb(0xd965a0, ts_msb), geri::DECODE_STATUS::invalid_ts_msb);
+    ASSERT_EQ(ts_msb, 0);
+    ASSERT_THROW(geri::smx::decode_smx_ts_msb(0xd965a0), geri::exceptions::ts_msb_error);
+}
+
 TEST(TestGeri, GbtFrameStruct)
 {
     geri::payload_frame frame;
-    ASSERT_EQ(frame.hits.capacity(), 1024 * 1024);
+    ASSERT_EQ(frame.hits.capacity(), 0);
+
+    frame.hits.emplace_back(geri::gbt::gbt_uplink_addr{});
+    frame.event_no = 1;
+    auto capacity = frame.hits.capacity();
+
+    frame.clear();
+    ASSERT_EQ(frame.event_no, 0);
+    ASSERT_TRUE(frame.hits.empty());
+    ASSERT_EQ(frame.hits.capacity(), capacity);
+}
+
+TEST(TestGeri, FileReaderBlocks)
+{
+    auto stream = make_test_stream();
+    auto filename = write_temp_file(stream);
+
+    geri::file_reader frdr(filename.c_str(), 3 * sizeof(uint64_t));
+
+    ASSERT_EQ(frdr.read_word(), stream[0]);
+
+    std::vector<uint64_t> buf(4);
+    ASSERT_EQ(frdr.read_words(buf.data(), buf.size()), 4);
+    ASSERT_EQ(buf, std::vector<uint64_t>(stream.begin() + 1, stream.begin() + 5));
+
+    auto block = frdr.read_block();
+    ASSERT_EQ(block.size(), 1);
+    ASSERT_EQ(block[0], stream[5]);
+
+    std::vector<uint64_t> rest(stream.size());
+    ASSERT_EQ(frdr.read_words(rest.data(), rest.size()), stream.size() - 6);
+    ASSERT_TRUE(frdr.read_block().empty());
+    ASSERT_THROW(frdr.read_word(), std::out_of_range);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestGeri, DecodeBulkAndWordReaders)
+{
+    auto stream = make_test_stream();
+    auto filename = write_temp_file(stream);
+
+    geri::file_reader frdr(filename.c_str(), 5 * sizeof(uint64_t));
+    auto bulk_decoder = geri::payload_decoder<geri::file_reader>(&frdr);
+
+    word_reader wrdr(stream);
+    auto word_decoder = geri::payload_decoder<word_reader>(&wrdr);
+
+    for (uint32_t evt = 1; evt <= 2; ++evt)
+    {
+        auto bulk = bulk_decoder.decode_frame();
+        auto word = word_decoder.decode_frame();
+
+        ASSERT_EQ(bulk.event_no, evt);
+        ASSERT_EQ(bulk.system_ts, evt * 0x100);
+        ASSERT_EQ(bulk.hits.size(), 3);
+        ASSERT_EQ(bulk.hits[0].full_ts, 0x19a2);
+        ASSERT_EQ(bulk.hits[2].uplink, 0x9);
+
+        ASSERT_EQ(word.event_no, bulk.event_no);
+        ASSERT_EQ(word.system_ts, bulk.system_ts);
+        ASSERT_EQ(word.hits.size(), bulk.hits.size());
+    }
+
+    ASSERT_THROW(bulk_decoder.decode_frame(), std::out_of_range);
+    ASSERT_THROW(word_decoder.decode_frame(), std::out_of_range);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestGeri, DecodeMappedAndMemory)
+{
+    auto stream = make_test_stream();
+    auto filename = write_temp_file(stream);
+
+    geri::mmap_reader mrdr(filename.c_str());
+    ASSERT_EQ(mrdr.data().size(), stream.size());
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+
+    auto mmap_decoder = geri::payload_decoder<geri::mmap_reader>(&mrdr);
+    auto memory_decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+
+    for (uint32_t evt = 1; evt <= 2; ++evt)
+    {
+        auto mapped = mmap_decoder.decode_frame();
+        auto memory = memory_decoder.decode_frame();
+
+        ASSERT_EQ(mapped.event_no, evt);
+        ASSERT_EQ(mapped.hits.size(), 3);
+        ASSERT_EQ(memory.event_no, evt);
+        ASSERT_EQ(memory.hits.size(), 3);
+    }
+
+    ASSERT_THROW(mmap_decoder.decode_frame(), std::out_of_range);
+    ASSERT_THROW(memory_decoder.decode_frame(), std::out_of_range);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestGeri, DecodeIntoReusedFrame)
+{
+    auto stream = make_test_stream();
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+
+    geri::payload_frame frame;
+    decoder.decode_frame(frame);
+    ASSERT_EQ(frame.event_no, 1);
+    ASSERT_EQ(frame.hits.size(), 3);
+
+    const auto* hits_data = frame.hits.data();
+    decoder.decode_frame(frame);
+    ASSERT_EQ(frame.event_no, 2);
+    ASSERT_EQ(frame.hits.size(), 3);
+    ASSERT_EQ(frame.hits.data(), hits_data);
+}
+
+TEST(TestGeri, FramePool)
+{
+    geri::frame_pool pool(1);
+
+    const geri::payload_frame* recycled{nullptr};
+    {
+        auto frame = pool.acquire();
+        frame->hits.emplace_back(geri::gbt::gbt_uplink_addr{});
+        recycled = frame.get();
+        frame.reset();
+        ASSERT_EQ(pool.size(), 1);
+
+        frame = pool.acquire();
+        ASSERT_EQ(frame.get(), recycled);
+        ASSERT_TRUE(frame->hits.empty());
+        ASSERT_EQ(pool.size(), 0);
+
+        auto other = pool.acquire();
+        ASSERT_NE(other.get(), recycled);
+    }
+    ASSERT_EQ(pool.size(), 1);
+}
+
+TEST(TestGeri, DecodePmrFrame)
+{
+    auto stream = make_test_stream();
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+
+    // no fallback to the global heap
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+    geri::pmr::frame_pool pool(2, &resource);
+    auto frame = pool.acquire();
+    decoder.decode_frame(*frame);
+    ASSERT_EQ(frame->event_no, 1);
+    ASSERT_EQ(frame->hits.size(), 3);
+    ASSERT_EQ(frame->get_allocator().resource(), &resource);
+
+    geri::pmr::payload_frame other(&resource);
+    ASSERT_EQ(decoder.try_decode_frame(other), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(other.event_no, 2);
+}
+
+TEST(TestGeri, TsStatePersistsAcrossFrames)
+{
+    // ts_msb for uplink 0x08 only in the first frame
+    auto stream = make_frame(1, 0x0, 0x100, {0x08012345'08d96590});
+    auto second = make_frame(2, 0x100, 0x200, {0x08012345'08012345});
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+
+    auto first_frame = decoder.decode_frame();
+    ASSERT_EQ(decoder.get_ts_state()[0x08], 0x1900);
+
+    auto second_frame = decoder.decode_frame();
+    ASSERT_EQ(second_frame.hits.size(), 2);
+    ASSERT_EQ(second_frame.hits[0].full_ts, first_frame.hits[0].full_ts);
+
+    decoder.reset_ts_state();
+    ASSERT_EQ(decoder.get_ts_state()[0x08], 0x0);
+
+    geri::payload_decoder<geri::memory_reader>::ts_state state{};
+    state[0x09] = 0x1900;
+    decoder.set_ts_state(state);
+    ASSERT_EQ(decoder.get_ts_state()[0x09], 0x1900);
+}
+
+TEST(TestGeriSmx, BatchKernelsMatchScalar)
+{
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> words(geri::smx::word_batch::max_words);
+
+    const geri::smx::SIMD_LEVEL levels[] = {geri::smx::SIMD_LEVEL::sse4, geri::smx::SIMD_LEVEL::avx2,
+                                            geri::smx::SIMD_LEVEL::avx512};
+    auto supported = geri::smx::detect_simd_level();
+
+    for (int round = 0; round < 100; ++round)
+    {
+        for (auto& word : words)
+        {
+            word = rng();
+        }
+
+        // include all tails
+        auto n_words = static_cast<std::size_t>(round) % (words.size() + 1);
+
+        geri::smx::word_batch reference;
+        geri::smx::decode_word_batch_scalar(words.data(), n_words, reference);
+        ASSERT_EQ(reference.size, 2 * n_words);
+
+        for (auto level : levels)
+        {
+            if (level > supported) { continue; }
+
+            geri::smx::word_batch batch;
+            geri::smx::get_word_batch_kernel(level)(words.data(), n_words, batch);
+
+            ASSERT_EQ(batch.size, reference.size);
+            for (std::size_t idx = 0; idx < batch.size; ++idx)
+            {
+                auto word = static_cast<uint32_t>(words[idx / 2] >> (32 * (idx % 2)));
+                ASSERT_EQ(batch.raw[idx], word);
+                ASSERT_EQ(batch.type[idx], static_cast<uint32_t>(geri::smx::get_uplink_frame_type(word)));
+                ASSERT_EQ(batch.type[idx], reference.type[idx]);
+                ASSERT_EQ(batch.addr[idx], reference.addr[idx]);
+                ASSERT_EQ(batch.channel[idx], reference.channel[idx]);
+                ASSERT_EQ(batch.adc[idx], reference.adc[idx]);
+                ASSERT_EQ(batch.ts[idx], reference.ts[idx]);
+                ASSERT_EQ(batch.event_missing[idx], reference.event_missing[idx]);
+            }
+        }
+    }
+}
+
+TEST(TestGeri, DecodeWithAllSimdLevels)
+{
+    // long frame to exercise full batches
+    std::vector<uint64_t> data{0x08012345'08d96590};
+    data.resize(100, 0x09012345'08012345);
+    auto stream = make_frame(1, 0x0, 0x100, data);
+
+    for (auto level : {geri::smx::SIMD_LEVEL::scalar, geri::smx::SIMD_LEVEL::sse4, geri::smx::SIMD_LEVEL::avx2,
+                       geri::smx::SIMD_LEVEL::avx512})
+    {
+        if (level > geri::smx::detect_simd_level()) { continue; }
+
+        geri::memory_reader memrdr(stream.data(), stream.size());
+        auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+        decoder.set_simd_level(level);
+
+        auto frame = decoder.decode_frame();
+        ASSERT_EQ(frame.hits.size(), 199);
+        for (const auto& hit : frame.hits)
+        {
+            ASSERT_EQ(hit.channel, 0x1);
+            ASSERT_EQ(hit.adc, 0x4);
+            ASSERT_EQ(hit.ts, 0x1a2);
+            ASSERT_EQ(hit.event_missing, true);
+        }
+        ASSERT_EQ(frame.hits[0].full_ts, 0x19a2);
+        ASSERT_EQ(frame.hits[2].uplink, 0x9);
+    }
+}
+
+TEST(TestGeri, DecodeColumnarFrame)
+{
+    auto stream = make_test_stream();
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+
+    geri::memory_reader reference_rdr(stream.data(), stream.size());
+    auto reference_decoder = geri::payload_decoder<geri::memory_reader>(&reference_rdr);
+
+    geri::columnar_frame frame;
+    for (uint32_t evt = 1; evt <= 2; ++evt)
+    {
+        decoder.decode_frame(frame);
+        auto reference = reference_decoder.decode_frame();
+
+        ASSERT_EQ(frame.event_no, evt);
+        ASSERT_EQ(frame.system_ts, reference.system_ts);
+        ASSERT_EQ(frame.size(), reference.hits.size());
+        ASSERT_EQ(frame.adc().size(), reference.hits.size());
+        ASSERT_EQ(frame.addr()[2], 0x09);
+        ASSERT_EQ(frame.full_ts()[0], 0x19a2);
+        ASSERT_EQ(frame.flags()[0], geri::columnar_frame::FLAGS::event_missing);
+
+        std::size_t idx = 0;
+        for (const auto& hit : frame)
+        {
+            const auto& expected = reference.hits[idx++];
+            ASSERT_EQ(hit.gbt, expected.gbt);
+            ASSERT_EQ(hit.uplink, expected.uplink);
+            ASSERT_EQ(hit.unique_addr, expected.unique_addr);
+            ASSERT_EQ(hit.channel, expected.channel);
+            ASSERT_EQ(hit.adc, expected.adc);
+            ASSERT_EQ(hit.ts, expected.ts);
+            ASSERT_EQ(hit.full_ts, expected.full_ts);
+            ASSERT_EQ(hit.event_missing, expected.event_missing);
+        }
+    }
+}
+
+TEST(TestGeri, EventIndex)
+{
+    auto stream = make_test_stream();
+    auto filename = write_temp_file(stream);
+    auto index_filename = geri::event_index::sidecar_filename(filename);
+
+    {
+        geri::file_reader frdr(filename.c_str(), 3 * sizeof(uint64_t));
+        geri::event_index index;
+        index.build(frdr);
+
+        ASSERT_EQ(index.size(), 2);
+        ASSERT_EQ(index.entries()[0].offset, 0);
+        ASSERT_EQ(index.entries()[0].n_words, 10);
+        ASSERT_EQ(index.entries()[0].system_ts, 0x100);
+        ASSERT_EQ(index.entries()[1].offset, 10 * sizeof(uint64_t));
+        ASSERT_EQ(index.entries()[1].event_no, 2);
+        ASSERT_TRUE(index.save(index_filename.c_str()));
+    }
+
+    geri::event_index index;
+    ASSERT_TRUE(index.load(index_filename.c_str()));
+    ASSERT_EQ(index.size(), 2);
+
+    {
+        // count larger than the entries in the file
+        auto* fp = std::fopen(index_filename.c_str(), "r+b");
+        uint64_t count{uint64_t{1} << 60};
+        std::fseek(fp, 8, SEEK_SET);
+        std::fwrite(&count, sizeof(count), 1, fp);
+        std::fclose(fp);
+
+        geri::event_index corrupted;
+        ASSERT_FALSE(corrupted.load(index_filename.c_str()));
+        ASSERT_EQ(corrupted.size(), 0);
+    }
+    ASSERT_EQ(index.find(2)->system_ts, 0x200);
+    ASSERT_EQ(index.find(3), nullptr);
+
+    geri::file_reader frdr(filename.c_str());
+    auto decoder = geri::payload_decoder<geri::file_reader>(&frdr);
+    decoder.set_index(&index);
+
+    ASSERT_TRUE(decoder.seek_event(2));
+    auto frame = decoder.decode_frame();
+    ASSERT_EQ(frame.event_no, 2);
+    ASSERT_EQ(frame.hits.size(), 3);
+
+    ASSERT_FALSE(decoder.seek_event(5));
+
+    frame = decoder.decode_frame_at(index.find(1)->offset);
+    ASSERT_EQ(frame.event_no, 1);
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto memory_decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+    geri::columnar_frame columns;
+    memory_decoder.decode_frame_at(index.entries()[1].offset, columns);
+    ASSERT_EQ(columns.event_no, 2);
+    ASSERT_THROW(memory_decoder.decode_frame_at(stream.size() * sizeof(uint64_t) + 8), std::out_of_range);
+
+    std::remove(index_filename.c_str());
+    std::remove(filename.c_str());
+}
+
+TEST(TestGeri, EventIndexTruncatedFrame)
+{
+    // second frame lost its stop marker and trailer, the third has a data word looking like the start marker
+    auto stream = make_frame(1, 0x0, 0x100, {0x08012345'08d96590});
+    auto second = make_frame(2, 0x100, 0x200, {0x08012345'08d96590});
+    second.resize(second.size() - 4);
+    auto third = make_frame(3, 0x200, 0x300, {0x08012345'579acce7, 0x08012345'08d96590, 0x08012345'08d96590});
+    auto fourth = make_frame(4, 0x300, 0x400, {0x08012345'08d96590});
+    for (const auto* frame : {&second, &third, &fourth})
+    {
+        stream.insert(stream.end(), frame->begin(), frame->end());
+    }
+
+    auto check = [](const geri::event_index& index)
+    {
+        ASSERT_EQ(index.size(), 3);
+        ASSERT_EQ(index.entries()[0].event_no, 1);
+        ASSERT_EQ(index.entries()[1].event_no, 3);
+        ASSERT_EQ(index.entries()[1].offset, 14 * sizeof(uint64_t));
+        ASSERT_EQ(index.entries()[1].n_words, 11);
+        ASSERT_EQ(index.entries()[1].system_ts, 0x300);
+        ASSERT_EQ(index.entries()[2].event_no, 4);
+        ASSERT_EQ(index.entries()[2].offset, 25 * sizeof(uint64_t));
+    };
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    geri::event_index index;
+    index.build(memrdr);
+    check(index);
+
+    word_reader wrdr(stream);
+    geri::event_index word_index;
+    word_index.build(wrdr);
+    check(word_index);
+}
+
+TEST(TestGeri, TryDecodeFrame)
+{
+    // second frame has a broken ts_msb and a hit not matching the ts_msb, the third frame has broken trailer
+    auto stream = make_frame(1, 0x0, 0x100, {0x08012345'08d96590});
+    auto second = make_frame(2, 0x100, 0x200, {0x08d965a0'08012145});
+    auto third = make_frame(3, 0x200, 0x300, {0x08012345'08012345});
+    third.back() = 0x1;
+    stream.insert(stream.end(), second.begin(), second.end());
+    stream.insert(stream.end(), third.begin(), third.end());
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    uint64_t word{0};
+    ASSERT_EQ(memrdr.try_read_word(word), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(word, stream[0]);
+    memrdr.seek(stream.size() * sizeof(uint64_t));
+    ASSERT_EQ(memrdr.try_read_word(word), geri::DECODE_STATUS::end_of_data);
+    ASSERT_THROW(memrdr.read_word(), std::out_of_range);
+
+    memrdr.seek(0);
+    word_reader wrdr(stream);
+    auto memory_decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+    auto word_decoder = geri::payload_decoder<word_reader>(&wrdr);
+
+    geri::payload_frame frame;
+    ASSERT_EQ(memory_decoder.try_decode_frame(frame), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(frame.hits.size(), 1);
+    ASSERT_EQ(memory_decoder.try_decode_frame(frame), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(frame.event_no, 2);
+    ASSERT_EQ(frame.hits.size(), 0);
+    ASSERT_EQ(memory_decoder.try_decode_frame(frame), geri::DECODE_STATUS::invalid_frame);
+    ASSERT_EQ(memory_decoder.try_decode_frame(frame), geri::DECODE_STATUS::end_of_data);
+
+    auto counters = memory_decoder.get_counters();
+    ASSERT_EQ(counters.uplinks[0x08].ts_mismatch, 1);
+    ASSERT_EQ(counters.uplinks[0x08].invalid_ts_msb, 1);
+    ASSERT_EQ(counters.invalid_frames, 1);
+
+    memory_decoder.reset_counters();
+    ASSERT_EQ(memory_decoder.get_counters().total().ts_mismatch, 0);
+
+    ASSERT_EQ(memory_decoder.try_decode_frame_at(stream.size() * sizeof(uint64_t) + 8, frame),
+              geri::DECODE_STATUS::invalid_offset);
+
+    // throwing wrappers
+    word_decoder.decode_frame(frame);
+    word_decoder.decode_frame(frame);
+    ASSERT_EQ(word_decoder.get_counters().uplinks[0x08].ts_mismatch, 1);
+    ASSERT_THROW(word_decoder.decode_frame(frame), geri::exceptions::invalid_gbt_frame);
+    ASSERT_THROW(word_decoder.decode_frame(frame), std::out_of_range);
+}
+
+TEST(TestGeri, DecoderCounters)
+{
+    // frames 1, 2 and 4; frame 2 has data dropped bit, wrong previous system time, a dummy hit and an ack word of
+    // uplink 0x09; frame 4 is preceded by a garbage word and has stop marker of other event before its own
+    auto stream = make_frame(1, 0x0, 0x100, {0x08012345'08d96590});
+    auto second = make_frame(2, 0x150, 0x200, {0x09880000'09000000, 0x08012345'08012345});
+    second[2] = 0x1;
+    auto fourth = make_frame(4, 0x200, 0x300, {(uint64_t{7} << 32) | 0xed9acce7});
+    stream.insert(stream.end(), second.begin(), second.end());
+    stream.push_back(0x12345678);
+    stream.insert(stream.end(), fourth.begin(), fourth.end());
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+
+    geri::payload_frame frame;
+    while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+    {
+    }
+
+    auto counters = decoder.get_counters();
+    ASSERT_EQ(counters.frames, 3);
+    ASSERT_EQ(counters.data_dropped, 1);
+    ASSERT_EQ(counters.systime_mismatches, 1);
+    ASSERT_EQ(counters.event_gaps, 1);
+    ASSERT_EQ(counters.event_mismatches, 1);
+    ASSERT_EQ(counters.resyncs, 1);
+    ASSERT_EQ(counters.skipped_bytes, 8);
+
+    const auto& uplink = counters.uplinks[0x08];
+    ASSERT_EQ(uplink.count(geri::smx::UPLINK_FRAME_TYPE::ts_msb), 1);
+    ASSERT_EQ(uplink.count(geri::smx::UPLINK_FRAME_TYPE::hit), 3);
+    ASSERT_EQ(uplink.hits(), 3);
+    ASSERT_EQ(counters.uplinks[0x09].count(geri::smx::UPLINK_FRAME_TYPE::dummy_hit), 1);
+    ASSERT_EQ(counters.uplinks[0x09].count(geri::smx::UPLINK_FRAME_TYPE::ack), 1);
+    ASSERT_EQ(counters.total().hits(), 3);
+}
+
+TEST(TestGeri, DecodeFrameVisitor)
+{
+    struct hits_counter : geri::frame_visitor
+    {
+        std::vector<uint32_t> events;
+        std::vector<uint64_t> system_ts;
+        std::size_t n_hits{0};
+        uint32_t ts_sum{0};
+        std::size_t n_ts_msb{0};
+        std::size_t n_other{0};
+
+        auto on_frame_begin(uint32_t event_no, bool /*data_dropped*/) -> void { events.push_back(event_no); }
+        auto on_hit(const geri::gbt_hit& hit) -> void
+        {
+            ++n_hits;
+            ts_sum += hit.full_ts;
+        }
+        auto on_ts_msb(uint8_t unique_addr, uint16_t ts_msb) -> void
+        {
+            ASSERT_EQ(unique_addr, 0x08);
+            ASSERT_EQ(ts_msb, 0x1900);
+            ++n_ts_msb;
+        }
+        auto on_other_word(uint8_t /*unique_addr*/, geri::smx::UPLINK_FRAME_TYPE /*type*/, uint32_t /*word*/) -> void
+        {
+            ++n_other;
+        }
+        auto on_frame_end(uint64_t ts) -> void { system_ts.push_back(ts); }
+    };
+
+    auto stream = make_test_stream();
+    stream.insert(stream.end() - 4, 0x09880000'09000000);
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+
+    hits_counter counter;
+    decoder.decode_frame(counter);
+    ASSERT_EQ(decoder.try_decode_frame(counter), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(decoder.try_decode_frame(counter), geri::DECODE_STATUS::end_of_data);
+    ASSERT_THROW(decoder.decode_frame(counter), std::out_of_range);
+
+    ASSERT_EQ(counter.events, (std::vector<uint32_t>{1, 2}));
+    ASSERT_EQ(counter.system_ts, (std::vector<uint64_t>{0x100, 0x200}));
+    ASSERT_EQ(counter.n_hits, 6);
+    ASSERT_EQ(counter.ts_sum, 4 * 0x19a2 + 2 * 0x1a2);
+    ASSERT_EQ(counter.n_ts_msb, 2);
+    ASSERT_EQ(counter.n_other, 2);
+
+    // no-op visitor, e.g. to only update the counters
+    memrdr.seek(0);
+    decoder.seek(0);
+    decoder.decode_frame(geri::frame_visitor{});
+    ASSERT_EQ(decoder.get_counters().frames, 3);
+}
+
+TEST(TestGeri, HitFilter)
+{
+    geri::hit_filter filter;
+    ASSERT_TRUE(filter.accepts_all());
+    ASSERT_TRUE(filter.accepts(0xff, 127, 0));
+
+    filter.select_gbt(1).select_addr(0x05).select_channels(10, 20).select_channels(100, 200).set_min_adc(4);
+    ASSERT_FALSE(filter.accepts_all());
+    ASSERT_TRUE(filter.accepts(0x20, 10, 4));
+    ASSERT_TRUE(filter.accepts(0x3f, 20, 31));
+    ASSERT_TRUE(filter.accepts(0x05, 127, 4));
+    ASSERT_FALSE(filter.accepts(0x40, 10, 4));
+    ASSERT_FALSE(filter.accepts(0x04, 10, 4));
+    ASSERT_FALSE(filter.accepts(0x20, 21, 4));
+    ASSERT_FALSE(filter.accepts(0x20, 99, 4));
+    ASSERT_FALSE(filter.accepts(0x20, 10, 3));
+    ASSERT_TRUE(filter.accepts_frame(true));
+
+    filter.set_skip_data_dropped();
+    ASSERT_FALSE(filter.accepts_frame(true));
+    ASSERT_TRUE(filter.accepts_frame(false));
+}
+
+TEST(TestGeri, DecodeWithHitFilter)
+{
+    geri::generator_options options;
+    options.n_gbts = 2;
+    options.mean_hits = 50;
+    options.data_dropped_ratio = 0.2;
+    auto words = geri::stream_generator(options).generate(200);
+
+    geri::hit_filter filter;
+    filter.select_addr(0x01).select_gbt(1).select_channels(0, 63).set_min_adc(8).set_skip_data_dropped();
+
+    geri::memory_reader all_rdr(words.data(), words.size());
+    auto all_decoder = geri::payload_decoder<geri::memory_reader>(&all_rdr);
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+    decoder.set_filter(filter);
+    geri::memory_reader columns_rdr(words.data(), words.size());
+    auto columns_decoder = geri::payload_decoder<geri::memory_reader>(&columns_rdr);
+    columns_decoder.set_filter(filter);
+
+    std::size_t n_rejected{0};
+    geri::payload_frame all_frame;
+    geri::payload_frame frame;
+    geri::columnar_frame columns;
+    while (all_decoder.try_decode_frame(all_frame) != geri::DECODE_STATUS::end_of_data)
+    {
+        ASSERT_EQ(decoder.try_decode_frame(frame), geri::DECODE_STATUS::ok);
+        ASSERT_EQ(frame.event_no, all_frame.event_no);
+        ASSERT_EQ(frame.data_dropped, all_frame.data_dropped);
+
+        std::vector<geri::gbt_hit> expected;
+        for (const auto& hit : all_frame.hits)
+        {
+            if (!all_frame.data_dropped and filter.accepts(hit.unique_addr, hit.channel, hit.adc))
+            {
+                expected.push_back(hit);
+            }
+        }
+        n_rejected += all_frame.hits.size() - expected.size();
+
+        ASSERT_EQ(frame.hits.size(), expected.size());
+        for (std::size_t idx = 0; idx < expected.size(); ++idx)
+        {
+            ASSERT_EQ(frame.hits[idx].unique_addr, expected[idx].unique_addr);
+            ASSERT_EQ(frame.hits[idx].channel, expected[idx].channel);
+            ASSERT_EQ(frame.hits[idx].adc, expected[idx].adc);
+            ASSERT_EQ(frame.hits[idx].full_ts, expected[idx].full_ts);
+        }
+
+        ASSERT_EQ(columns_decoder.try_decode_frame(columns), geri::DECODE_STATUS::ok);
+        ASSERT_TRUE(std::equal(columns.begin(), columns.end(), expected.begin(), expected.end(),
+                               [](const geri::gbt_hit& lhs, const geri::gbt_hit& rhs)
+                               {
+                                   return lhs.unique_addr == rhs.unique_addr and lhs.channel == rhs.channel and
+                                          lhs.adc == rhs.adc and lhs.full_ts == rhs.full_ts and
+                                          lhs.event_missing == rhs.event_missing;
+                               }));
+    }
+    ASSERT_EQ(decoder.try_decode_frame(frame), geri::DECODE_STATUS::end_of_data);
+
+    auto counters = decoder.get_counters().total();
+    ASSERT_GT(n_rejected, 0);
+    ASSERT_EQ(counters.filtered, n_rejected);
+    ASSERT_EQ(counters.hits(), all_decoder.get_counters().total().hits() - n_rejected);
+}
+
+TEST(TestGeri, DecodeWithTsMsbCrc)
+{
+    geri::generator_options options;
+    options.n_gbts = 2;
+    options.mean_hits = 20;
+    options.crc_error_ratio = 0.05;
+    geri::stream_generator gen(options);
+    auto words = gen.generate(200);
+    const auto& stats = gen.stats();
+    ASSERT_GT(stats.crc_errors, 0);
+
+    auto decode = [&words](bool check_crc)
+    {
+        geri::memory_reader rdr(words.data(), words.size());
+        auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+        decoder.set_ts_msb_crc_check(check_crc);
+
+        geri::payload_frame frame;
+        while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+        {
+        }
+        return decoder.get_counters().total();
+    };
+
+    // only the CRC bits are corrupted, so the words decode fine without the check
+    auto unchecked = decode(false);
+    ASSERT_EQ(unchecked.crc_errors, 0);
+    ASSERT_EQ(unchecked.invalid_ts_msb, 0);
+    ASSERT_EQ(unchecked.hits(), stats.hits);
+
+    auto checked = decode(true);
+    ASSERT_EQ(checked.crc_errors, stats.crc_errors);
+    ASSERT_EQ(checked.invalid_ts_msb, 0);
+    ASSERT_EQ(checked.hits() + checked.ts_mismatch, stats.hits);
+}
+
+TEST(TestGeri, MarkersFind)
+{
+    std::mt19937_64 gen(7);
+    std::vector<uint64_t> words(1000);
+    for (auto& word : words)
+    {
+        // loose mask match must not be a candidate
+        word = gen() | geri::markers::start;
+        if (static_cast<uint32_t>(word) == geri::markers::start) { word ^= 0x1; }
+    }
+    words[517] = (uint64_t{0x77} << 32) | geri::markers::start;
+    words[998] = geri::markers::start;
+
+    for (auto level : {geri::smx::SIMD_LEVEL::scalar, geri::smx::SIMD_LEVEL::sse4, geri::smx::SIMD_LEVEL::avx2,
+                       geri::smx::SIMD_LEVEL::avx512})
+    {
+        if (level > geri::smx::detect_simd_level()) { continue; }
+
+        auto kernel = geri::markers::get_find_kernel(level);
+        for (std::size_t first = 0; first < 20; ++first)
+        {
+            ASSERT_EQ(kernel(words.data() + first, words.data() + words.size(), geri::markers::start),
+                      words.data() + 517);
+        }
+        ASSERT_EQ(kernel(words.data() + 518, words.data() + words.size(), geri::markers::start), words.data() + 998);
+        ASSERT_EQ(kernel(words.data() + 518, words.data() + 998, geri::markers::start), words.data() + 998);
+        ASSERT_EQ(kernel(words.data(), words.data() + 517, geri::markers::start), words.data() + 517);
+    }
+}
+
+TEST(TestGeri, MarkersResync)
+{
+    // garbage with a start marker candidate not followed by the frame header, then two frames
+    std::vector<uint64_t> stream{0x1, 0x2, (uint64_t{9} << 32) | geri::markers::start, 0x3, 0x4, 0x5, 0x6};
+    auto frames = make_test_stream();
+    stream.insert(stream.end(), frames.begin(), frames.end());
+
+    ASSERT_EQ(geri::markers::find_frame_start({stream.data(), stream.size()}), 7);
+    ASSERT_EQ(geri::markers::find_frame_start({frames.data() + 1, frames.size() - 1}), frames.size() / 2 - 1);
+    ASSERT_EQ(geri::markers::find_frame_start({frames.data() + 1, frames.size() - 2}), frames.size() - 2);
+    ASSERT_EQ(geri::markers::find_frame_start({stream.data(), 10}), 10);
+
+    // only the first stop marker is checked, and the frame ends at the next frame start
+    auto mismatch = make_frame(4, 0x200, 0x300, {(uint64_t{7} << 32) | geri::markers::stop});
+    mismatch.insert(mismatch.end(), frames.begin(), frames.end());
+    ASSERT_FALSE(geri::markers::valid_frame(mismatch.data(), mismatch.data() + mismatch.size()));
+    ASSERT_EQ(geri::markers::find_frame_start({mismatch.data(), mismatch.size()}), 9);
+    auto lost = frames;
+    lost[frames.size() / 2 - 4] = 0x0;
+    ASSERT_FALSE(geri::markers::valid_frame(lost.data(), lost.data() + lost.size()));
+    ASSERT_EQ(geri::markers::find_frame_start({lost.data(), lost.size()}), frames.size() / 2);
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+    word_reader wrdr(stream);
+    auto word_decoder = geri::payload_decoder<word_reader>(&wrdr);
+
+    ASSERT_EQ(decoder.decode_frame().event_no, 1);
+    ASSERT_EQ(decoder.decode_frame().event_no, 2);
+    auto counters = decoder.get_counters();
+    ASSERT_EQ(counters.resyncs, 1);
+    ASSERT_EQ(counters.skipped_bytes, 7 * 8);
+    ASSERT_EQ(counters.false_markers, 1);
+
+    // per-word readers are read ahead to check the header
+    ASSERT_EQ(word_decoder.decode_frame().event_no, 1);
+    ASSERT_EQ(word_decoder.decode_frame().event_no, 2);
+    ASSERT_EQ(word_decoder.get_counters().resyncs, 1);
+    ASSERT_EQ(word_decoder.get_counters().skipped_bytes, 7 * 8);
+    ASSERT_EQ(word_decoder.get_counters().false_markers, 1);
+    ASSERT_EQ(word_decoder.get_counters().invalid_frames, 0);
+
+    // the candidate at the end of the block is checked after reading its header
+    std::vector<uint64_t> split{0x1, (uint64_t{9} << 32) | geri::markers::start};
+    split.insert(split.end(), stream.begin() + 3, stream.end());
+    struct split_reader : geri::memory_reader
+    {
+        using geri::memory_reader::memory_reader;
+        bool first{true};
+
+        auto read_block() -> geri::span<const uint64_t>
+        {
+            auto block = geri::memory_reader::read_block();
+            if (first and !block.empty())
+            {
+                first = false;
+                seek(2 * sizeof(uint64_t));
+                return {block.data(), 2};
+            }
+            return block;
+        }
+    };
+    split_reader split_rdr(split.data(), split.size());
+    auto split_decoder = geri::payload_decoder<split_reader>(&split_rdr);
+    ASSERT_EQ(split_decoder.decode_frame().event_no, 1);
+    ASSERT_EQ(split_decoder.get_counters().resyncs, 1);
+    ASSERT_EQ(split_decoder.get_counters().skipped_bytes, 6 * 8);
+    ASSERT_EQ(split_decoder.get_counters().false_markers, 1);
+    ASSERT_EQ(split_decoder.get_counters().invalid_frames, 0);
+}
+
+TEST(TestGeri, LostTrailer)
+{
+    // stop marker of event 10 is lost, its frame runs into the next one
+    geri::generator_options options;
+    options.mean_hits = 32;
+    auto stream = geri::stream_generator(options).generate(100);
+    auto lost = std::find(stream.begin(), stream.end(), (uint64_t{10} << 32) | geri::markers::stop);
+    ASSERT_NE(lost, stream.end());
+    *lost = 0x0;
+
+    auto check = [](auto& decoder)
+    {
+        geri::payload_frame frame;
+        std::vector<uint32_t> events;
+        std::size_t invalid{0};
+        while (true)
+        {
+            auto status = decoder.try_decode_frame(frame);
+            if (status == geri::DECODE_STATUS::end_of_data) { break; }
+            if (status == geri::DECODE_STATUS::invalid_frame)
+            {
+                ++invalid;
+                continue;
+            }
+            ASSERT_EQ(status, geri::DECODE_STATUS::ok);
+            events.push_back(frame.event_no);
+        }
+
+        ASSERT_EQ(invalid, 1);
+        ASSERT_EQ(events.size(), 99);
+        ASSERT_EQ(events[8], 9);
+        ASSERT_EQ(events[9], 11);
+        ASSERT_EQ(events.back(), 100);
+        ASSERT_EQ(decoder.get_counters().invalid_frames, 1);
+        ASSERT_EQ(decoder.get_counters().resyncs, 0);
+    };
+
+    geri::memory_reader memrdr(stream.data(), stream.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&memrdr);
+    check(decoder);
+
+    word_reader wrdr(stream);
+    auto word_decoder = geri::payload_decoder<word_reader>(&wrdr);
+    check(word_decoder);
 }
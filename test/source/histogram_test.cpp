@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/generator.hpp"
+#include "geri-smx-decoder/histogram.hpp"
+#include "geri-smx-decoder/pipeline.hpp"
+
+#include <atomic>
+#include <map>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+auto generate_words(uint64_t seed) -> std::vector<uint64_t>
+{
+    geri::generator_options options;
+    options.n_gbts = 2;
+    options.mean_hits = 50;
+    options.seed = seed;
+    return geri::stream_generator(options).generate(500);
+}
+
+using bin_key = std::tuple<uint8_t, uint8_t, uint8_t>;
+
+auto count_hits(const std::vector<uint64_t>& words, std::map<bin_key, uint64_t>& counts) -> uint64_t
+{
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+
+    uint64_t n_frames{0};
+    geri::payload_frame frame;
+    while (decoder.try_decode_frame(frame) != geri::DECODE_STATUS::end_of_data)
+    {
+        for (const auto& hit : frame.hits)
+        {
+            ++counts[bin_key{hit.unique_addr, hit.channel, hit.adc}];
+        }
+        ++n_frames;
+    }
+    return n_frames;
+}
+
+} // namespace
+
+TEST(TestHistogram, Visitor)
+{
+    auto words = generate_words(1);
+    std::map<bin_key, uint64_t> expected;
+    auto n_frames = count_hits(words, expected);
+
+    geri::hit_histograms histograms;
+    auto& acc = histograms.make_accumulator();
+
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+    while (decoder.try_decode_frame(acc) != geri::DECODE_STATUS::end_of_data)
+    {
+    }
+
+    auto snap = histograms.snapshot();
+    ASSERT_EQ(snap.frames(), n_frames);
+
+    uint64_t n_hits{0};
+    for (const auto& entry : expected)
+    {
+        ASSERT_EQ(snap.adc(std::get<0>(entry.first), std::get<1>(entry.first), std::get<2>(entry.first)),
+                  entry.second);
+        n_hits += entry.second;
+    }
+    ASSERT_EQ(snap.total_hits(), n_hits);
+
+    const auto& first = expected.begin()->first;
+    uint64_t channel_hits{0};
+    for (auto count : snap.spectrum(std::get<0>(first), std::get<1>(first)))
+    {
+        channel_hits += count;
+    }
+    ASSERT_EQ(snap.hits(std::get<0>(first), std::get<1>(first)), channel_hits);
+    ASSERT_EQ(snap.hits(std::get<0>(first))[std::get<1>(first)], channel_hits);
+    ASSERT_DOUBLE_EQ(snap.rate(std::get<0>(first), std::get<1>(first)),
+                     static_cast<double>(channel_hits) / static_cast<double>(n_frames));
+}
+
+TEST(TestHistogram, Frames)
+{
+    geri::hit_histograms histograms;
+    auto& acc = histograms.make_accumulator();
+
+    geri::payload_frame frame;
+    geri::gbt_hit hit{geri::gbt::get_gbt_uplink_addr(0x05U << 24)};
+    hit.channel = 127;
+    hit.adc = 31;
+    frame.hits.push_back(hit);
+    hit.channel = 3;
+    frame.hits.push_back(hit);
+    acc.fill(frame);
+
+    geri::columnar_frame columnar;
+    for (const auto& fhit : frame.hits)
+    {
+        columnar.push_back(fhit);
+    }
+    acc.fill(columnar);
+
+    geri::arena_payload_frame arena_frame;
+    arena_frame.hits.assign(frame.hits.begin(), frame.hits.end());
+    acc(arena_frame);
+
+    auto snap = histograms.snapshot();
+    ASSERT_EQ(snap.frames(), 3);
+    ASSERT_EQ(snap.adc(0x05, 127, 31), 3);
+    ASSERT_EQ(snap.adc(0x05, 3, 31), 3);
+    ASSERT_EQ(snap.hits(0x05, 126), 0);
+    ASSERT_EQ(snap.total_hits(), 6);
+}
+
+TEST(TestHistogram, Threads)
+{
+    std::vector<std::vector<uint64_t>> inputs{generate_words(1), generate_words(2), generate_words(3)};
+    std::map<bin_key, uint64_t> expected;
+    uint64_t n_frames{0};
+    for (const auto& words : inputs)
+    {
+        n_frames += count_hits(words, expected);
+    }
+
+    geri::hit_histograms histograms;
+    std::atomic<unsigned> running{static_cast<unsigned>(inputs.size())};
+    std::vector<std::thread> threads;
+    for (const auto& words : inputs)
+    {
+        auto& acc = histograms.make_accumulator();
+        threads.emplace_back(
+            [&words, &acc, &running]()
+            {
+                geri::memory_reader rdr(words.data(), words.size());
+                geri::pipeline<geri::memory_reader> pipe(&rdr);
+                pipe.run(acc);
+                running.fetch_sub(1);
+            });
+    }
+
+    // snapshots taken while decoding never go back
+    uint64_t last_frames{0};
+    uint64_t last_hits{0};
+    while (running.load() != 0)
+    {
+        auto snap = histograms.snapshot();
+        ASSERT_GE(snap.frames(), last_frames);
+        ASSERT_GE(snap.total_hits(), last_hits);
+        last_frames = snap.frames();
+        last_hits = snap.total_hits();
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(histograms.size(), 3);
+    auto snap = histograms.snapshot();
+    ASSERT_EQ(snap.frames(), n_frames);
+    for (const auto& entry : expected)
+    {
+        ASSERT_EQ(snap.adc(std::get<0>(entry.first), std::get<1>(entry.first), std::get<2>(entry.first)),
+                  entry.second);
+    }
+}
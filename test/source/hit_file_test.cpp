@@ -0,0 +1,298 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/generator.hpp"
+#include "geri-smx-decoder/hit_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+auto decode_frames() -> std::vector<geri::payload_frame>
+{
+    geri::generator_options options;
+    options.mean_hits = 20;
+    options.data_dropped_ratio = 0.1;
+    auto words = geri::stream_generator(options).generate(1000);
+
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+
+    std::vector<geri::payload_frame> frames;
+    geri::payload_frame frame;
+    for (auto status = decoder.try_decode_frame(frame); status != geri::DECODE_STATUS::end_of_data;
+         status = decoder.try_decode_frame(frame))
+    {
+        if (status == geri::DECODE_STATUS::ok) { frames.push_back(frame); }
+    }
+
+    return frames;
+}
+
+auto write_frames(const std::string& filename, const std::vector<geri::payload_frame>& frames) -> void
+{
+    geri::hit_file_options options;
+    options.frames_per_chunk = 300;
+
+    geri::hit_file_writer writer(filename.c_str(), options);
+    for (const auto& frame : frames)
+    {
+        writer.write(frame);
+    }
+    ASSERT_TRUE(writer.close());
+    ASSERT_EQ(writer.chunks(), (frames.size() + 299) / 300);
+}
+
+} // namespace
+
+TEST(TestHitFile, WriteRead)
+{
+    auto frames = decode_frames();
+    auto filename = testing::TempDir() + "hit_file_test.hits";
+    write_frames(filename, frames);
+
+    geri::hit_file_reader rdr(filename.c_str());
+    ASSERT_TRUE(rdr.valid());
+    ASSERT_EQ(rdr.frames(), frames.size());
+
+    uint64_t n_hits{0};
+    geri::columnar_frame frame;
+    for (const auto& expected : frames)
+    {
+        ASSERT_TRUE(rdr.try_read_frame(frame));
+        ASSERT_EQ(frame.event_no, expected.event_no);
+        ASSERT_EQ(frame.system_ts, expected.system_ts);
+        ASSERT_EQ(frame.data_dropped, expected.data_dropped);
+        ASSERT_EQ(frame.size(), expected.hits.size());
+
+        for (std::size_t idx = 0; idx < frame.size(); ++idx)
+        {
+            auto hit = frame.hit(idx);
+            ASSERT_EQ(hit.unique_addr, expected.hits[idx].unique_addr);
+            ASSERT_EQ(hit.gbt, expected.hits[idx].gbt);
+            ASSERT_EQ(hit.uplink, expected.hits[idx].uplink);
+            ASSERT_EQ(hit.channel, expected.hits[idx].channel);
+            ASSERT_EQ(hit.adc, expected.hits[idx].adc);
+            ASSERT_EQ(hit.full_ts, expected.hits[idx].full_ts);
+            ASSERT_EQ(hit.event_missing, expected.hits[idx].event_missing);
+        }
+        n_hits += frame.size();
+    }
+    ASSERT_FALSE(rdr.try_read_frame(frame));
+    ASSERT_EQ(rdr.hits(), n_hits);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestHitFile, WriteArenaFrames)
+{
+    auto frames = decode_frames();
+    auto filename = testing::TempDir() + "hit_file_arena.hits";
+    {
+        geri::hit_file_writer writer(filename.c_str());
+        geri::arena_payload_frame arena_frame;
+        for (const auto& frame : frames)
+        {
+            arena_frame.event_no = frame.event_no;
+            arena_frame.system_ts = frame.system_ts;
+            arena_frame.data_dropped = frame.data_dropped;
+            arena_frame.hits.assign(frame.hits.begin(), frame.hits.end());
+            writer.write(arena_frame);
+        }
+        ASSERT_TRUE(writer.close());
+    }
+
+    geri::hit_file_reader rdr(filename.c_str());
+    ASSERT_EQ(rdr.frames(), frames.size());
+
+    geri::columnar_frame frame;
+    for (const auto& expected : frames)
+    {
+        ASSERT_TRUE(rdr.try_read_frame(frame));
+        ASSERT_EQ(frame.event_no, expected.event_no);
+        ASSERT_EQ(frame.size(), expected.hits.size());
+        for (std::size_t idx = 0; idx < frame.size(); ++idx)
+        {
+            ASSERT_EQ(frame.full_ts()[idx], expected.hits[idx].full_ts);
+        }
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestHitFile, ChunkStats)
+{
+    auto frames = decode_frames();
+    auto filename = testing::TempDir() + "hit_file_stats.hits";
+    write_frames(filename, frames);
+
+    geri::hit_file_reader rdr(filename.c_str());
+    ASSERT_EQ(rdr.chunks(), 4);
+
+    const auto& stats = rdr.stats(1);
+    ASSERT_EQ(stats.n_frames, 300);
+    ASSERT_EQ(stats.first_event_no, frames[300].event_no);
+    ASSERT_EQ(stats.last_event_no, frames[599].event_no);
+    ASSERT_EQ(rdr.stats(3).n_frames, frames.size() - 900);
+
+    uint32_t dropped{0};
+    uint64_t n_hits{0};
+    uint8_t max_adc{0};
+    for (std::size_t idx = 300; idx < 600; ++idx)
+    {
+        dropped += frames[idx].data_dropped ? 1U : 0U;
+        for (const auto& hit : frames[idx].hits)
+        {
+            ASSERT_TRUE(stats.has_addr(hit.unique_addr));
+            max_adc = std::max(max_adc, hit.adc);
+            ++n_hits;
+        }
+    }
+    ASSERT_EQ(stats.dropped_frames, dropped);
+    ASSERT_EQ(stats.n_hits, n_hits);
+    ASSERT_EQ(stats.max_adc, max_adc);
+    ASSERT_FALSE(stats.has_addr(0xff));
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestHitFile, Projection)
+{
+    auto frames = decode_frames();
+    auto filename = testing::TempDir() + "hit_file_projection.hits";
+    write_frames(filename, frames);
+
+    geri::hit_file_reader rdr(filename.c_str(), geri::hit_file_reader::adc | geri::hit_file_reader::event_no);
+
+    auto chunk = rdr.chunk(2);
+    ASSERT_EQ(chunk.event_no.size(), 300);
+    ASSERT_EQ(chunk.adc.size(), chunk.stats->n_hits);
+    ASSERT_TRUE(chunk.system_ts.empty());
+    ASSERT_TRUE(chunk.full_ts.empty());
+    ASSERT_EQ(chunk.event_no[0], frames[600].event_no);
+    ASSERT_EQ(chunk.adc[0], frames[600].hits[0].adc);
+
+    rdr.seek_chunk(3);
+    geri::columnar_frame frame;
+    ASSERT_TRUE(rdr.try_read_frame(frame));
+    ASSERT_EQ(frame.event_no, frames[900].event_no);
+    ASSERT_EQ(frame.system_ts, 0);
+    ASSERT_EQ(frame.size(), frames[900].hits.size());
+    ASSERT_EQ(frame.adc()[0], frames[900].hits[0].adc);
+    ASSERT_EQ(frame.full_ts()[0], 0);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestHitFile, Truncated)
+{
+    auto frames = decode_frames();
+    auto filename = testing::TempDir() + "hit_file_truncated.hits";
+    write_frames(filename, frames);
+
+    // cut in the middle of the last chunk
+    off_t last_chunk{0};
+    {
+        geri::hit_file_reader full(filename.c_str());
+        const auto* first = reinterpret_cast<const char*>(full.chunk(0).stats);
+        last_chunk = reinterpret_cast<const char*>(full.chunk(3).stats) - first;
+    }
+    ASSERT_EQ(truncate(filename.c_str(), last_chunk + 200), 0);
+
+    geri::hit_file_reader rdr(filename.c_str());
+    ASSERT_TRUE(rdr.valid());
+    ASSERT_EQ(rdr.chunks(), 3);
+    ASSERT_EQ(rdr.frames(), 900);
+
+    std::remove(filename.c_str());
+
+    std::vector<uint64_t> garbage(10, 0x1234);
+    filename = testing::TempDir() + "hit_file_garbage.hits";
+    auto* fp = std::fopen(filename.c_str(), "wb");
+    std::fwrite(garbage.data(), sizeof(uint64_t), garbage.size(), fp);
+    std::fclose(fp);
+
+    geri::hit_file_reader invalid(filename.c_str());
+    ASSERT_FALSE(invalid.valid());
+    ASSERT_EQ(invalid.chunks(), 0);
+    geri::columnar_frame frame;
+    ASSERT_FALSE(invalid.try_read_frame(frame));
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestHitFile, CorruptChunk)
+{
+    auto frames = decode_frames();
+    auto filename = testing::TempDir() + "hit_file_corrupt.hits";
+    write_frames(filename, frames);
+
+    std::vector<unsigned char> bytes;
+    {
+        auto* fp = std::fopen(filename.c_str(), "rb");
+        unsigned char buf[4096];
+        for (auto n = std::fread(buf, 1, sizeof(buf), fp); n != 0; n = std::fread(buf, 1, sizeof(buf), fp))
+        {
+            bytes.insert(bytes.end(), buf, buf + n);
+        }
+        std::fclose(fp);
+    }
+
+    // the third chunk
+    auto chunk_offset = sizeof(geri::detail::hit_file_header);
+    for (int idx = 0; idx < 2; ++idx)
+    {
+        geri::detail::hit_chunk_header header{};
+        std::memcpy(&header, bytes.data() + chunk_offset, sizeof(header));
+        chunk_offset += header.size;
+    }
+
+    using corruption = void (*)(geri::detail::hit_chunk_header&, unsigned char*);
+    const std::vector<corruption> corruptions = {
+        [](geri::detail::hit_chunk_header& header, unsigned char*) { header.size = 0; },
+        [](geri::detail::hit_chunk_header& header, unsigned char*) { header.size = 12; },
+        [](geri::detail::hit_chunk_header& header, unsigned char*) { header.size -= 4; },
+        [](geri::detail::hit_chunk_header& header, unsigned char*) { header.offsets[7] = header.size - 8; },
+        [](geri::detail::hit_chunk_header& header, unsigned char*) { header.offsets[1] = 4; },
+        [](geri::detail::hit_chunk_header& header, unsigned char*) { header.stats.n_hits = uint64_t{1} << 62U; },
+        [](geri::detail::hit_chunk_header& header, unsigned char* chunk)
+        {
+            uint32_t count{0};
+            std::memcpy(&count, chunk + header.offsets[3], sizeof(count));
+            ++count;
+            std::memcpy(chunk + header.offsets[3], &count, sizeof(count));
+        },
+    };
+
+    for (auto corrupt : corruptions)
+    {
+        auto corrupted = bytes;
+        geri::detail::hit_chunk_header header{};
+        std::memcpy(&header, corrupted.data() + chunk_offset, sizeof(header));
+        corrupt(header, corrupted.data() + chunk_offset);
+        std::memcpy(corrupted.data() + chunk_offset, &header, sizeof(header));
+
+        auto* fp = std::fopen(filename.c_str(), "wb");
+        std::fwrite(corrupted.data(), 1, corrupted.size(), fp);
+        std::fclose(fp);
+
+        // read up to the corrupted chunk
+        geri::hit_file_reader rdr(filename.c_str());
+        ASSERT_TRUE(rdr.valid());
+        ASSERT_EQ(rdr.chunks(), 2);
+        ASSERT_EQ(rdr.frames(), 600);
+
+        std::size_t n_frames{0};
+        geri::columnar_frame frame;
+        while (rdr.try_read_frame(frame))
+        {
+            ++n_frames;
+        }
+        ASSERT_EQ(n_frames, 600);
+    }
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/parallel_decoder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Build stream of frames, ts_msb of each uplink is sent only every few frames, so the state must carry across
+ * frames and chunks.
+ */
+auto make_stream(uint32_t n_frames) -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> stream;
+    uint64_t systime = 0x100;
+
+    for (uint32_t evt = 1; evt <= n_frames; ++evt)
+    {
+        stream.insert(stream.end(), {(uint64_t{evt} << 32) | 0x579acce7, systime, 0x0, 0x0});
+
+        auto ts = (evt / 7) & 0x3f;
+        if (evt % 7 == 0)
+        {
+            // ts_msb for uplinks 0x08 and 0x29
+            uint32_t ts_msb = 0xc00000 | (ts << 16) | (ts << 10) | (ts << 4);
+            stream.push_back((uint64_t{0x29000000 | ts_msb} << 32) | (0x08000000 | ts_msb));
+        }
+
+        // hits with ts<9:8> matching the current ts_msb
+        uint32_t hit = ((evt % 64) << 16) | (0x4 << 11) | (((ts & 0x3) << 8 | (evt & 0xff)) << 1);
+        for (uint32_t n = 0; n < evt % 5; ++n)
+        {
+            stream.push_back((uint64_t{0x29000000 | hit} << 32) | (0x08000000 | hit));
+        }
+
+        systime += 0x100;
+        stream.insert(stream.end(), {(uint64_t{evt} << 32) | 0xed9acce7, systime, 0x0, 0x0});
+    }
+
+    return stream;
+}
+
+auto decode_sequential(const std::vector<uint64_t>& stream) -> std::vector<geri::payload_frame>
+{
+    geri::memory_reader reader(stream.data(), stream.size());
+    geri::payload_decoder<geri::memory_reader> decoder(&reader);
+
+    std::vector<geri::payload_frame> frames;
+    try
+    {
+        while (true)
+        {
+            frames.push_back(decoder.decode_frame());
+        }
+    }
+    catch (const std::out_of_range&)
+    {
+    }
+    return frames;
+}
+
+} // namespace
+
+TEST(TestParallelDecoder, OrderedMatchesSequential)
+{
+    auto stream = make_stream(1000);
+    auto reference = decode_sequential(stream);
+    ASSERT_EQ(reference.size(), 1000);
+
+    geri::parallel_options options;
+    options.n_threads = 4;
+    options.frames_per_chunk = 16;
+    options.max_pending_chunks = 3;
+
+    geri::parallel_decoder pdec({stream.data(), stream.size()}, nullptr, options);
+    ASSERT_EQ(pdec.index().size(), 1000);
+
+    std::size_t idx = 0;
+    auto n_frames = pdec.run(
+        [&](geri::payload_frame& frame)
+        {
+            const auto& expected = reference[idx++];
+            ASSERT_EQ(frame.event_no, expected.event_no);
+            ASSERT_EQ(frame.system_ts, expected.system_ts);
+            ASSERT_EQ(frame.hits.size(), expected.hits.size());
+            for (std::size_t hit = 0; hit < frame.hits.size(); ++hit)
+            {
+                ASSERT_EQ(frame.hits[hit].full_ts, expected.hits[hit].full_ts);
+                ASSERT_EQ(frame.hits[hit].unique_addr, expected.hits[hit].unique_addr);
+            }
+        });
+
+    ASSERT_EQ(n_frames, 1000);
+    ASSERT_EQ(idx, 1000);
+}
+
+TEST(TestParallelDecoder, Unordered)
+{
+    auto stream = make_stream(500);
+
+    geri::parallel_options options;
+    options.n_threads = 3;
+    options.ordered = false;
+    options.frames_per_chunk = 7;
+
+    geri::parallel_decoder pdec({stream.data(), stream.size()}, nullptr, options);
+
+    std::vector<int> seen(501, 0);
+    auto n_frames = pdec.run([&](geri::payload_frame& frame) { seen[frame.event_no]++; });
+
+    ASSERT_EQ(n_frames, 500);
+    for (uint32_t evt = 1; evt <= 500; ++evt)
+    {
+        ASSERT_EQ(seen[evt], 1);
+    }
+
+    // the decoder can be run again
+    ASSERT_EQ(pdec.run([](geri::payload_frame&) {}), 500);
+}
+
+TEST(TestParallelDecoder, ConsumerException)
+{
+    auto stream = make_stream(200);
+
+    geri::parallel_options options;
+    options.n_threads = 2;
+    options.frames_per_chunk = 5;
+
+    geri::parallel_decoder pdec({stream.data(), stream.size()}, nullptr, options);
+    ASSERT_THROW(pdec.run(
+                     [](geri::payload_frame& frame)
+                     {
+                         if (frame.event_no == 50) { throw std::runtime_error("stop"); }
+                     }),
+                 std::runtime_error);
+}
+
+TEST(TestParallelDecoder, BrokenFrame)
+{
+    auto stream = make_stream(200);
+
+    // unexpected words in the trailers of the last frame of a chunk and the first frame of the next one
+    for (uint64_t evt : {40U, 41U})
+    {
+        auto stop = std::find(stream.begin(), stream.end(), (evt << 32) | 0xed9acce7);
+        ASSERT_NE(stop, stream.end());
+        *(stop + 2) = 0x1234;
+    }
+
+    geri::parallel_options options;
+    options.n_threads = 2;
+    options.frames_per_chunk = 5;
+
+    geri::parallel_decoder pdec({stream.data(), stream.size()}, nullptr, options);
+    ASSERT_EQ(pdec.index().size(), 200);
+
+    std::vector<uint32_t> events;
+    auto n_frames = pdec.run([&](geri::payload_frame& frame) { events.push_back(frame.event_no); });
+
+    ASSERT_EQ(n_frames, 198);
+    ASSERT_EQ(pdec.invalid_frames(), 2);
+    ASSERT_EQ(events[38], 39);
+    ASSERT_EQ(events[39], 42);
+    ASSERT_EQ(events.back(), 200);
+}
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/pipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Build stream of frames with ts_msb and a few hits of uplink 0x08 in each frame.
+ */
+auto make_stream(uint32_t n_frames) -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> stream;
+    uint64_t systime = 0x100;
+
+    for (uint32_t evt = 1; evt <= n_frames; ++evt)
+    {
+        stream.insert(stream.end(), {(uint64_t{evt} << 32) | 0x579acce7, systime, 0x0, 0x0});
+        for (uint32_t n = 0; n < evt % 4; ++n)
+        {
+            stream.push_back(0x08012345'08d96590);
+        }
+        systime += 0x100;
+        stream.insert(stream.end(), {(uint64_t{evt} << 32) | 0xed9acce7, systime, 0x0, 0x0});
+    }
+
+    return stream;
+}
+
+/**
+ * Reader which provides only the per-word interface.
+ */
+class word_reader
+{
+public:
+    explicit word_reader(const std::vector<uint64_t>& words) : m_words{words} {}
+
+    auto read_word() -> uint64_t
+    {
+        if (m_pos == m_words.size()) { throw std::out_of_range("END OF DATA"); }
+        return m_words[m_pos++];
+    }
+
+private:
+    const std::vector<uint64_t>& m_words;
+    std::size_t m_pos{0};
+};
+
+auto small_options() -> geri::pipeline_options
+{
+    geri::pipeline_options options;
+    options.block_words = 13;
+    options.n_blocks = 2;
+    options.n_frames = 2;
+    return options;
+}
+
+} // namespace
+
+TEST(TestPipeline, SpscRing)
+{
+    geri::spsc_ring<int> ring(5);
+    ASSERT_EQ(ring.capacity(), 8);
+
+    int value = 0;
+    ASSERT_FALSE(ring.try_pop(value));
+    for (value = 0; value < 8; ++value)
+    {
+        ASSERT_TRUE(ring.try_push(value));
+    }
+    ASSERT_FALSE(ring.try_push(value));
+    ASSERT_EQ(ring.size(), 8);
+
+    ASSERT_TRUE(ring.try_pop(value));
+    ASSERT_EQ(value, 0);
+
+    geri::spsc_ring<int> transfer(16);
+    static const int n_items{100000};
+    std::thread producer(
+        [&transfer]()
+        {
+            for (int item = 0; item < n_items; ++item)
+            {
+                while (!transfer.try_push(item))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    for (int expected = 0; expected < n_items; ++expected)
+    {
+        int item = -1;
+        while (!transfer.try_pop(item))
+        {
+            std::this_thread::yield();
+        }
+        ASSERT_EQ(item, expected);
+    }
+    producer.join();
+}
+
+TEST(TestPipeline, MatchesSequential)
+{
+    auto stream = make_stream(300);
+
+    geri::memory_reader reference_reader(stream.data(), stream.size());
+    geri::payload_decoder<geri::memory_reader> reference(&reference_reader);
+
+    auto compare = [&](geri::payload_frame& frame)
+    {
+        auto expected = reference.decode_frame();
+        ASSERT_EQ(frame.event_no, expected.event_no);
+        ASSERT_EQ(frame.system_ts, expected.system_ts);
+        ASSERT_EQ(frame.hits.size(), expected.hits.size());
+        for (std::size_t hit = 0; hit < frame.hits.size(); ++hit)
+        {
+            ASSERT_EQ(frame.hits[hit].full_ts, expected.hits[hit].full_ts);
+        }
+    };
+
+    geri::memory_reader mreader(stream.data(), stream.size());
+    geri::pipeline<geri::memory_reader> bulk_pipe(&mreader, small_options());
+    ASSERT_EQ(bulk_pipe.run(compare), 300);
+
+    auto stats = bulk_pipe.stats();
+    ASSERT_EQ(stats.words_read, stream.size());
+    ASSERT_EQ(stats.frames_decoded, 300);
+    ASSERT_EQ(stats.frames_consumed, 300);
+    ASSERT_LE(stats.max_blocks_depth, 2);
+    ASSERT_LE(stats.max_frames_depth, 2);
+
+    reference_reader.seek(0);
+    reference.seek(0);
+
+    word_reader wreader(stream);
+    geri::pipeline<word_reader> word_pipe(&wreader, small_options());
+    ASSERT_EQ(word_pipe.run(compare), 300);
+}
+
+TEST(TestPipeline, SlowConsumer)
+{
+    auto stream = make_stream(50);
+    geri::memory_reader mreader(stream.data(), stream.size());
+    geri::pipeline<geri::memory_reader> pipe(&mreader, small_options());
+
+    auto n_frames =
+        pipe.run([](geri::payload_frame&) { std::this_thread::sleep_for(std::chrono::microseconds(200)); });
+    ASSERT_EQ(n_frames, 50);
+
+    // the decoder is held back by the consumer
+    auto stats = pipe.stats();
+    ASSERT_GT(stats.decoder_stall_ns, 0);
+    ASSERT_EQ(stats.frames_depth, 0);
+}
+
+TEST(TestPipeline, BrokenFrame)
+{
+    auto stream = make_stream(100);
+
+    // unexpected word in the trailer of the event 40
+    auto stop = std::find(stream.begin(), stream.end(), (uint64_t{40} << 32) | 0xed9acce7);
+    ASSERT_NE(stop, stream.end());
+    *(stop + 2) = 0x1234;
+
+    std::vector<uint32_t> events;
+    auto collect = [&events](geri::payload_frame& frame) { events.push_back(frame.event_no); };
+
+    geri::memory_reader mreader(stream.data(), stream.size());
+    geri::pipeline<geri::memory_reader> bulk_pipe(&mreader, small_options());
+    ASSERT_EQ(bulk_pipe.run(collect), 99);
+    ASSERT_EQ(bulk_pipe.stats().frames_invalid, 1);
+    ASSERT_EQ(std::count(events.begin(), events.end(), 40), 0);
+    ASSERT_EQ(events.back(), 100);
+
+    events.clear();
+    word_reader wreader(stream);
+    geri::pipeline<word_reader> word_pipe(&wreader, small_options());
+    ASSERT_EQ(word_pipe.run(collect), 99);
+    ASSERT_EQ(word_pipe.stats().frames_invalid, 1);
+}
+
+TEST(TestPipeline, Stop)
+{
+    auto stream = make_stream(10000);
+    geri::memory_reader mreader(stream.data(), stream.size());
+    geri::pipeline<geri::memory_reader> pipe(&mreader, small_options());
+
+    auto n_frames = pipe.run(
+        [&pipe](geri::payload_frame& frame)
+        {
+            if (frame.event_no == 10) { pipe.stop(); }
+        });
+
+    ASSERT_GE(n_frames, 10);
+    ASSERT_LT(n_frames, 10000);
+}
+
+TEST(TestPipeline, ConsumerException)
+{
+    auto stream = make_stream(100);
+    geri::memory_reader mreader(stream.data(), stream.size());
+    geri::pipeline<geri::memory_reader> pipe(&mreader, small_options());
+
+    ASSERT_THROW(pipe.run(
+                     [](geri::payload_frame& frame)
+                     {
+                         if (frame.event_no == 20) { throw std::runtime_error("stop"); }
+                     }),
+                 std::runtime_error);
+}
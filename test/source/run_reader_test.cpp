@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/run_reader.hpp"
+#include "test_helpers.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using test_helpers::make_stream;
+using test_helpers::small_run_blocks;
+
+/**
+ * Write the stream split at the byte offsets into the files.
+ */
+auto write_run(const std::vector<uint64_t>& stream, const std::vector<std::size_t>& splits) -> std::vector<std::string>
+{
+    const auto* bytes = reinterpret_cast<const unsigned char*>(stream.data());
+    const auto size = stream.size() * sizeof(uint64_t);
+
+    std::vector<std::string> filenames;
+    std::size_t begin{0};
+    for (std::size_t idx = 0; idx <= splits.size(); ++idx)
+    {
+        const auto end = idx < splits.size() ? splits[idx] : size;
+        filenames.push_back(testing::TempDir() + "run_reader_test_" + std::to_string(idx) + ".bin");
+
+        auto* fp = std::fopen(filenames.back().c_str(), "wb");
+        std::fwrite(bytes + begin, 1, end - begin, fp);
+        std::fclose(fp);
+        begin = end;
+    }
+    return filenames;
+}
+
+auto remove_run(const std::vector<std::string>& filenames) -> void
+{
+    for (const auto& filename : filenames)
+    {
+        std::remove(filename.c_str());
+    }
+}
+
+} // namespace
+
+TEST(TestRunReader, ReadAcrossFiles)
+{
+    auto stream = make_stream(500, 32.0, 2);
+
+    // files split within the words, and an empty file
+    auto filenames = write_run(stream, {8000, 8003, 8003, 20005, 40000});
+
+    for (auto options : {small_run_blocks(1 << 20), small_run_blocks(0)})
+    {
+        geri::run_reader rdr(filenames, options);
+        ASSERT_EQ(rdr.files(), 6);
+        ASSERT_EQ(rdr.file_index(), 0);
+
+        std::vector<uint64_t> words;
+        for (auto block = rdr.read_block(); !block.empty(); block = rdr.read_block())
+        {
+            ASSERT_LE(block.size(), 4096 / sizeof(uint64_t));
+            words.insert(words.end(), block.begin(), block.end());
+        }
+        ASSERT_EQ(words, stream);
+        ASSERT_EQ(rdr.file_index(), 6);
+        ASSERT_THROW(rdr.read_word(), std::out_of_range);
+    }
+
+    geri::run_reader rdr(filenames, small_run_blocks(1 << 20));
+    std::vector<uint64_t> words(stream.size() + 1);
+    ASSERT_EQ(rdr.read_word(), stream[0]);
+    ASSERT_EQ(rdr.read_words(words.data() + 1, 2000), 2000);
+    ASSERT_EQ(rdr.read_words(words.data() + 2001, words.size()), stream.size() - 2001);
+    words[0] = stream[0];
+    words.pop_back();
+    ASSERT_EQ(words, stream);
+
+    remove_run(filenames);
+
+    geri::run_reader empty_rdr({});
+    uint64_t word{0};
+    ASSERT_EQ(empty_rdr.try_read_word(word), geri::DECODE_STATUS::end_of_data);
+}
+
+TEST(TestRunReader, Decode)
+{
+    auto stream = make_stream(500, 32.0, 2);
+    auto filenames = write_run(stream, {10000, 30001, 60000, 100000});
+
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected_decoder = geri::payload_decoder<geri::memory_reader>(&mrdr);
+
+    geri::run_reader rdr(filenames, small_run_blocks(1 << 20));
+    auto decoder = geri::payload_decoder<geri::run_reader>(&rdr);
+
+    geri::payload_frame expected;
+    geri::payload_frame frame;
+    while (expected_decoder.try_decode_frame(expected) == geri::DECODE_STATUS::ok)
+    {
+        ASSERT_EQ(decoder.try_decode_frame(frame), geri::DECODE_STATUS::ok);
+        ASSERT_EQ(frame.event_no, expected.event_no);
+        ASSERT_EQ(frame.system_ts, expected.system_ts);
+        ASSERT_EQ(frame.hits.size(), expected.hits.size());
+        for (std::size_t idx = 0; idx < expected.hits.size(); ++idx)
+        {
+            ASSERT_EQ(frame.hits[idx].full_ts, expected.hits[idx].full_ts);
+        }
+    }
+    ASSERT_EQ(decoder.try_decode_frame(frame), geri::DECODE_STATUS::end_of_data);
+
+    // state kept across the files, the frames split between them are not lost
+    auto counters = decoder.get_counters();
+    ASSERT_EQ(counters.frames, expected_decoder.get_counters().frames);
+    ASSERT_EQ(counters.event_gaps, 0);
+    ASSERT_EQ(counters.systime_mismatches, 0);
+    ASSERT_EQ(counters.skipped_bytes, 0);
+    ASSERT_EQ(counters.total().ts_mismatch, 0);
+
+    remove_run(filenames);
+}
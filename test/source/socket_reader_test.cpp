@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/socket_reader.hpp"
+#include "test_helpers.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using test_helpers::decode_all;
+using test_helpers::local_udp_options;
+using test_helpers::make_stream;
+
+} // namespace
+
+TEST(TestSocketReader, UdpDecode)
+{
+    auto stream = make_stream(200, 16.0);
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected = decode_all(&mrdr);
+
+    geri::udp_reader rdr(0, local_udp_options());
+    geri::udp_sender sender("127.0.0.1", rdr.port(), 1024);
+    ASSERT_TRUE(sender.send({stream.data(), stream.size()}));
+    ASSERT_TRUE(sender.finish());
+
+    ASSERT_EQ(decode_all(&rdr), expected);
+    ASSERT_EQ(rdr.stats().lost_packets, 0);
+    ASSERT_EQ(rdr.stats().reordered_packets, 0);
+    ASSERT_EQ(rdr.stats().packets, (stream.size() + 126) / 127 + 1);
+}
+
+TEST(TestSocketReader, UdpLossAndReordering)
+{
+    geri::udp_reader rdr(0, local_udp_options());
+    geri::udp_sender sender("127.0.0.1", rdr.port());
+
+    for (uint64_t seq : {0U, 1U, 3U, 2U, 6U})
+    {
+        ASSERT_TRUE(sender.send_datagram(seq, {&seq, 1}));
+    }
+    ASSERT_TRUE(sender.send_datagram(7, {}));
+
+    std::vector<uint64_t> words(10);
+    ASSERT_EQ(rdr.read_words(words.data(), words.size()), 5);
+    ASSERT_EQ(words[3], 2);
+    ASSERT_TRUE(rdr.read_block().empty());
+
+    ASSERT_EQ(rdr.stats().lost_packets, 2);
+    ASSERT_EQ(rdr.stats().reordered_packets, 1);
+}
+
+TEST(TestSocketReader, UdpMalformedAndTimeout)
+{
+    auto options = local_udp_options();
+    options.timeout_ms = 50;
+    geri::udp_reader rdr(0, options);
+
+    geri::udp_sender raw_sender("127.0.0.1", rdr.port(), 1024, false);
+    std::vector<uint64_t> words{0x0, 0x1234}; // sequence header and data word
+    ASSERT_TRUE(raw_sender.send_datagram(0, {}));
+    ASSERT_TRUE(raw_sender.send_datagram(0, {words.data(), words.size()}));
+
+    uint64_t read{0};
+    ASSERT_EQ(rdr.try_read_word(read), geri::DECODE_STATUS::ok);
+    ASSERT_EQ(read, 0x1234);
+    ASSERT_EQ(rdr.try_read_word(read), geri::DECODE_STATUS::end_of_data);
+    ASSERT_THROW(rdr.read_word(), std::out_of_range);
+
+    ASSERT_EQ(rdr.stats().packets, 2);
+    ASSERT_EQ(rdr.stats().malformed_packets, 1);
+}
+
+TEST(TestSocketReader, TcpDecode)
+{
+    auto stream = make_stream(200, 16.0);
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected = decode_all(&mrdr);
+
+    auto server = geri::detail::open_socket("127.0.0.1", 0, SOCK_STREAM, true);
+    ASSERT_EQ(listen(server.get(), 1), 0);
+
+    geri::tcp_reader rdr("127.0.0.1", geri::detail::local_port(server.get()), 64);
+
+    geri::detail::socket_handle conn{accept(server.get(), nullptr, nullptr)};
+    ASSERT_GE(conn.get(), 0);
+
+    // odd sizes to split the words between the receive calls, and partial word at the end
+    auto payload = stream;
+    payload.push_back(0x0);
+
+    std::thread writer(
+        [&]
+        {
+            const auto* bytes = reinterpret_cast<const char*>(payload.data());
+            const auto size = stream.size() * sizeof(uint64_t) + 3;
+            for (std::size_t offset = 0; offset < size; offset += 13)
+            {
+                auto res = send(conn.get(), bytes + offset, std::min<std::size_t>(13, size - offset), MSG_NOSIGNAL);
+                if (res < 0) { break; }
+            }
+            shutdown(conn.get(), SHUT_WR);
+        });
+
+    auto decoded = decode_all(&rdr);
+    writer.join();
+
+    ASSERT_EQ(decoded, expected);
+    ASSERT_EQ(rdr.stats().bytes, stream.size() * sizeof(uint64_t) + 3);
+    ASSERT_EQ(rdr.stats().malformed_packets, 1);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/compressed_reader.hpp"
+#include "geri-smx-decoder/generator.hpp"
+#include "geri-smx-decoder/geri-smx-decoder.hpp"
+#include "geri-smx-decoder/run_reader.hpp"
+#include "geri-smx-decoder/socket_reader.hpp"
+#include "geri-smx-decoder/uring_reader.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Fixtures shared by the reader tests.
+ */
+namespace test_helpers
+{
+
+/**
+ * Decode all frames and return number of hits of each frame.
+ */
+template <typename T> auto decode_all(T* rdr) -> std::vector<std::size_t>
+{
+    auto decoder = geri::payload_decoder<T>(rdr);
+
+    std::vector<std::size_t> hits;
+    geri::payload_frame frame;
+    for (auto status = decoder.try_decode_frame(frame); status != geri::DECODE_STATUS::end_of_data;
+         status = decoder.try_decode_frame(frame))
+    {
+        if (status == geri::DECODE_STATUS::ok) { hits.push_back(frame.hits.size()); }
+    }
+
+    return hits;
+}
+
+/**
+ * Generate the stream of valid frames.
+ */
+inline auto make_stream(std::size_t n_frames, double mean_hits = 32.0, unsigned n_gbts = 1) -> std::vector<uint64_t>
+{
+    geri::generator_options options;
+    options.n_gbts = n_gbts;
+    options.mean_hits = mean_hits;
+    return geri::stream_generator(options).generate(n_frames);
+}
+
+/**
+ * Write the data into the file in the temporary directory.
+ *
+ * @return name of the file
+ */
+inline auto write_file(const std::string& name, const void* data, std::size_t size) -> std::string
+{
+    auto filename = testing::TempDir() + name;
+    auto* fp = std::fopen(filename.c_str(), "wb");
+    if (size != 0) { std::fwrite(data, 1, size, fp); }
+    std::fclose(fp);
+    return filename;
+}
+
+/**
+ * Compressed reader options with small units and several threads.
+ */
+inline auto small_units() -> geri::compressed_options
+{
+    geri::compressed_options options;
+    options.n_threads = 3;
+    options.unit_size = 64 * 1024;
+    options.stream_block = 10000; // not a multiple of the word
+    return options;
+}
+
+/**
+ * Uring reader options with small blocks and short queue.
+ */
+inline auto small_uring_blocks(bool register_buffers, bool direct_io) -> geri::uring_options
+{
+    geri::uring_options options;
+    options.block_size = 4096;
+    options.queue_depth = 4;
+    options.register_buffers = register_buffers;
+    options.direct_io = direct_io;
+    return options;
+}
+
+/**
+ * Run reader options with small blocks.
+ */
+inline auto small_run_blocks(std::size_t readahead) -> geri::run_options
+{
+    geri::run_options options;
+    options.block_size = 4096;
+    options.readahead = readahead;
+    return options;
+}
+
+/**
+ * UDP reader options for the loopback interface.
+ */
+inline auto local_udp_options() -> geri::udp_options
+{
+    geri::udp_options options;
+    options.address = "127.0.0.1";
+    options.timeout_ms = 5000;
+    return options;
+}
+
+} // namespace test_helpers
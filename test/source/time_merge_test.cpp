@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/generator.hpp"
+#include "geri-smx-decoder/time_merge.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+auto make_hit(uint8_t addr, int full_ts) -> geri::gbt_hit
+{
+    geri::gbt_hit hit{geri::gbt::get_gbt_uplink_addr(uint32_t{addr} << 24)};
+    hit.full_ts = static_cast<uint16_t>(full_ts);
+    hit.ts = static_cast<uint16_t>(full_ts & 0x3ff);
+    return hit;
+}
+
+auto times(geri::span<const geri::timed_hit> hits) -> std::vector<uint64_t>
+{
+    std::vector<uint64_t> result;
+    for (const auto& thit : hits)
+    {
+        result.push_back(thit.time);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(TestTimeMerge, MergeUplinks)
+{
+    geri::payload_frame frame;
+    for (int ts : {10, 20, 30, 40})
+    {
+        frame.hits.push_back(make_hit(0x01, ts));
+    }
+    for (int ts : {5, 25, 26, 50})
+    {
+        frame.hits.push_back(make_hit(0x22, ts));
+    }
+    for (int ts : {20, 21})
+    {
+        frame.hits.push_back(make_hit(0x03, ts));
+    }
+
+    geri::time_merger merger;
+    auto merged = merger.merge(frame);
+
+    ASSERT_EQ(merger.runs(), 3);
+    ASSERT_EQ(times(merged), (std::vector<uint64_t>{5, 10, 20, 20, 21, 25, 26, 30, 40, 50}));
+
+    // equal times keep the stream order
+    ASSERT_EQ(merged[2].index, 1);
+    ASSERT_EQ(merged[3].index, 8);
+    ASSERT_EQ(frame.hits[merged[0].index].unique_addr, 0x22);
+}
+
+TEST(TestTimeMerge, WrapAround)
+{
+    geri::time_merge_options options;
+    options.system_ts_scale = 4;
+    options.system_ts_offset = -16;
+
+    geri::payload_frame frame;
+    frame.system_ts = 4100; // reference 16384, right at the wrap-around of full_ts
+
+    for (int ts : {16380, 16383, 2, 7})
+    {
+        frame.hits.push_back(make_hit(0x01, ts));
+    }
+    for (int ts : {16382, 1, 3})
+    {
+        frame.hits.push_back(make_hit(0x02, ts));
+    }
+
+    geri::time_merger merger(options);
+    ASSERT_EQ(times(merger.merge(frame)),
+              (std::vector<uint64_t>{16380, 16382, 16383, 16385, 16386, 16387, 16391}));
+    ASSERT_EQ(merger.runs(), 2);
+
+    // uplink following its previous hit across the wrap-around, far from the reference
+    geri::payload_frame long_frame;
+    long_frame.system_ts = 0;
+    for (int ts = 0; ts < 40000; ts += 5000)
+    {
+        long_frame.hits.push_back(make_hit(0x01, ts % static_cast<int>(geri::time_merger::ts_period)));
+    }
+
+    auto merged = times(geri::time_merger{}.merge(long_frame));
+    ASSERT_EQ(merged.size(), 8);
+    for (std::size_t idx = 0; idx < merged.size(); ++idx)
+    {
+        ASSERT_EQ(merged[idx], idx * 5000);
+    }
+}
+
+TEST(TestTimeMerge, OutOfOrder)
+{
+    geri::payload_frame frame;
+    for (int ts : {100, 90, 80, 95, 85, 200})
+    {
+        frame.hits.push_back(make_hit(0x01, ts));
+    }
+
+    geri::time_merger merger;
+    ASSERT_EQ(times(merger.merge(frame)), (std::vector<uint64_t>{80, 85, 90, 95, 100, 200}));
+    ASSERT_EQ(merger.runs(), 4);
+
+    ASSERT_TRUE(merger.merge(geri::payload_frame{}).empty());
+}
+
+TEST(TestTimeMerge, GeneratedFrames)
+{
+    geri::generator_options options;
+    options.n_gbts = 2;
+    options.mean_hits = 200;
+    auto words = geri::stream_generator(options).generate(50);
+
+    geri::memory_reader rdr(words.data(), words.size());
+    auto decoder = geri::payload_decoder<geri::memory_reader>(&rdr);
+
+    geri::time_merger merger;
+    geri::columnar_frame columnar;
+    geri::payload_frame frame;
+    geri::arena_payload_frame arena_frame;
+    for (int idx = 0; idx < 50; ++idx)
+    {
+        decoder.decode_frame(frame);
+        columnar.clear();
+        columnar.system_ts = frame.system_ts;
+        for (const auto& hit : frame.hits)
+        {
+            columnar.push_back(hit);
+        }
+
+        auto merged = merger.merge(frame);
+        ASSERT_EQ(merged.size(), frame.hits.size());
+        ASSERT_TRUE(std::is_sorted(merged.begin(), merged.end(),
+                                   [](const geri::timed_hit& lhs, const geri::timed_hit& rhs)
+                                   { return lhs.time < rhs.time; }));
+
+        std::vector<bool> used(frame.hits.size());
+        for (const auto& thit : merged)
+        {
+            ASSERT_FALSE(used[thit.index]);
+            used[thit.index] = true;
+            ASSERT_EQ(thit.time % geri::time_merger::ts_period, frame.hits[thit.index].full_ts);
+        }
+
+        auto expected = times(merged);
+        ASSERT_EQ(times(merger.merge(columnar)), expected);
+
+        arena_frame.system_ts = frame.system_ts;
+        arena_frame.hits.assign(frame.hits.begin(), frame.hits.end());
+        ASSERT_EQ(times(merger.merge(arena_frame)), expected);
+    }
+}
+
+TEST(TestTimeMerge, Clusters)
+{
+    std::vector<geri::timed_hit> hits{{100, 0}, {104, 1}, {108, 2}, {112, 3}, {200, 4}, {300, 5}, {302, 6}};
+
+    std::vector<std::size_t> sizes;
+    auto collect = [&](geri::span<const geri::timed_hit> group) { sizes.push_back(group.size()); };
+
+    geri::time_cluster_options options;
+    options.window = 5;
+
+    ASSERT_EQ(geri::time_clusterer(options).cluster({hits.data(), hits.size()}, collect), 3);
+    ASSERT_EQ(sizes, (std::vector<std::size_t>{4, 1, 2}));
+
+    sizes.clear();
+    options.mode = geri::WINDOW_MODE::fixed;
+    options.min_hits = 2;
+    ASSERT_EQ(geri::time_clusterer(options).cluster({hits.data(), hits.size()}, collect), 3);
+    ASSERT_EQ(sizes, (std::vector<std::size_t>{2, 2, 2}));
+
+    sizes.clear();
+    ASSERT_EQ(geri::time_clusterer(options).cluster({}, collect), 0);
+    ASSERT_TRUE(sizes.empty());
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "geri-smx-decoder/uring_reader.hpp"
+#include "test_helpers.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using test_helpers::make_stream;
+using test_helpers::small_uring_blocks;
+using test_helpers::write_file;
+
+} // namespace
+
+TEST(TestUringReader, ReadBlocks)
+{
+    auto stream = make_stream(500);
+    auto filename = write_file("uring_reader_test.bin", stream.data(), stream.size() * sizeof(uint64_t));
+
+    for (auto options :
+         {small_uring_blocks(true, false), small_uring_blocks(false, false), small_uring_blocks(false, true)})
+    {
+        geri::uring_reader rdr(filename.c_str(), options);
+
+        std::vector<uint64_t> words;
+        for (auto block = rdr.read_block(); !block.empty(); block = rdr.read_block())
+        {
+            ASSERT_LE(block.size(), 4096 / sizeof(uint64_t));
+            words.insert(words.end(), block.begin(), block.end());
+        }
+        ASSERT_EQ(words, stream);
+        ASSERT_THROW(rdr.read_word(), std::out_of_range);
+        ASSERT_FALSE(rdr.error());
+    }
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestUringReader, Decode)
+{
+    auto stream = make_stream(500);
+    auto filename = write_file("uring_reader_test.bin", stream.data(), stream.size() * sizeof(uint64_t));
+
+    geri::memory_reader mrdr(stream.data(), stream.size());
+    auto expected_decoder = geri::payload_decoder<geri::memory_reader>(&mrdr);
+
+    geri::uring_reader rdr(filename.c_str(), small_uring_blocks(true, false));
+    auto decoder = geri::payload_decoder<geri::uring_reader>(&rdr);
+
+    geri::payload_frame expected;
+    geri::payload_frame frame;
+    while (expected_decoder.try_decode_frame(expected) == geri::DECODE_STATUS::ok)
+    {
+        ASSERT_EQ(decoder.try_decode_frame(frame), geri::DECODE_STATUS::ok);
+        ASSERT_EQ(frame.event_no, expected.event_no);
+        ASSERT_EQ(frame.hits.size(), expected.hits.size());
+    }
+    ASSERT_EQ(decoder.try_decode_frame(frame), geri::DECODE_STATUS::end_of_data);
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestUringReader, Seek)
+{
+    auto stream = make_stream(500);
+    auto filename = write_file("uring_reader_test.bin", stream.data(), stream.size() * sizeof(uint64_t));
+
+    geri::uring_reader rdr(filename.c_str(), small_uring_blocks(true, false));
+    for (std::size_t pos : {1000UL, 3UL, 511UL, 512UL, stream.size() - 1})
+    {
+        ASSERT_TRUE(rdr.seek(pos * sizeof(uint64_t)));
+        ASSERT_EQ(rdr.read_word(), stream[pos]);
+
+        std::vector<uint64_t> words(700);
+        auto count = rdr.read_words(words.data(), words.size());
+        ASSERT_EQ(count, std::min(words.size(), stream.size() - pos - 1));
+        ASSERT_TRUE(std::equal(words.begin(), words.begin() + static_cast<std::ptrdiff_t>(count),
+                               stream.begin() + static_cast<std::ptrdiff_t>(pos + 1)));
+    }
+
+    ASSERT_FALSE(rdr.seek(3));
+    ASSERT_TRUE(rdr.seek(stream.size() * sizeof(uint64_t)));
+    ASSERT_TRUE(rdr.read_block().empty());
+
+    std::remove(filename.c_str());
+}
+
+TEST(TestUringReader, ShortFiles)
+{
+    auto empty = write_file("uring_reader_test.bin", nullptr, 0);
+    {
+        geri::uring_reader rdr(empty.c_str());
+        ASSERT_TRUE(rdr.read_block().empty());
+    }
+
+    std::vector<uint64_t> words{0x1, 0x2, 0x3};
+    auto partial = write_file("uring_reader_test.bin", words.data(), words.size() * sizeof(uint64_t) - 3);
+    {
+        geri::uring_reader rdr(partial.c_str());
+        auto block = rdr.read_block();
+        ASSERT_EQ(std::vector<uint64_t>(block.begin(), block.end()), std::vector<uint64_t>({0x1, 0x2}));
+        ASSERT_TRUE(rdr.read_block().empty());
+    }
+
+    std::remove(partial.c_str());
+}
+
+TEST(TestUringReader, ReadError)
+{
+    // reading a directory fails, the error is not taken for the end of file
+    for (auto options : {small_uring_blocks(true, false), small_uring_blocks(false, true)})
+    {
+        geri::uring_reader rdr(testing::TempDir().c_str(), options);
+        ASSERT_TRUE(rdr.read_block().empty());
+        ASSERT_TRUE(rdr.error());
+    }
+}